@@ -0,0 +1,80 @@
+// Clay_EndLayout on a random tree of 50k elements: containers with every
+// sizing type, padding, gaps and both directions, wrapping text, images,
+// scroll containers and borders. Frames alternate between two trees so that
+// nothing carries over from the previous layout.
+// The checksum covers every render command, so a change to the layout code
+// can be checked to give the same output by comparing it before and after.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#define BENCH_ELEMENT_COUNT 50000
+#define BENCH_MAX_DEPTH 6
+#define BENCH_MAX_CHILDREN 6
+#define BENCH_RUNS 20
+// Clay keeps state for at most 10 scroll containers
+#define BENCH_SCROLL_COUNT 8
+
+static void _Declare_Bench_Layout(uint32_t treeSeed) {
+    struct LayoutFixture fixture = {
+        .seed = treeSeed,
+        .budget = BENCH_ELEMENT_COUNT,
+        .scrollBudget = BENCH_SCROLL_COUNT,
+        .maxDepth = BENCH_MAX_DEPTH,
+        .maxChildren = BENCH_MAX_CHILDREN,
+        .images = true,
+        .borders = true,
+    };
+
+    _Declare_Layout(&fixture);
+}
+
+int main(void) {
+    Clay_SetMaxElementCount(2 * BENCH_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 17);
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){_Handle_Error, "largeLayout"}
+    );
+    Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+
+    uint64_t checksum = 14695981039346656037ULL;
+    int32_t commandCount = 0;
+    double best = 1e9;
+    double total = 0;
+
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        Clay_BeginLayout();
+        _Declare_Bench_Layout(run % 2 + 1);
+        double start = _Now();
+        Clay_RenderCommandArray commands = Clay_EndLayout();
+        double end = _Now();
+
+        best = end - start < best ? end - start : best;
+        total += end - start;
+        commandCount = commands.length;
+        checksum = _Checksum(commands, checksum);
+    }
+
+    printf(
+        "largeLayout: %d elements, %d render commands, %d runs\n",
+        BENCH_ELEMENT_COUNT, commandCount, BENCH_RUNS
+    );
+    printf(
+        "  Clay_EndLayout best %8.3f ms  mean %8.3f ms\n", best * 1e3,
+        total / BENCH_RUNS * 1e3
+    );
+    printf("  checksum %016llx\n", (unsigned long long)checksum);
+
+    free(arena.memory);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Text measurement, FontManager_MeasureText against the path it replaced:
+// copying every slice into a terminated string and calling MeasureTextEx.
+// Needs a display, as fonts live in GPU textures; the window stays hidden.
+// Run from the repository root so the default font is found.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#include <raylib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "clay.h"
+#include "fontManager.h"
+#include "layoutFixture.h"
+
+#define BENCH_WORD_COUNT 100000
+#define BENCH_MAX_WORD_LENGTH 12
+#define BENCH_FONT_SIZE 16
+#define BENCH_RUNS 10
+
+struct Word {
+    int32_t offset;
+    int32_t length;
+};
+
+static struct LayoutFixture fixture = {.seed = 12345};
+
+// Words of 1 to BENCH_MAX_WORD_LENGTH letters, separated by spaces in one
+// buffer the way Clay hands out slices of a longer string. Some are
+// capitalized or end in punctuation.
+static char *_Build_Corpus(struct Word *words) {
+    char *corpus = malloc(BENCH_WORD_COUNT * (BENCH_MAX_WORD_LENGTH + 2));
+    int32_t offset = 0;
+
+    for (int32_t i = 0; i < BENCH_WORD_COUNT; i++) {
+        int32_t length = 1 + _Random(&fixture) % BENCH_MAX_WORD_LENGTH;
+
+        words[i].offset = offset;
+        words[i].length = length;
+
+        for (int32_t c = 0; c < length; c++) {
+            corpus[offset++] = 'a' + _Random(&fixture) % 26;
+        }
+
+        if (_Random(&fixture) % 8 == 0) {
+            corpus[words[i].offset] += 'A' - 'a';
+        }
+
+        if (_Random(&fixture) % 10 == 0) {
+            corpus[offset - 1] = ".,;!?"[_Random(&fixture) % 5];
+        }
+
+        corpus[offset++] = ' ';
+    }
+
+    return corpus;
+}
+
+static char *_Clay_StringSlice_To_CString(const char *chars, int32_t length) {
+    char *cstring = malloc(length + 1);
+    memcpy(cstring, chars, length);
+    cstring[length] = '\0';
+
+    return cstring;
+}
+
+static double _Measure_Old(Font font, const char *corpus, struct Word *words) {
+    double total = 0;
+
+    for (int32_t i = 0; i < BENCH_WORD_COUNT; i++) {
+        char *cString = _Clay_StringSlice_To_CString(
+            corpus + words[i].offset, words[i].length
+        );
+        total += MeasureTextEx(font, cString, BENCH_FONT_SIZE, 0).x;
+        free(cString);
+    }
+
+    return total;
+}
+
+static double _Measure_New(const char *corpus, struct Word *words) {
+    double total = 0;
+
+    for (int32_t i = 0; i < BENCH_WORD_COUNT; i++) {
+        Vector2 size = FontManager_MeasureText(
+            FONTMANAGER_DEFAULT_FONT, corpus + words[i].offset, words[i].length,
+            BENCH_FONT_SIZE, 0
+        );
+        total += size.x;
+    }
+
+    return total;
+}
+
+int main(void) {
+    SetTraceLogLevel(LOG_WARNING);
+    SetConfigFlags(FLAG_WINDOW_HIDDEN);
+    InitWindow(64, 64, "textMeasure");
+    FontManager_Init();
+
+    Font font =
+        LoadFontEx("fonts/OpenSans-Regular.ttf", BENCH_FONT_SIZE, NULL, 0);
+    struct Word *words = malloc(BENCH_WORD_COUNT * sizeof(struct Word));
+    char *corpus = _Build_Corpus(words);
+
+    // first pass rasterizes the glyphs FontManager has not seen yet
+    double newTotal = _Measure_New(corpus, words);
+    double oldTotal = _Measure_Old(font, corpus, words);
+    double oldBest = 1e9;
+    double newBest = 1e9;
+
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        double start = _Now();
+        _Measure_Old(font, corpus, words);
+        double middle = _Now();
+        _Measure_New(corpus, words);
+        double end = _Now();
+
+        oldBest = middle - start < oldBest ? middle - start : oldBest;
+        newBest = end - middle < newBest ? end - middle : newBest;
+    }
+
+    printf(
+        "textMeasure: %d words, best of %d runs\n", BENCH_WORD_COUNT, BENCH_RUNS
+    );
+    printf(
+        "  copy + MeasureTextEx    %8.3f ms  %6.1f ns/word\n", oldBest * 1e3,
+        oldBest * 1e9 / BENCH_WORD_COUNT
+    );
+    printf(
+        "  FontManager_MeasureText %8.3f ms  %6.1f ns/word\n", newBest * 1e3,
+        newBest * 1e9 / BENCH_WORD_COUNT
+    );
+    printf("  total width %.1f vs %.1f\n", oldTotal, newTotal);
+
+    free(corpus);
+    free(words);
+    UnloadFont(font);
+    CloseWindow();
+
+    return 0;
+}
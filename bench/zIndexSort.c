@@ -0,0 +1,150 @@
+// Ordering tree roots by zIndex, Clay__SortTreeRootsByZIndex against the
+// bubble sort it replaced, on a layout with 1000 floating elements. Also
+// reports what a whole Clay_EndLayout costs on that layout.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#include <string.h>
+
+#define BENCH_FLOATING_COUNT 1000
+#define BENCH_MAX_Z_INDEX 1000
+#define BENCH_RUNS 100
+
+// Floating elements scattered over the root, each with a random zIndex in
+// [-BENCH_MAX_Z_INDEX, BENCH_MAX_Z_INDEX] and a border. A few of them scroll,
+// as Clay keeps state for at most 10 scroll containers, so their configs need
+// ordering too.
+static void _Declare_Floating_Elements(const int16_t *zIndexes) {
+    CLAY({
+        .id = CLAY_ID("Root"),
+        .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}},
+    }) {
+        for (int32_t i = 0; i < BENCH_FLOATING_COUNT; i++) {
+            CLAY({
+                .id = CLAY_IDI("Floating", i),
+                .layout =
+                    {.sizing = {CLAY_SIZING_FIXED(40), CLAY_SIZING_FIXED(30)}},
+                .backgroundColor = {200, 200, 200, 255},
+                .border =
+                    {.color = {0, 0, 0, 255}, .width = CLAY_BORDER_ALL(1)},
+                .scroll = {.vertical = i % 200 == 0},
+                .floating =
+                    {.attachTo = CLAY_ATTACH_TO_PARENT,
+                     .zIndex = zIndexes[i],
+                     .offset = {(i * 37) % 1240, (i * 53) % 680}},
+            }) {}
+        }
+    }
+}
+
+static void _Bubble_Sort(Clay__LayoutElementTreeRoot *roots, int32_t length) {
+    int32_t sortMax = length - 1;
+
+    while (sortMax > 0) {
+        for (int32_t i = 0; i < sortMax; ++i) {
+            Clay__LayoutElementTreeRoot current = roots[i];
+            Clay__LayoutElementTreeRoot next = roots[i + 1];
+
+            if (next.zIndex < current.zIndex) {
+                roots[i] = next;
+                roots[i + 1] = current;
+            }
+        }
+        sortMax--;
+    }
+}
+
+int main(void) {
+    Clay_SetMaxElementCount(4 * BENCH_FLOATING_COUNT);
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Context *context = Clay_Initialize(
+        arena, (Clay_Dimensions){1280, 720},
+        (Clay_ErrorHandler){_Handle_Error, "zIndexSort"}
+    );
+    struct LayoutFixture fixture = {.seed = 12345};
+
+    int16_t zIndexes[BENCH_FLOATING_COUNT];
+    for (int32_t i = 0; i < BENCH_FLOATING_COUNT; i++) {
+        zIndexes[i] =
+            (int16_t)(_Random(&fixture) % (2 * BENCH_MAX_Z_INDEX + 1)) -
+            BENCH_MAX_Z_INDEX;
+    }
+
+    // Roots are added in declaration order as elements close, and sorted in
+    // Clay_EndLayout, so copy them out in between
+    Clay_BeginLayout();
+    _Declare_Floating_Elements(zIndexes);
+    int32_t rootCount = context->layoutElementTreeRoots.length;
+    size_t rootsSize = rootCount * sizeof(Clay__LayoutElementTreeRoot);
+    Clay__LayoutElementTreeRoot *declared = malloc(rootsSize);
+    Clay__LayoutElementTreeRoot *bubbleSorted = malloc(rootsSize);
+    memcpy(declared, context->layoutElementTreeRoots.internalArray, rootsSize);
+    Clay_EndLayout();
+
+    double bubbleBest = 1e9;
+    double radixBest = 1e9;
+    double layoutBest = 1e9;
+
+    for (int run = 0; run < BENCH_RUNS; run++) {
+        memcpy(bubbleSorted, declared, rootsSize);
+        double start = _Now();
+        _Bubble_Sort(bubbleSorted, rootCount);
+        double middle = _Now();
+
+        // Put back the order Clay_EndLayout would sort from
+        memcpy(
+            context->layoutElementTreeRoots.internalArray, declared, rootsSize
+        );
+        context->layoutElementTreeRoots.length = rootCount;
+        double radixStart = _Now();
+        Clay__SortTreeRootsByZIndex(context);
+        double end = _Now();
+
+        bubbleBest = middle - start < bubbleBest ? middle - start : bubbleBest;
+        radixBest = end - radixStart < radixBest ? end - radixStart : radixBest;
+
+        Clay_BeginLayout();
+        _Declare_Floating_Elements(zIndexes);
+        start = _Now();
+        Clay_EndLayout();
+        end = _Now();
+
+        layoutBest = end - start < layoutBest ? end - start : layoutBest;
+    }
+
+    // Both sorts are stable, so the orders have to match exactly
+    memcpy(bubbleSorted, declared, rootsSize);
+    _Bubble_Sort(bubbleSorted, rootCount);
+    memcpy(context->layoutElementTreeRoots.internalArray, declared, rootsSize);
+    context->layoutElementTreeRoots.length = rootCount;
+    Clay__SortTreeRootsByZIndex(context);
+    for (int32_t i = 0; i < rootCount; i++) {
+        if (bubbleSorted[i].layoutElementIndex !=
+            context->layoutElementTreeRoots.internalArray[i]
+                .layoutElementIndex) {
+            fprintf(stderr, "zIndexSort: orders differ at root %d\n", i);
+            return 1;
+        }
+    }
+
+    printf(
+        "zIndexSort: %d tree roots, best of %d runs\n", rootCount, BENCH_RUNS
+    );
+    printf("  bubble sort                 %8.3f ms\n", bubbleBest * 1e3);
+    printf("  Clay__SortTreeRootsByZIndex %8.3f ms\n", radixBest * 1e3);
+    printf("  Clay_EndLayout              %8.3f ms\n", layoutBest * 1e3);
+
+    free(bubbleSorted);
+    free(declared);
+    free(arena.memory);
+
+    return 0;
+}
@@ -42,6 +42,23 @@
 #define CLAY_WASM_EXPORT(null)
 #endif
 
+// Define CLAY_THREAD_LOCAL_CONTEXT to give each thread its own current context, so that separate contexts can be laid out on separate
+// threads at the same time. Each thread then needs to call Clay_Initialize() or Clay_SetCurrentContext() before using Clay, and sets
+// its own measure text and scroll offset functions. Clay_SetMaxElementCount() and friends called without a context are per thread too.
+#ifdef CLAY_THREAD_LOCAL_CONTEXT
+    #if defined(__cplusplus)
+        #define CLAY__THREAD_LOCAL thread_local
+    #elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+        #define CLAY__THREAD_LOCAL _Thread_local
+    #elif defined(_MSC_VER)
+        #define CLAY__THREAD_LOCAL __declspec(thread)
+    #else
+        #define CLAY__THREAD_LOCAL __thread
+    #endif
+#else
+    #define CLAY__THREAD_LOCAL
+#endif
+
 // Public Macro API ------------------------
 
 #define CLAY__MAX(x, y) (((x) > (y)) ? (x) : (y))
@@ -82,7 +99,7 @@
 
 #define CLAY_STRING_CONST(string) { .length = CLAY__STRING_LENGTH(CLAY__ENSURE_STRING_LITERAL(string)), .chars = (string) }
 
-static uint8_t CLAY__ELEMENT_DEFINITION_LATCH;
+static CLAY__THREAD_LOCAL uint8_t CLAY__ELEMENT_DEFINITION_LATCH;
 
 // Publicly visible layout element macros -----------------------------------------------------
 
@@ -128,6 +145,26 @@ static uint8_t CLAY__ELEMENT_DEFINITION_LATCH;
 
 #define CLAY_TEXT(text, textConfig) Clay__OpenTextElement(text, textConfig)
 
+/* Memoizes the elements declared in its body. It is used like this:
+
+  CLAY_MEMO(CLAY_IDI("SidebarItem", index).id, itemHash) {
+      ...elements declared here
+  }
+
+  The first time, the body runs as normal and the elements it declares are recorded. On the following layouts, if the key
+  was used in the previous layout with the same inputHash and under the same parent element, the recorded elements are
+  declared again without running the body.
+  - key must be unique within a layout.
+  - inputHash must change whenever anything the body reads changes, including Clay_Hovered() and other pointer state.
+  - Strings and pointers in the recorded declarations are kept, so they must stay valid for as long as inputHash is unchanged.
+*/
+#define CLAY_MEMO(key, inputHash)                                                                     \
+    for (                                                                                           \
+        CLAY__ELEMENT_DEFINITION_LATCH = Clay__BeginMemo(key, inputHash);                           \
+        CLAY__ELEMENT_DEFINITION_LATCH < 1;                                                         \
+        ++CLAY__ELEMENT_DEFINITION_LATCH, Clay__EndMemo()                                           \
+    )
+
 #ifdef __cplusplus
 
 #define CLAY__INIT(type) type
@@ -734,6 +771,9 @@ typedef CLAY_PACKED_ENUM {
     CLAY_ERROR_TYPE_FLOATING_CONTAINER_PARENT_NOT_FOUND,
     // An element was declared that using CLAY_SIZING_PERCENT but the percentage value was over 1. Percentage values are expected to be in the 0-1 range.
     CLAY_ERROR_TYPE_PERCENTAGE_OVER_1,
+    // Clay ran out of capacity for recording the elements declared inside CLAY_MEMO(). The affected memos run their body again next layout.
+    // This limit follows Clay_SetMaxElementCount().
+    CLAY_ERROR_TYPE_MEMO_CAPACITY_EXCEEDED,
     // Clay encountered an internal error. It would be wonderful if you could report this so we can fix it!
     CLAY_ERROR_TYPE_INTERNAL_ERROR,
 } Clay_ErrorType;
@@ -764,6 +804,38 @@ typedef struct {
     void *userData;
 } Clay_ErrorHandler;
 
+// Counters describing the work done by the most recent Clay_EndLayout(), reset by Clay_BeginLayout().
+typedef struct {
+    // Text elements whose words had to be broken into lines this frame.
+    int32_t textElementsWrapped;
+    // Text elements that reused the previous frame's line breaks, as neither the text, its config nor the container width changed.
+    int32_t textElementsWrapReused;
+    // Measured words visited while breaking text into lines, the main cost of wrapping.
+    int32_t wordsWrapped;
+    // Text elements left unwrapped as they were hidden, see Clay_SetLazyTextWrappingEnabled().
+    int32_t textElementsWrapDeferred;
+    // Element sizes computed by the sizing passes, and sizes copied from the previous layout as their subtree and the size
+    // of their parent had not changed, see Clay_SetIncrementalLayoutEnabled(). Both count once per axis.
+    int32_t elementsRecomputed;
+    int32_t elementsReused;
+    // CLAY_MEMO() blocks that ran their body, and blocks declared from the previous layout's recording instead.
+    int32_t memosRecorded;
+    int32_t memosReplayed;
+} Clay_LayoutStats;
+
+// Occupancy and probe lengths of the table that maps element ids to elements, for tuning Clay_SetMaxElementCount().
+typedef struct {
+    // Slots in the table, and how many of them hold an element id.
+    int32_t capacity;
+    int32_t count;
+    // Lookups and inserts since Clay_Initialize(), and the groups of slots they scanned. Each scans at least one group.
+    // Counting them costs every lookup, so they stay 0 unless CLAY_ELEMENT_HASH_MAP_STATS is defined.
+    uint64_t lookups;
+    uint64_t groupsProbed;
+    // The most groups scanned by a single lookup or insert.
+    int32_t longestProbe;
+} Clay_ElementHashMapStats;
+
 // Function Forward Declarations ---------------------------------
 
 // Public API functions ------------------------------------------
@@ -777,6 +849,7 @@ uint32_t Clay_MinMemorySize(void);
 Clay_Arena Clay_CreateArenaWithCapacityAndMemory(uint32_t capacity, void *memory);
 // Sets the state of the "pointer" (i.e. the mouse or touch) in Clay's internal data. Used for detecting and responding to mouse events in the debug view,
 // as well as for Clay_Hovered() and scroll element handling.
+// When neither the position nor the element boxes have changed since the last call, the previous result is kept and only the hover callbacks are called again.
 void Clay_SetPointerState(Clay_Vector2 position, bool pointerDown);
 // Initialize Clay's internal arena and setup required data before layout can begin. Only needs to be called once.
 // - arena can be created using Clay_CreateArenaWithCapacityAndMemory()
@@ -830,9 +903,19 @@ Clay_ScrollContainerData Clay_GetScrollContainerData(Clay_ElementId id);
 // - measureTextFunction is a user provided function that adheres to the interface Clay_Dimensions (Clay_StringSlice text, Clay_TextElementConfig *config, void *userData);
 // - userData is a pointer that will be transparently passed through when the measureTextFunction is called.
 void Clay_SetMeasureTextFunction(Clay_Dimensions (*measureTextFunction)(Clay_StringSlice text, Clay_TextElementConfig *config, void *userData), void *userData);
+// Optionally binds a callback that measures many words of the same text element in one call, used instead of measureTextFunction when set.
+// - words are slices of one string, with word boundaries already found. dimensions has room for wordCount results, in the same order.
+// - A single element's words may arrive over several calls, and the first call for an element also carries a slice with a single space.
+// - userData is a pointer that will be transparently passed through when the measureTextBatchFunction is called.
+void Clay_SetMeasureTextBatchFunction(void (*measureTextBatchFunction)(Clay_StringSlice *words, Clay_Dimensions *dimensions, int32_t wordCount, Clay_TextElementConfig *config, void *userData), void *userData);
 // Experimental - Used in cases where Clay needs to integrate with a system that manages its own scrolling containers externally.
 // Please reach out if you plan to use this function, as it may be subject to change.
 void Clay_SetQueryScrollOffsetFunction(Clay_Vector2 (*queryScrollOffsetFunction)(uint32_t elementId, void *userData), void *userData);
+// Optionally binds a callback that runs tasks on a worker pool, used to size the trees of floating elements on several threads.
+// - parallelForFunction must call task(index, taskData) once for every index from 0 to count - 1, on any threads, and only return once all of them have.
+// - Tasks never call back into user code, including the error handler, or need the current context set, and sizes come out the same as without a parallelForFunction.
+// - userData is a pointer that will be transparently passed through when the parallelForFunction is called.
+void Clay_SetParallelForFunction(void (*parallelForFunction)(void (*task)(int32_t index, void *taskData), int32_t count, void *taskData, void *userData), void *userData);
 // A bounds-checked "get" function for the Clay_RenderCommandArray returned from Clay_EndLayout().
 Clay_RenderCommand * Clay_RenderCommandArray_Get(Clay_RenderCommandArray* array, int32_t index);
 // Enables and disables Clay's internal debug tools.
@@ -842,6 +925,18 @@ void Clay_SetDebugModeEnabled(bool enabled);
 bool Clay_IsDebugModeEnabled(void);
 // Enables and disables visibility culling. By default, Clay will not generate render commands for elements whose bounding box is entirely outside the screen.
 void Clay_SetCullingEnabled(bool enabled);
+// Enables and disables lazy text wrapping. When enabled, a text element that was offscreen or scrolled out of its scroll container last frame,
+// and whose text, config and width have not changed, keeps last frame's height without being wrapped. It is wrapped once it becomes visible.
+// Text hidden this way produces no render commands, even when culling is disabled.
+void Clay_SetLazyTextWrappingEnabled(bool enabled);
+// Enables and disables incremental layout. When enabled, every element is fingerprinted from its layout and children as it is declared.
+// An element whose fingerprint matches its last layout, and whose size, layout and children are exactly what its children were last
+// sized from, hands them those sizes instead of sizing them again. Positions and render commands are still computed every frame.
+void Clay_SetIncrementalLayoutEnabled(bool enabled);
+// Returns counters describing the work done by the most recent layout pass.
+Clay_LayoutStats Clay_GetLayoutStats(void);
+// Returns the occupancy and probe length counters of the element id hash map.
+Clay_ElementHashMapStats Clay_GetElementHashMapStats(void);
 // Returns the maximum number of UI elements supported by Clay's current configuration.
 int32_t Clay_GetMaxElementCount(void);
 // Modifies the maximum number of UI elements supported by Clay's current configuration.
@@ -865,6 +960,8 @@ Clay_ElementId Clay__HashString(Clay_String key, uint32_t offset, uint32_t seed)
 void Clay__OpenTextElement(Clay_String text, Clay_TextElementConfig *textConfig);
 Clay_TextElementConfig *Clay__StoreTextElementConfig(Clay_TextElementConfig config);
 uint32_t Clay__GetParentElementId(void);
+uint8_t Clay__BeginMemo(uint32_t key, uint32_t inputHash);
+void Clay__EndMemo(void);
 
 extern Clay_Color Clay__debugViewHighlightColor;
 extern uint32_t Clay__debugViewWidth;
@@ -904,7 +1001,7 @@ typedef struct
     typeName *internalArray;                                                                                    \
 } arrayName##Slice;                                                                                             \
                                                                                                                 \
-typeName typeName##_DEFAULT = CLAY__DEFAULT_STRUCT;                                                             \
+CLAY__THREAD_LOCAL typeName typeName##_DEFAULT = CLAY__DEFAULT_STRUCT;                                          \
                                                                                                                 \
 arrayName arrayName##_Allocate_Arena(int32_t capacity, Clay_Arena *arena) {                                     \
     return CLAY__INIT(arrayName){.capacity = capacity, .length = 0,                                             \
@@ -958,9 +1055,9 @@ typedef struct                                      \
                                                     \
 CLAY__ARRAY_DEFINE_FUNCTIONS(typeName, arrayName)   \
 
-Clay_Context *Clay__currentContext;
-int32_t Clay__defaultMaxElementCount = 8192;
-int32_t Clay__defaultMaxMeasureTextWordCacheCount = 16384;
+CLAY__THREAD_LOCAL Clay_Context *Clay__currentContext;
+CLAY__THREAD_LOCAL int32_t Clay__defaultMaxElementCount = 8192;
+CLAY__THREAD_LOCAL int32_t Clay__defaultMaxMeasureTextWordCacheCount = 16384;
 
 void Clay__ErrorHandlerFunctionDefault(Clay_ErrorData errorText) {
     (void) errorText;
@@ -1004,10 +1101,12 @@ bool Clay__Array_RangeCheck(int32_t index, int32_t length);
 bool Clay__Array_AddCapacityCheck(int32_t length, int32_t capacity);
 
 CLAY__ARRAY_DEFINE(bool, Clay__boolArray)
+CLAY__ARRAY_DEFINE(uint8_t, Clay__uint8_tArray)
 CLAY__ARRAY_DEFINE(int32_t, Clay__int32_tArray)
 CLAY__ARRAY_DEFINE(char, Clay__charArray)
 CLAY__ARRAY_DEFINE(Clay_ElementId, Clay__ElementIdArray)
 CLAY__ARRAY_DEFINE(Clay_LayoutConfig, Clay__LayoutConfigArray)
+CLAY__ARRAY_DEFINE(Clay_SizingAxis, Clay__SizingAxisArray)
 CLAY__ARRAY_DEFINE(Clay_TextElementConfig, Clay__TextElementConfigArray)
 CLAY__ARRAY_DEFINE(Clay_ImageElementConfig, Clay__ImageElementConfigArray)
 CLAY__ARRAY_DEFINE(Clay_FloatingElementConfig, Clay__FloatingElementConfigArray)
@@ -1058,6 +1157,9 @@ typedef struct {
     Clay_Dimensions preferredDimensions;
     int32_t elementIndex;
     Clay__WrappedTextLineArraySlice wrappedLines;
+    uint32_t textId;
+    // Set when wrapping was skipped as the element was hidden last frame, see Clay_SetLazyTextWrappingEnabled
+    bool wrapDeferred;
 } Clay__TextElementData;
 
 CLAY__ARRAY_DEFINE(Clay__TextElementData, Clay__TextElementDataArray)
@@ -1077,6 +1179,8 @@ typedef struct {
     Clay_LayoutConfig *layoutConfig;
     Clay__ElementConfigArraySlice elementConfigs;
     uint32_t id;
+    // Hash of everything in this element's subtree that affects sizing, 0 if unknown. See Clay_SetIncrementalLayoutEnabled
+    uint32_t fingerprint;
 } Clay_LayoutElement;
 
 CLAY__ARRAY_DEFINE(Clay_LayoutElement, Clay_LayoutElementArray)
@@ -1105,20 +1209,74 @@ typedef struct {
 
 CLAY__ARRAY_DEFINE(Clay__DebugElementData, Clay__DebugElementDataArray)
 
+// What the sizing passes need to know about an element's configs, see Clay__StoreSizingData()
+enum {
+    CLAY__SIZING_FLAG_TEXT = 1,
+    CLAY__SIZING_FLAG_WRAP_WORDS = 2,
+    CLAY__SIZING_FLAG_IMAGE = 4,
+    CLAY__SIZING_FLAG_SCROLL_HORIZONTAL = 8,
+    CLAY__SIZING_FLAG_SCROLL_VERTICAL = 16,
+};
+
+// What sizing an element's children along one axis read about the element, the last time it ran rather than being reused.
+// See Clay__ReuseChildSizes()
+typedef struct {
+    uint32_t generation;
+    float size;
+    float padding;
+    float childGap;
+    int32_t childCount;
+    uint8_t layoutDirection;
+    uint8_t flags;
+} Clay__ParentSizingRecord;
+
+// What sizing an element and its siblings along one axis read about the element, and the size it gave it
+typedef struct {
+    uint32_t parentId;
+    uint32_t parentGeneration;
+    int32_t childOffset;
+    Clay_SizingAxis sizing;
+    float size;
+    float minSize;
+    float sizedSize;
+    uint8_t flags;
+} Clay__ChildSizingRecord;
+
 typedef struct { // todo get this struct into a single cache line
     Clay_BoundingBox boundingBox;
     Clay_ElementId elementId;
     Clay_LayoutElement* layoutElement;
     void (*onHoverFunction)(Clay_ElementId elementId, Clay_PointerData pointerInfo, intptr_t userData);
     intptr_t hoverFunctionUserData;
-    int32_t nextIndex;
     uint32_t generation;
     uint32_t idAlias;
     Clay__DebugElementData *debugData;
+    // Text elements only: what the element was wrapped from last time, and whether it was visible
+    uint32_t wrapTextId;
+    float wrapWidth;
+    float wrapHeight;
+    bool wrapVisible;
+    // The subtree fingerprint of the element the last time it was laid out, and what sizing read and wrote along each axis
+    uint32_t layoutFingerprint;
+    Clay__ParentSizingRecord parentSizing[2];
+    Clay__ChildSizingRecord childSizing[2];
 } Clay_LayoutElementHashMapItem;
 
 CLAY__ARRAY_DEFINE(Clay_LayoutElementHashMapItem, Clay__LayoutElementHashMapItemArray)
 
+#define CLAY__HASH_MAP_GROUP_WIDTH 12
+#define CLAY__HASH_MAP_EMPTY 0x80
+#define CLAY__HASH_MAP_PADDING 0xFF
+
+// Twelve slots of the element hash map in one cache line: their control bytes, padded to 16 with bytes that never match, and
+// the index of the item each one holds.
+typedef struct {
+    uint8_t control[16];
+    int32_t itemIndexes[CLAY__HASH_MAP_GROUP_WIDTH]; // Into layoutElementsHashMapInternal
+} Clay__HashMapGroup;
+
+CLAY__ARRAY_DEFINE(Clay__HashMapGroup, Clay__HashMapGroupArray)
+
 typedef struct {
     int32_t startOffset;
     int32_t length;
@@ -1130,6 +1288,7 @@ CLAY__ARRAY_DEFINE(Clay__MeasuredWord, Clay__MeasuredWordArray)
 
 typedef struct {
     Clay_Dimensions unwrappedDimensions;
+    float spaceWidth;
     int32_t measuredWordsStartIndex;
     bool containsNewlines;
     // Hash map data
@@ -1140,6 +1299,75 @@ typedef struct {
 
 CLAY__ARRAY_DEFINE(Clay__MeasureTextCacheItem, Clay__MeasureTextCacheItemArray)
 
+typedef struct {
+    float width;
+    int32_t startOffset;
+    int32_t length;
+} Clay__WrapCacheLine;
+
+CLAY__ARRAY_DEFINE(Clay__WrapCacheLine, Clay__WrapCacheLineArray)
+
+// The line breaks of one wrapped text element, which hold for any container width where minWidth <= width < maxWidth.
+// Items live in an open addressing table, and only count as present when their frame matches the table's.
+typedef struct {
+    uint32_t id;
+    uint32_t quantizedWidth;
+    uint32_t frame;
+    float minWidth;
+    float maxWidth;
+    int32_t linesStartIndex;
+    int32_t lineCount;
+} Clay__WrapCacheItem;
+
+CLAY__ARRAY_DEFINE(Clay__WrapCacheItem, Clay__WrapCacheItemArray)
+
+typedef CLAY_PACKED_ENUM {
+    CLAY__MEMO_OP_OPEN,
+    CLAY__MEMO_OP_CLOSE,
+    CLAY__MEMO_OP_TEXT,
+    CLAY__MEMO_OP_HOVER,
+} Clay__MemoOpType;
+
+// One declaration call made inside CLAY_MEMO(), with the arguments needed to make it again.
+typedef struct {
+    Clay__MemoOpType type;
+    union {
+        Clay_ElementDeclaration declaration;
+        struct {
+            Clay_String text;
+            Clay_TextElementConfig config;
+        } text;
+        struct {
+            void (*function)(Clay_ElementId elementId, Clay_PointerData pointerInfo, intptr_t userData);
+            intptr_t userData;
+        } hover;
+    } data;
+} Clay__MemoOp;
+
+CLAY__ARRAY_DEFINE(Clay__MemoOp, Clay__MemoOpArray)
+
+// Where a memo's recording lives in the ops buffer of the frame it was recorded in.
+// Items live in an open addressing table, and only count as present when their frame matches the table's.
+typedef struct {
+    uint32_t key;
+    uint32_t frame;
+    uint32_t inputHash;
+    uint32_t parentId;
+    int32_t opsStartIndex;
+    int32_t opCount;
+} Clay__MemoItem;
+
+CLAY__ARRAY_DEFINE(Clay__MemoItem, Clay__MemoItemArray)
+
+typedef struct {
+    uint32_t key;
+    uint32_t inputHash;
+    uint32_t parentId;
+    int32_t opsStartIndex;
+} Clay__OpenMemo;
+
+CLAY__ARRAY_DEFINE(Clay__OpenMemo, Clay__OpenMemoArray)
+
 typedef struct {
     Clay_LayoutElement *layoutElement;
     Clay_Vector2 position;
@@ -1154,10 +1382,79 @@ typedef struct {
     uint32_t clipElementId; // This can be zero if there is no clip element
     int16_t zIndex;
     Clay_Vector2 pointerOffset; // Only used when scroll containers are managed externally
+    int32_t elementCount; // Elements in this tree, not counting the floating trees inside it
 } Clay__LayoutElementTreeRoot;
 
 CLAY__ARRAY_DEFINE(Clay__LayoutElementTreeRoot, Clay__LayoutElementTreeRootArray)
 
+// Tree roots sized together by Clay_SetParallelForFunction()'s callback, at most this many at a time
+#define CLAY__TREE_ROOT_SIZING_BATCH_SIZE 64
+
+// Room in resizeScratch per element of a tree root. Compressing takes a tree of sizes and two indexes per child, see
+// Clay__CompressChildrenAlongAxis(), growing up to four indexes and the bitset, see Clay__GrowChildrenAlongAxis().
+#define CLAY__RESIZE_SCRATCH_PER_ELEMENT 6
+
+// One tree root's share of a sizing pass. Tasks of a batch may run on different threads, so each gets its own range of
+// the scratch buffers and its own counters, which are added to the context's once the batch is done.
+typedef struct {
+    int32_t rootIndex;
+    int32_t scratchOffset;
+    int32_t scratchCapacity;
+    int32_t elementsRecomputed;
+    int32_t elementsReused;
+    Clay_ElementHashMapStats hashMapStats;
+} Clay__TreeRootSizingTask;
+
+CLAY__ARRAY_DEFINE(Clay__TreeRootSizingTask, Clay__TreeRootSizingTaskArray)
+
+typedef struct {
+    Clay_Context *context;
+    Clay__TreeRootSizingTask *tasks;
+    bool xAxis;
+} Clay__TreeRootSizingBatch;
+
+#define CLAY__POINTER_GRID_CELL_SIZE 64
+#define CLAY__POINTER_GRID_MAX_COLUMNS 64
+// Elements covering more cells than this are tested by every query instead of being listed in each cell
+#define CLAY__POINTER_GRID_MAX_ELEMENT_CELLS 16
+#define CLAY__POINTER_GRID_CELL_ENTRIES_PER_ELEMENT 4
+
+// An element as Clay_SetPointerState() tests it, with its root's pointer offset already applied
+typedef struct {
+    Clay_BoundingBox boundingBox;
+    int32_t layoutElementIndex;
+    int32_t rootIndex;
+} Clay__PointerGridEntry;
+
+CLAY__ARRAY_DEFINE(Clay__PointerGridEntry, Clay__PointerGridEntryArray)
+
+// What Clay_SetPointerState() reads about an element. Kept from one layout to the next, to tell whether a pointer result
+// still holds.
+typedef struct {
+    Clay_BoundingBox boundingBox;
+    uint32_t id;
+    uint32_t idAlias; // One more than the hash item's alias, 0 without a hash item
+    int32_t rootIndex;
+    int32_t rootCaptureMode; // One more than the root's pointer capture mode, 0 if the root doesn't float
+} Clay__PointerTest;
+
+CLAY__ARRAY_DEFINE(Clay__PointerTest, Clay__PointerTestArray)
+
+typedef struct {
+    int32_t entryIndex;
+    int32_t next; // -1 at the end of the cell's list
+} Clay__PointerGridCellEntry;
+
+CLAY__ARRAY_DEFINE(Clay__PointerGridCellEntry, Clay__PointerGridCellEntryArray)
+
+typedef struct {
+    float inverseCellWidth;
+    float inverseCellHeight;
+    int32_t columns;
+    int32_t rows;
+    bool built;
+} Clay__PointerGrid;
+
 struct Clay_Context {
     int32_t maxElementCount;
     int32_t maxMeasureTextCacheWordCount;
@@ -1173,11 +1470,16 @@ struct Clay_Context {
     bool debugModeEnabled;
     bool disableCulling;
     bool externalScrollHandlingEnabled;
+    bool lazyTextWrappingEnabled;
+    bool incrementalLayoutEnabled;
     uint32_t debugSelectedElementId;
     uint32_t generation;
     uintptr_t arenaResetOffset;
     void *measureTextUserData;
+    void *measureTextBatchUserData;
     void *queryScrollOffsetUserData;
+    void (*parallelForFunction)(void (*task)(int32_t index, void *taskData), int32_t count, void *taskData, void *userData);
+    void *parallelForUserData;
     Clay_Arena internalArena;
     // Layout Elements / Render Commands
     Clay_LayoutElementArray layoutElements;
@@ -1189,6 +1491,25 @@ struct Clay_Context {
     Clay__int32_tArray imageElementPointers;
     Clay__int32_tArray reusableElementIndexBuffer;
     Clay__int32_tArray layoutElementClipElementIds;
+    Clay__int32_tArray layoutElementTreeRootIndexes; // The tree root each element is sized with, before roots are sorted by z index
+    // Sizing pass data, as a struct of arrays indexed like layoutElements: width and height sizing, then CLAY__SIZING_FLAG_ bits.
+    // Reading these instead of each element's layoutConfig and config list takes around 7% off Clay_EndLayout in bench/largeLayout.
+    Clay__SizingAxisArray layoutElementSizing[2];
+    Clay__uint8_tArray layoutElementSizingFlags;
+    // Where each child is in its parent's resizable buffer while being compressed or grown, and the step that last sized it
+    Clay__int32_tArray layoutElementResizePositions;
+    Clay__int32_tArray layoutElementResizeSteps;
+    // What Clay_SetPointerState() tests, see Clay__BuildPointerGrid()
+    Clay__PointerGrid pointerGrid;
+    Clay__PointerGridEntryArray pointerGridEntries;
+    Clay__int32_tArray pointerGridRootStarts; // Index of each tree root's first entry
+    Clay__int32_tArray pointerGridCellHeads; // One list per cell, then one for elements too large to list per cell
+    Clay__int32_tArray pointerGridCellTails;
+    Clay__PointerGridCellEntryArray pointerGridCellEntries;
+    // Changes whenever a layout would answer Clay_SetPointerState() differently from the one before, which is when any of
+    // pointerTests changes
+    uint32_t layoutGeneration;
+    Clay__PointerTestArray pointerTests;
     // Configs
     Clay__LayoutConfigArray layoutConfigs;
     Clay__ElementConfigArray elementConfigs;
@@ -1204,8 +1525,13 @@ struct Clay_Context {
     Clay__WrappedTextLineArray wrappedTextLines;
     Clay__LayoutElementTreeNodeArray layoutElementTreeNodeArray1;
     Clay__LayoutElementTreeRootArray layoutElementTreeRoots;
+    Clay__LayoutElementTreeRootArray layoutElementTreeRootsSortBuffer;
+    Clay__TreeRootSizingTaskArray treeRootSizingTasks;
+    Clay__int32_tArray resizeScratch; // Split between the roots of a sizing batch, see CLAY__RESIZE_SCRATCH_PER_ELEMENT
     Clay__LayoutElementHashMapItemArray layoutElementsHashMapInternal;
-    Clay__int32_tArray layoutElementsHashMap;
+    // Open addressing index into layoutElementsHashMapInternal, see Clay__FindHashMapSlot()
+    Clay__HashMapGroupArray layoutElementsHashMapGroups;
+    Clay_ElementHashMapStats layoutElementsHashMapStats;
     Clay__MeasureTextCacheItemArray measureTextHashMapInternal;
     Clay__int32_tArray measureTextHashMapInternalFreeList;
     Clay__int32_tArray measureTextHashMap;
@@ -1213,10 +1539,29 @@ struct Clay_Context {
     Clay__int32_tArray measuredWordsFreeList;
     Clay__int32_tArray openClipElementStack;
     Clay__ElementIdArray pointerOverIds;
+    // The hash items behind pointerOverIds, and the pointer position and layout generation they were found for
+    Clay__int32_tArray pointerOverItems;
+    Clay_Vector2 pointerOverPosition;
+    uint32_t pointerOverLayoutGeneration;
+    bool pointerOverValid;
     Clay__ScrollContainerDataInternalArray scrollContainerDatas;
     Clay__boolArray treeNodeVisited;
     Clay__charArray dynamicStringData;
     Clay__DebugElementDataArray debugElementData;
+    // Wrapped text, double buffered: this frame's lines are looked up in the previous frame's buffer
+    Clay__WrapCacheItemArray wrapCacheItems[2];
+    Clay__WrapCacheLineArray wrapCacheLines[2];
+    uint32_t wrapCacheFrame;
+    // Memoized declarations, double buffered like the wrap cache
+    Clay__MemoItemArray memoItems[2];
+    Clay__MemoOpArray memoOps[2];
+    uint32_t memoFrame;
+    int32_t memoItemCount; // Items recorded into this frame's table
+    bool memoReplaying;
+    bool memoOpsExceeded;
+    Clay__OpenMemoArray openMemos;
+    int32_t untrackedMemoDepth; // CLAY_MEMO() bodies running without an entry in openMemos
+    Clay_LayoutStats layoutStats;
 };
 
 Clay_Context* Clay__Context_Allocate_Arena(Clay_Arena *arena) {
@@ -1244,8 +1589,9 @@ Clay_String Clay__WriteStringToCharBuffer(Clay__charArray *buffer, Clay_String s
     __attribute__((import_module("clay"), import_name("measureTextFunction"))) Clay_Dimensions Clay__MeasureText(Clay_StringSlice text, Clay_TextElementConfig *config, void *userData);
     __attribute__((import_module("clay"), import_name("queryScrollOffsetFunction"))) Clay_Vector2 Clay__QueryScrollOffset(uint32_t elementId, void *userData);
 #else
-    Clay_Dimensions (*Clay__MeasureText)(Clay_StringSlice text, Clay_TextElementConfig *config, void *userData);
-    Clay_Vector2 (*Clay__QueryScrollOffset)(uint32_t elementId, void *userData);
+    CLAY__THREAD_LOCAL Clay_Dimensions (*Clay__MeasureText)(Clay_StringSlice text, Clay_TextElementConfig *config, void *userData);
+    CLAY__THREAD_LOCAL void (*Clay__MeasureTextBatch)(Clay_StringSlice *words, Clay_Dimensions *dimensions, int32_t wordCount, Clay_TextElementConfig *config, void *userData);
+    CLAY__THREAD_LOCAL Clay_Vector2 (*Clay__QueryScrollOffset)(uint32_t elementId, void *userData);
 #endif
 
 Clay_LayoutElement* Clay__GetOpenLayoutElement(void) {
@@ -1279,7 +1625,7 @@ Clay_ElementConfig Clay__AttachElementConfig(Clay_ElementConfigUnion config, Cla
 
 Clay_ElementConfigUnion Clay__FindElementConfigWithType(Clay_LayoutElement *element, Clay__ElementConfigType type) {
     for (int32_t i = 0; i < element->elementConfigs.length; i++) {
-        Clay_ElementConfig *config = Clay__ElementConfigArraySlice_Get(&element->elementConfigs, i);
+        Clay_ElementConfig *config = &element->elementConfigs.internalArray[i];
         if (config->type == type) {
             return config->config;
         }
@@ -1383,10 +1729,187 @@ Clay__MeasuredWord *Clay__AddMeasuredWord(Clay__MeasuredWord word, Clay__Measure
     }
 }
 
+// Splits text into measured words, calling the measure function once per word. Returns false when the word cache is full.
+bool Clay__MeasureWords(Clay_String *text, Clay_TextElementConfig *config, Clay__MeasureTextCacheItem *measured) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    int32_t start = 0;
+    int32_t end = 0;
+    float lineWidth = 0;
+    float measuredWidth = 0;
+    float measuredHeight = 0;
+    float spaceWidth = Clay__MeasureText(CLAY__INIT(Clay_StringSlice) { .length = 1, .chars = CLAY__SPACECHAR.chars, .baseChars = CLAY__SPACECHAR.chars }, config, context->measureTextUserData).width;
+    Clay__MeasuredWord tempWord = { .next = -1 };
+    Clay__MeasuredWord *previousWord = &tempWord;
+    while (end < text->length) {
+        if (context->measuredWords.length == context->measuredWords.capacity - 1) {
+            if (!context->booleanWarnings.maxTextMeasureCacheExceeded) {
+                context->errorHandler.errorHandlerFunction(CLAY__INIT(Clay_ErrorData) {
+                    .errorType = CLAY_ERROR_TYPE_TEXT_MEASUREMENT_CAPACITY_EXCEEDED,
+                    .errorText = CLAY_STRING("Clay has run out of space in it's internal text measurement cache. Try using Clay_SetMaxMeasureTextCacheWordCount() (default 16384, with 1 unit storing 1 measured word)."),
+                    .userData = context->errorHandler.userData });
+                context->booleanWarnings.maxTextMeasureCacheExceeded = true;
+            }
+            return false;
+        }
+        char current = text->chars[end];
+        if (current == ' ' || current == '\n') {
+            int32_t length = end - start;
+            Clay_Dimensions dimensions = Clay__MeasureText(CLAY__INIT(Clay_StringSlice) { .length = length, .chars = &text->chars[start], .baseChars = text->chars }, config, context->measureTextUserData);
+            measuredHeight = CLAY__MAX(measuredHeight, dimensions.height);
+            if (current == ' ') {
+                dimensions.width += spaceWidth;
+                previousWord = Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = start, .length = length + 1, .width = dimensions.width, .next = -1 }, previousWord);
+                lineWidth += dimensions.width;
+            }
+            if (current == '\n') {
+                if (length > 0) {
+                    previousWord = Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = start, .length = length, .width = dimensions.width, .next = -1 }, previousWord);
+                }
+                previousWord = Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = end + 1, .length = 0, .width = 0, .next = -1 }, previousWord);
+                lineWidth += dimensions.width;
+                measuredWidth = CLAY__MAX(lineWidth, measuredWidth);
+                measured->containsNewlines = true;
+                lineWidth = 0;
+            }
+            start = end + 1;
+        }
+        end++;
+    }
+    if (end - start > 0) {
+        Clay_Dimensions dimensions = Clay__MeasureText(CLAY__INIT(Clay_StringSlice) { .length = end - start, .chars = &text->chars[start], .baseChars = text->chars }, config, context->measureTextUserData);
+        Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = start, .length = end - start, .width = dimensions.width, .next = -1 }, previousWord);
+        lineWidth += dimensions.width;
+        measuredHeight = CLAY__MAX(measuredHeight, dimensions.height);
+    }
+    measuredWidth = CLAY__MAX(lineWidth, measuredWidth);
+
+    measured->measuredWordsStartIndex = tempWord.next;
+    measured->spaceWidth = spaceWidth;
+    measured->unwrappedDimensions.width = measuredWidth;
+    measured->unwrappedDimensions.height = measuredHeight;
+    return true;
+}
+
+#ifndef CLAY_WASM
+#define CLAY__WORD_BATCH_SIZE 128
+// Marks the slice in a batch that only measures the width of a space, and slices only measured for the line height
+#define CLAY__WORD_BATCH_SPACE -2
+#define CLAY__WORD_BATCH_HEIGHT_ONLY -1
+
+typedef struct {
+    Clay_StringSlice words[CLAY__WORD_BATCH_SIZE];
+    Clay_Dimensions dimensions[CLAY__WORD_BATCH_SIZE];
+    int32_t measuredWordIndices[CLAY__WORD_BATCH_SIZE];
+    int32_t count;
+    float spaceWidth;
+    float measuredHeight;
+} Clay__WordBatch;
+
+void Clay__FlushWordBatch(Clay__WordBatch *batch, Clay_TextElementConfig *config) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__MeasureTextBatch(batch->words, batch->dimensions, batch->count, config, context->measureTextBatchUserData);
+    for (int32_t i = 0; i < batch->count; ++i) {
+        int32_t wordIndex = batch->measuredWordIndices[i];
+        if (wordIndex == CLAY__WORD_BATCH_SPACE) {
+            batch->spaceWidth = batch->dimensions[i].width;
+            continue;
+        }
+        batch->measuredHeight = CLAY__MAX(batch->measuredHeight, batch->dimensions[i].height);
+        if (wordIndex != CLAY__WORD_BATCH_HEIGHT_ONLY) {
+            Clay__MeasuredWordArray_Get(&context->measuredWords, wordIndex)->width = batch->dimensions[i].width;
+        }
+    }
+    batch->count = 0;
+}
+
+void Clay__AddToWordBatch(Clay__WordBatch *batch, Clay_StringSlice word, int32_t measuredWordIndex, Clay_TextElementConfig *config) {
+    if (batch->count == CLAY__WORD_BATCH_SIZE) {
+        Clay__FlushWordBatch(batch, config);
+    }
+    batch->words[batch->count] = word;
+    batch->measuredWordIndices[batch->count] = measuredWordIndex;
+    batch->count++;
+}
+
+// Same words as Clay__MeasureWords, but all measured through the batch function. Widths are only known once the batches
+// have been flushed, so line widths are summed in a second pass over the words.
+bool Clay__MeasureWordsBatched(Clay_String *text, Clay_TextElementConfig *config, Clay__MeasureTextCacheItem *measured) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__WordBatch batch;
+    batch.count = 0;
+    batch.spaceWidth = 0;
+    batch.measuredHeight = 0;
+    Clay__AddToWordBatch(&batch, CLAY__INIT(Clay_StringSlice) { .length = 1, .chars = CLAY__SPACECHAR.chars, .baseChars = CLAY__SPACECHAR.chars }, CLAY__WORD_BATCH_SPACE, config);
+
+    int32_t start = 0;
+    int32_t end = 0;
+    Clay__MeasuredWord tempWord = { .next = -1 };
+    Clay__MeasuredWord *previousWord = &tempWord;
+    while (end < text->length) {
+        if (context->measuredWords.length == context->measuredWords.capacity - 1) {
+            if (!context->booleanWarnings.maxTextMeasureCacheExceeded) {
+                context->errorHandler.errorHandlerFunction(CLAY__INIT(Clay_ErrorData) {
+                    .errorType = CLAY_ERROR_TYPE_TEXT_MEASUREMENT_CAPACITY_EXCEEDED,
+                    .errorText = CLAY_STRING("Clay has run out of space in it's internal text measurement cache. Try using Clay_SetMaxMeasureTextCacheWordCount() (default 16384, with 1 unit storing 1 measured word)."),
+                    .userData = context->errorHandler.userData });
+                context->booleanWarnings.maxTextMeasureCacheExceeded = true;
+            }
+            return false;
+        }
+        char current = text->chars[end];
+        if (current == ' ' || current == '\n') {
+            int32_t length = end - start;
+            int32_t wordIndex = CLAY__WORD_BATCH_HEIGHT_ONLY;
+            if (current == ' ' || length > 0) {
+                previousWord = Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = start, .length = current == ' ' ? length + 1 : length, .next = -1 }, previousWord);
+                wordIndex = (int32_t)(previousWord - context->measuredWords.internalArray);
+            }
+            Clay__AddToWordBatch(&batch, CLAY__INIT(Clay_StringSlice) { .length = length, .chars = &text->chars[start], .baseChars = text->chars }, wordIndex, config);
+            if (current == '\n') {
+                previousWord = Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = end + 1, .length = 0, .width = 0, .next = -1 }, previousWord);
+                measured->containsNewlines = true;
+            }
+            start = end + 1;
+        }
+        end++;
+    }
+    if (end - start > 0) {
+        previousWord = Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = start, .length = end - start, .next = -1 }, previousWord);
+        Clay__AddToWordBatch(&batch, CLAY__INIT(Clay_StringSlice) { .length = end - start, .chars = &text->chars[start], .baseChars = text->chars }, (int32_t)(previousWord - context->measuredWords.internalArray), config);
+    }
+    Clay__FlushWordBatch(&batch, config);
+
+    // Only newline markers have a length of zero, and a word followed by a space carries the space's width
+    float lineWidth = 0;
+    float measuredWidth = 0;
+    int32_t wordIndex = tempWord.next;
+    while (wordIndex != -1) {
+        Clay__MeasuredWord *word = Clay__MeasuredWordArray_Get(&context->measuredWords, wordIndex);
+        if (word->length == 0) {
+            measuredWidth = CLAY__MAX(lineWidth, measuredWidth);
+            lineWidth = 0;
+        } else {
+            if (text->chars[word->startOffset + word->length - 1] == ' ') {
+                word->width += batch.spaceWidth;
+            }
+            lineWidth += word->width;
+        }
+        wordIndex = word->next;
+    }
+    measuredWidth = CLAY__MAX(lineWidth, measuredWidth);
+
+    measured->measuredWordsStartIndex = tempWord.next;
+    measured->spaceWidth = batch.spaceWidth;
+    measured->unwrappedDimensions.width = measuredWidth;
+    measured->unwrappedDimensions.height = batch.measuredHeight;
+    return true;
+}
+#endif
+
 Clay__MeasureTextCacheItem *Clay__MeasureTextCached(Clay_String *text, Clay_TextElementConfig *config) {
     Clay_Context* context = Clay_GetCurrentContext();
     #ifndef CLAY_WASM
-    if (!Clay__MeasureText) {
+    if (!Clay__MeasureText && !Clay__MeasureTextBatch) {
         if (!context->booleanWarnings.textMeasurementFunctionNotSet) {
             context->booleanWarnings.textMeasurementFunctionNotSet = true;
             context->errorHandler.errorHandlerFunction(CLAY__INIT(Clay_ErrorData) {
@@ -1456,60 +1979,14 @@ Clay__MeasureTextCacheItem *Clay__MeasureTextCached(Clay_String *text, Clay_Text
         newItemIndex = context->measureTextHashMapInternal.length - 1;
     }
 
-    int32_t start = 0;
-    int32_t end = 0;
-    float lineWidth = 0;
-    float measuredWidth = 0;
-    float measuredHeight = 0;
-    float spaceWidth = Clay__MeasureText(CLAY__INIT(Clay_StringSlice) { .length = 1, .chars = CLAY__SPACECHAR.chars, .baseChars = CLAY__SPACECHAR.chars }, config, context->measureTextUserData).width;
-    Clay__MeasuredWord tempWord = { .next = -1 };
-    Clay__MeasuredWord *previousWord = &tempWord;
-    while (end < text->length) {
-        if (context->measuredWords.length == context->measuredWords.capacity - 1) {
-            if (!context->booleanWarnings.maxTextMeasureCacheExceeded) {
-                context->errorHandler.errorHandlerFunction(CLAY__INIT(Clay_ErrorData) {
-                    .errorType = CLAY_ERROR_TYPE_TEXT_MEASUREMENT_CAPACITY_EXCEEDED,
-                    .errorText = CLAY_STRING("Clay has run out of space in it's internal text measurement cache. Try using Clay_SetMaxMeasureTextCacheWordCount() (default 16384, with 1 unit storing 1 measured word)."),
-                    .userData = context->errorHandler.userData });
-                context->booleanWarnings.maxTextMeasureCacheExceeded = true;
-            }
-            return &Clay__MeasureTextCacheItem_DEFAULT;
-        }
-        char current = text->chars[end];
-        if (current == ' ' || current == '\n') {
-            int32_t length = end - start;
-            Clay_Dimensions dimensions = Clay__MeasureText(CLAY__INIT(Clay_StringSlice) { .length = length, .chars = &text->chars[start], .baseChars = text->chars }, config, context->measureTextUserData);
-            measuredHeight = CLAY__MAX(measuredHeight, dimensions.height);
-            if (current == ' ') {
-                dimensions.width += spaceWidth;
-                previousWord = Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = start, .length = length + 1, .width = dimensions.width, .next = -1 }, previousWord);
-                lineWidth += dimensions.width;
-            }
-            if (current == '\n') {
-                if (length > 0) {
-                    previousWord = Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = start, .length = length, .width = dimensions.width, .next = -1 }, previousWord);
-                }
-                previousWord = Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = end + 1, .length = 0, .width = 0, .next = -1 }, previousWord);
-                lineWidth += dimensions.width;
-                measuredWidth = CLAY__MAX(lineWidth, measuredWidth);
-                measured->containsNewlines = true;
-                lineWidth = 0;
-            }
-            start = end + 1;
-        }
-        end++;
-    }
-    if (end - start > 0) {
-        Clay_Dimensions dimensions = Clay__MeasureText(CLAY__INIT(Clay_StringSlice) { .length = end - start, .chars = &text->chars[start], .baseChars = text->chars }, config, context->measureTextUserData);
-        Clay__AddMeasuredWord(CLAY__INIT(Clay__MeasuredWord) { .startOffset = start, .length = end - start, .width = dimensions.width, .next = -1 }, previousWord);
-        lineWidth += dimensions.width;
-        measuredHeight = CLAY__MAX(measuredHeight, dimensions.height);
+    #ifndef CLAY_WASM
+    bool complete = Clay__MeasureTextBatch ? Clay__MeasureWordsBatched(text, config, measured) : Clay__MeasureWords(text, config, measured);
+    #else
+    bool complete = Clay__MeasureWords(text, config, measured);
+    #endif
+    if (!complete) {
+        return &Clay__MeasureTextCacheItem_DEFAULT;
     }
-    measuredWidth = CLAY__MAX(lineWidth, measuredWidth);
-
-    measured->measuredWordsStartIndex = tempWord.next;
-    measured->unwrappedDimensions.width = measuredWidth;
-    measured->unwrappedDimensions.height = measuredHeight;
 
     if (elementIndexPrevious != 0) {
         Clay__MeasureTextCacheItemArray_Get(&context->measureTextHashMapInternal, elementIndexPrevious)->nextIndex = newItemIndex;
@@ -1523,60 +2000,129 @@ bool Clay__PointIsInsideRect(Clay_Vector2 point, Clay_BoundingBox rect) {
     return point.x >= rect.x && point.x <= rect.x + rect.width && point.y >= rect.y && point.y <= rect.y + rect.height;
 }
 
+// The element hash map is a Swiss table: each slot has a control byte, either CLAY__HASH_MAP_EMPTY or 7 bits of the hash of
+// the id it holds, and lookups compare a group's control bytes at once before looking at any item. Items are never removed,
+// and the table has at least 1.5 slots per item it can hold, so there is always an empty slot to end a probe.
+
+// Returns a mask with bit i set where group[i] == value.
+#if !defined(CLAY_DISABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64))
+    uint32_t Clay__MatchHashMapGroup(const uint8_t *group, uint8_t value) {
+        __m128i control = _mm_loadu_si128((const __m128i *)group);
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8((char)value)));
+    }
+#elif !defined(CLAY_DISABLE_SIMD) && defined(__aarch64__)
+    uint32_t Clay__MatchHashMapGroup(const uint8_t *group, uint8_t value) {
+        static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+        uint8x16_t matches = vandq_u8(vceqq_u8(vld1q_u8(group), vdupq_n_u8(value)), vld1q_u8(bits));
+        return (uint32_t)vaddv_u8(vget_low_u8(matches)) | ((uint32_t)vaddv_u8(vget_high_u8(matches)) << 8);
+    }
+#else
+    // Eight bytes at a time: a byte of x is zero where it matched. The borrow out of a zero byte can flag the byte above it
+    // too, which only costs an extra id comparison, and can't happen when looking for empty slots as no byte is ever 0x81.
+    uint32_t Clay__MatchHashMapWord(const uint8_t *bytes, uint8_t value) {
+        uint64_t word = (uint64_t)bytes[0] | (uint64_t)bytes[1] << 8 | (uint64_t)bytes[2] << 16 | (uint64_t)bytes[3] << 24
+            | (uint64_t)bytes[4] << 32 | (uint64_t)bytes[5] << 40 | (uint64_t)bytes[6] << 48 | (uint64_t)bytes[7] << 56;
+        uint64_t x = word ^ (0x0101010101010101ull * value);
+        uint64_t zero = (x - 0x0101010101010101ull) & ~x & 0x8080808080808080ull;
+        return (uint32_t)(((zero >> 7) * 0x0102040810204080ull) >> 56); // Gathers the flag bits into the top byte
+    }
+
+    uint32_t Clay__MatchHashMapGroup(const uint8_t *group, uint8_t value) {
+        return Clay__MatchHashMapWord(group, value) | (Clay__MatchHashMapWord(group + 8, value) << 8);
+    }
+#endif
+
+int32_t Clay__LowestSetBit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int32_t bit = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+#ifdef CLAY_ELEMENT_HASH_MAP_STATS
+#define CLAY__COUNT_HASH_MAP_PROBE(stats, groups) ((stats)->lookups++, (stats)->groupsProbed += (groups), (stats)->longestProbe = CLAY__MAX((stats)->longestProbe, (groups)))
+#else
+#define CLAY__COUNT_HASH_MAP_PROBE(stats, groups) ((void)(stats), (void)(groups))
+#endif
+
+// Returns the slot holding id in *group, or if it isn't in the table, the empty slot it would go in.
+int32_t Clay__FindHashMapSlot(Clay_Context *context, uint32_t id, Clay__HashMapGroup **group, Clay_ElementHashMapStats *stats) {
+    uint32_t hash = id * 2654435761u;
+    uint8_t tag = (uint8_t)(hash >> 25);
+    uint32_t mask = (uint32_t)context->layoutElementsHashMapGroups.capacity - 1;
+    uint32_t groupIndex = hash & mask;
+    for (int32_t groups = 1;; groups++) {
+        *group = &context->layoutElementsHashMapGroups.internalArray[groupIndex];
+        uint32_t matches = Clay__MatchHashMapGroup((*group)->control, tag);
+        while (matches) {
+            int32_t slot = Clay__LowestSetBit(matches);
+            if (context->layoutElementsHashMapInternal.internalArray[(*group)->itemIndexes[slot]].elementId.id == id) {
+                CLAY__COUNT_HASH_MAP_PROBE(stats, groups);
+                return slot;
+            }
+            matches &= matches - 1;
+        }
+        uint32_t empty = Clay__MatchHashMapGroup((*group)->control, CLAY__HASH_MAP_EMPTY);
+        if (empty) {
+            CLAY__COUNT_HASH_MAP_PROBE(stats, groups);
+            return Clay__LowestSetBit(empty);
+        }
+        groupIndex = (groupIndex + groups) & mask; // Triangular steps visit every group
+    }
+}
+
 Clay_LayoutElementHashMapItem* Clay__AddHashMapItem(Clay_ElementId elementId, Clay_LayoutElement* layoutElement, uint32_t idAlias) {
     Clay_Context* context = Clay_GetCurrentContext();
     if (context->layoutElementsHashMapInternal.length == context->layoutElementsHashMapInternal.capacity - 1) {
         return NULL;
     }
-    Clay_LayoutElementHashMapItem item = { .elementId = elementId, .layoutElement = layoutElement, .nextIndex = -1, .generation = context->generation + 1, .idAlias = idAlias };
-    uint32_t hashBucket = elementId.id % context->layoutElementsHashMap.capacity;
-    int32_t hashItemPrevious = -1;
-    int32_t hashItemIndex = context->layoutElementsHashMap.internalArray[hashBucket];
-    while (hashItemIndex != -1) { // Just replace collision, not a big deal - leave it up to the end user
-        Clay_LayoutElementHashMapItem *hashItem = Clay__LayoutElementHashMapItemArray_Get(&context->layoutElementsHashMapInternal, hashItemIndex);
-        if (hashItem->elementId.id == elementId.id) { // Collision - resolve based on generation
-            item.nextIndex = hashItem->nextIndex;
-            if (hashItem->generation <= context->generation) { // First collision - assume this is the "same" element
-                hashItem->elementId = elementId; // Make sure to copy this across. If the stringId reference has changed, we should update the hash item to use the new one.
-                hashItem->generation = context->generation + 1;
-                hashItem->layoutElement = layoutElement;
-                hashItem->debugData->collision = false;
-            } else { // Multiple collisions this frame - two elements have the same ID
-                context->errorHandler.errorHandlerFunction(CLAY__INIT(Clay_ErrorData) {
-                    .errorType = CLAY_ERROR_TYPE_DUPLICATE_ID,
-                    .errorText = CLAY_STRING("An element with this ID was already previously declared during this layout."),
-                    .userData = context->errorHandler.userData });
-                if (context->debugModeEnabled) {
-                    hashItem->debugData->collision = true;
-                }
+    Clay__HashMapGroup *group;
+    int32_t slot = Clay__FindHashMapSlot(context, elementId.id, &group, &context->layoutElementsHashMapStats);
+    if (group->control[slot] != CLAY__HASH_MAP_EMPTY) { // Collision - resolve based on generation
+        Clay_LayoutElementHashMapItem *hashItem = Clay__LayoutElementHashMapItemArray_Get(&context->layoutElementsHashMapInternal, group->itemIndexes[slot]);
+        if (hashItem->generation <= context->generation) { // First collision - assume this is the "same" element
+            hashItem->elementId = elementId; // Make sure to copy this across. If the stringId reference has changed, we should update the hash item to use the new one.
+            hashItem->generation = context->generation + 1;
+            hashItem->layoutElement = layoutElement;
+            hashItem->debugData->collision = false;
+        } else { // Multiple collisions this frame - two elements have the same ID
+            context->errorHandler.errorHandlerFunction(CLAY__INIT(Clay_ErrorData) {
+                .errorType = CLAY_ERROR_TYPE_DUPLICATE_ID,
+                .errorText = CLAY_STRING("An element with this ID was already previously declared during this layout."),
+                .userData = context->errorHandler.userData });
+            if (context->debugModeEnabled) {
+                hashItem->debugData->collision = true;
             }
-            return hashItem;
         }
-        hashItemPrevious = hashItemIndex;
-        hashItemIndex = hashItem->nextIndex;
+        return hashItem;
     }
+    Clay_LayoutElementHashMapItem item = { .elementId = elementId, .layoutElement = layoutElement, .generation = context->generation + 1, .idAlias = idAlias };
     Clay_LayoutElementHashMapItem *hashItem = Clay__LayoutElementHashMapItemArray_Add(&context->layoutElementsHashMapInternal, item);
     hashItem->debugData = Clay__DebugElementDataArray_Add(&context->debugElementData, CLAY__INIT(Clay__DebugElementData) CLAY__DEFAULT_STRUCT);
-    if (hashItemPrevious != -1) {
-        Clay__LayoutElementHashMapItemArray_Get(&context->layoutElementsHashMapInternal, hashItemPrevious)->nextIndex = (int32_t)context->layoutElementsHashMapInternal.length - 1;
-    } else {
-        context->layoutElementsHashMap.internalArray[hashBucket] = (int32_t)context->layoutElementsHashMapInternal.length - 1;
-    }
+    group->control[slot] = (uint8_t)((elementId.id * 2654435761u) >> 25);
+    group->itemIndexes[slot] = (int32_t)context->layoutElementsHashMapInternal.length - 1;
     return hashItem;
 }
 
+// Like Clay__GetHashMapItem(), counting the lookup in stats, for the sizing tasks that can't share the context's
+Clay_LayoutElementHashMapItem *Clay__LookUpHashMapItem(Clay_Context *context, uint32_t id, Clay_ElementHashMapStats *stats) {
+    Clay__HashMapGroup *group;
+    int32_t slot = Clay__FindHashMapSlot(context, id, &group, stats);
+    if (group->control[slot] == CLAY__HASH_MAP_EMPTY) {
+        return &Clay_LayoutElementHashMapItem_DEFAULT;
+    }
+    return &context->layoutElementsHashMapInternal.internalArray[group->itemIndexes[slot]];
+}
+
 Clay_LayoutElementHashMapItem *Clay__GetHashMapItem(uint32_t id) {
     Clay_Context* context = Clay_GetCurrentContext();
-    uint32_t hashBucket = id % context->layoutElementsHashMap.capacity;
-    int32_t elementIndex = context->layoutElementsHashMap.internalArray[hashBucket];
-    while (elementIndex != -1) {
-        Clay_LayoutElementHashMapItem *hashEntry = Clay__LayoutElementHashMapItemArray_Get(&context->layoutElementsHashMapInternal, elementIndex);
-        if (hashEntry->elementId.id == id) {
-            return hashEntry;
-        }
-        elementIndex = hashEntry->nextIndex;
-    }
-    return &Clay_LayoutElementHashMapItem_DEFAULT;
+    return Clay__LookUpHashMapItem(context, id, &context->layoutElementsHashMapStats);
 }
 
 Clay_ElementId Clay__GenerateIdForAnonymousElement(Clay_LayoutElement *openLayoutElement) {
@@ -1591,15 +2137,233 @@ Clay_ElementId Clay__GenerateIdForAnonymousElement(Clay_LayoutElement *openLayou
 
 bool Clay__ElementHasConfig(Clay_LayoutElement *layoutElement, Clay__ElementConfigType type) {
     for (int32_t i = 0; i < layoutElement->elementConfigs.length; i++) {
-        if (Clay__ElementConfigArraySlice_Get(&layoutElement->elementConfigs, i)->type == type) {
+        if (layoutElement->elementConfigs.internalArray[i].type == type) {
             return true;
         }
     }
     return false;
 }
 
+void Clay__ResetMemos(Clay_Context *context) {
+    for (int32_t i = 0; i < 2; ++i) {
+        for (int32_t j = 0; j < context->memoItems[i].capacity; ++j) {
+            context->memoItems[i].internalArray[j] = CLAY__INIT(Clay__MemoItem) CLAY__DEFAULT_STRUCT;
+        }
+        context->memoItems[i].length = context->memoItems[i].capacity; // This array is accessed directly rather than behaving as a list
+        context->memoOps[i].length = 0;
+    }
+    // Frame 0 is what an empty slot has, so live frames start after it
+    context->memoFrame = 1;
+    context->memoItemCount = 0;
+}
+
+// Returns the slot for key in a memo table, or the empty slot it would go in. Clay__EndMemo keeps each table at most half
+// full, so there always is one.
+Clay__MemoItem *Clay__FindMemoSlot(Clay__MemoItemArray *items, uint32_t frame, uint32_t key) {
+    uint32_t mask = (uint32_t)items->capacity - 1;
+    uint32_t index = (key * 2654435761u) & mask;
+    while (true) {
+        Clay__MemoItem *item = &items->internalArray[index];
+        if (item->frame != frame || item->key == key) {
+            return item;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+// Stops recording memos for the rest of the layout. The memos left open are not stored, so they run their body next layout.
+void Clay__MemoCapacityExceeded(Clay_Context *context) {
+    context->memoOpsExceeded = true;
+    context->errorHandler.errorHandlerFunction(CLAY__INIT(Clay_ErrorData) {
+            .errorType = CLAY_ERROR_TYPE_MEMO_CAPACITY_EXCEEDED,
+            .errorText = CLAY_STRING("Clay ran out of capacity while recording memoized elements. Try using Clay_SetMaxElementCount() with a higher value."),
+            .userData = context->errorHandler.userData });
+}
+
+// Returns the op to fill in if a memo is being recorded, or NULL.
+Clay__MemoOp *Clay__AddMemoOp(Clay__MemoOpType type) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    if (context->openMemos.length == 0 || context->memoReplaying || context->memoOpsExceeded) {
+        return CLAY__NULL;
+    }
+    Clay__MemoOpArray *ops = &context->memoOps[context->memoFrame & 1];
+    if (ops->length == ops->capacity) {
+        Clay__MemoCapacityExceeded(context);
+        return CLAY__NULL;
+    }
+    Clay__MemoOp *op = &ops->internalArray[ops->length++];
+    op->type = type;
+    return op;
+}
+
+// Starts recording a memo, or if the previous layout recorded it with the same input under the same parent, declares its
+// elements again and returns 1 so that the body is skipped. The recording is carried over into this frame's buffer so it
+// survives another frame.
+uint8_t Clay__BeginMemo(uint32_t key, uint32_t inputHash) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    // The body runs as plain declarations. Everything nested in it ends up here too, as neither condition clears while
+    // it runs, so counting is enough for Clay__EndMemo to tell these apart from the memos in openMemos.
+    if (context->untrackedMemoDepth > 0 || context->booleanWarnings.maxElementsExceeded || context->openMemos.length == context->openMemos.capacity) {
+        context->untrackedMemoDepth++;
+        return 0;
+    }
+    uint32_t current = context->memoFrame & 1;
+    uint32_t parentId = Clay__GetOpenLayoutElement()->id;
+    Clay__OpenMemoArray_Add(&context->openMemos, CLAY__INIT(Clay__OpenMemo) { .key = key, .inputHash = inputHash, .parentId = parentId, .opsStartIndex = context->memoOps[current].length });
+    Clay__MemoItem *previous = Clay__FindMemoSlot(&context->memoItems[current ^ 1], context->memoFrame - 1, key);
+    if (previous->frame != context->memoFrame - 1 || previous->inputHash != inputHash || previous->parentId != parentId) {
+        context->layoutStats.memosRecorded++;
+        return 0;
+    }
+    context->layoutStats.memosReplayed++;
+    Clay__MemoOpArray *currentOps = &context->memoOps[current];
+    Clay__MemoOp *replayOps = &context->memoOps[current ^ 1].internalArray[previous->opsStartIndex];
+    bool replaying = context->memoReplaying;
+    if (!context->memoReplaying && !context->memoOpsExceeded) {
+        if (currentOps->length + previous->opCount > currentOps->capacity) {
+            Clay__MemoCapacityExceeded(context);
+        } else {
+            for (int32_t i = 0; i < previous->opCount; ++i) {
+                currentOps->internalArray[currentOps->length++] = replayOps[i];
+            }
+        }
+    }
+    context->memoReplaying = true;
+    for (int32_t i = 0; i < previous->opCount; ++i) {
+        Clay__MemoOp *op = &replayOps[i];
+        switch (op->type) {
+            case CLAY__MEMO_OP_OPEN: {
+                Clay__OpenElement();
+                Clay__ConfigureOpenElement(op->data.declaration);
+                break;
+            }
+            case CLAY__MEMO_OP_CLOSE: Clay__CloseElement(); break;
+            case CLAY__MEMO_OP_TEXT: Clay__OpenTextElement(op->data.text.text, Clay__StoreTextElementConfig(op->data.text.config)); break;
+            case CLAY__MEMO_OP_HOVER: Clay_OnHover(op->data.hover.function, op->data.hover.userData); break;
+        }
+    }
+    context->memoReplaying = replaying;
+    Clay__EndMemo();
+    return 1;
+}
+
+void Clay__EndMemo(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    if (context->untrackedMemoDepth > 0) {
+        context->untrackedMemoDepth--;
+        return;
+    }
+    if (context->openMemos.length == 0) {
+        return;
+    }
+    Clay__OpenMemo memo = context->openMemos.internalArray[--context->openMemos.length];
+    if (context->memoReplaying || context->memoOpsExceeded) {
+        return;
+    }
+    uint32_t current = context->memoFrame & 1;
+    Clay__MemoItem *item = Clay__FindMemoSlot(&context->memoItems[current], context->memoFrame, memo.key);
+    if (item->frame != context->memoFrame) {
+        // Past half full, probe chains get long and a full table would have no empty slot left to end a probe on
+        if (context->memoItemCount >= context->memoItems[current].capacity / 2) {
+            Clay__MemoCapacityExceeded(context);
+            return;
+        }
+        context->memoItemCount++;
+    }
+    *item = CLAY__INIT(Clay__MemoItem) { .key = memo.key, .frame = context->memoFrame, .inputHash = memo.inputHash, .parentId = memo.parentId, .opsStartIndex = memo.opsStartIndex, .opCount = context->memoOps[current].length - memo.opsStartIndex };
+}
+
+// Copies what the sizing passes read about a finished element into their own arrays, so that sizing children doesn't
+// follow each child's layout config and config list pointers.
+void Clay__StoreSizingData(int32_t elementIndex, Clay_LayoutElement *element) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    uint8_t flags = 0;
+    for (int32_t i = 0; i < element->elementConfigs.length; i++) {
+        Clay_ElementConfig *config = Clay__ElementConfigArraySlice_Get(&element->elementConfigs, i);
+        switch (config->type) {
+            case CLAY__ELEMENT_CONFIG_TYPE_TEXT: {
+                flags |= CLAY__SIZING_FLAG_TEXT;
+                if (config->config.textElementConfig->wrapMode == CLAY_TEXT_WRAP_WORDS) {
+                    flags |= CLAY__SIZING_FLAG_WRAP_WORDS;
+                }
+                break;
+            }
+            case CLAY__ELEMENT_CONFIG_TYPE_IMAGE: flags |= CLAY__SIZING_FLAG_IMAGE; break;
+            case CLAY__ELEMENT_CONFIG_TYPE_SCROLL: {
+                if (config->config.scrollElementConfig->horizontal) {
+                    flags |= CLAY__SIZING_FLAG_SCROLL_HORIZONTAL;
+                }
+                if (config->config.scrollElementConfig->vertical) {
+                    flags |= CLAY__SIZING_FLAG_SCROLL_VERTICAL;
+                }
+                break;
+            }
+            default: break;
+        }
+    }
+    Clay__SizingAxisArray_Set(&context->layoutElementSizing[0], elementIndex, element->layoutConfig->sizing.width);
+    Clay__SizingAxisArray_Set(&context->layoutElementSizing[1], elementIndex, element->layoutConfig->sizing.height);
+    Clay__uint8_tArray_Set(&context->layoutElementSizingFlags, elementIndex, flags);
+}
+
+uint32_t Clay__MixFingerprint(uint32_t hash, uint32_t value) {
+    hash += value;
+    hash += (hash << 10);
+    hash ^= (hash >> 6);
+    return hash;
+}
+
+uint32_t Clay__MixFingerprintFloat(uint32_t hash, float value) {
+    union { float f; uint32_t u; } bits = { .f = value };
+    return Clay__MixFingerprint(hash, bits.u);
+}
+
+uint32_t Clay__MixFingerprintSizing(uint32_t hash, Clay_SizingAxis sizing) {
+    hash = Clay__MixFingerprint(hash, sizing.type);
+    if (sizing.type == CLAY__SIZING_TYPE_PERCENT) {
+        return Clay__MixFingerprintFloat(hash, sizing.size.percent);
+    }
+    hash = Clay__MixFingerprintFloat(hash, sizing.size.minMax.min);
+    return Clay__MixFingerprintFloat(hash, sizing.size.minMax.max);
+}
+
+// Hashes everything that goes into sizing the element and its children: its id, layout, the configs that change how it
+// is sized, and the fingerprints of its children, which have already been closed. Positions are not covered.
+uint32_t Clay__ElementFingerprint(Clay_LayoutElement *element) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay_LayoutConfig *layoutConfig = element->layoutConfig;
+    uint32_t hash = Clay__MixFingerprint(0, element->id);
+    hash = Clay__MixFingerprintSizing(hash, layoutConfig->sizing.width);
+    hash = Clay__MixFingerprintSizing(hash, layoutConfig->sizing.height);
+    hash = Clay__MixFingerprint(hash, ((uint32_t)layoutConfig->padding.left << 16) | layoutConfig->padding.right);
+    hash = Clay__MixFingerprint(hash, ((uint32_t)layoutConfig->padding.top << 16) | layoutConfig->padding.bottom);
+    hash = Clay__MixFingerprint(hash, ((uint32_t)layoutConfig->childGap << 16) | layoutConfig->layoutDirection);
+    for (int32_t i = 0; i < element->elementConfigs.length; i++) {
+        Clay_ElementConfig *config = Clay__ElementConfigArraySlice_Get(&element->elementConfigs, i);
+        hash = Clay__MixFingerprint(hash, config->type);
+        if (config->type == CLAY__ELEMENT_CONFIG_TYPE_SCROLL) {
+            hash = Clay__MixFingerprint(hash, (config->config.scrollElementConfig->horizontal << 1) | config->config.scrollElementConfig->vertical);
+        } else if (config->type == CLAY__ELEMENT_CONFIG_TYPE_IMAGE) {
+            hash = Clay__MixFingerprintFloat(hash, config->config.imageElementConfig->sourceDimensions.width);
+            hash = Clay__MixFingerprintFloat(hash, config->config.imageElementConfig->sourceDimensions.height);
+        }
+    }
+    for (int32_t i = 0; i < element->childrenOrTextContent.children.length; i++) {
+        Clay_LayoutElement *child = Clay_LayoutElementArray_Get(&context->layoutElements, element->childrenOrTextContent.children.elements[i]);
+        if (child->fingerprint == 0) {
+            return 0;
+        }
+        hash = Clay__MixFingerprint(hash, child->fingerprint);
+    }
+    hash += (hash << 3);
+    hash ^= (hash >> 11);
+    hash += (hash << 15);
+    return hash + 1; // Reserve zero for "unknown"
+}
+
 void Clay__CloseElement(void) {
     Clay_Context* context = Clay_GetCurrentContext();
+    Clay__AddMemoOp(CLAY__MEMO_OP_CLOSE);
     if (context->booleanWarnings.maxElementsExceeded) {
         return;
     }
@@ -1684,10 +2448,13 @@ void Clay__CloseElement(void) {
         openLayoutElement->dimensions.height = 0;
     }
 
+    openLayoutElement->fingerprint = Clay__ElementFingerprint(openLayoutElement);
+
     bool elementIsFloating = Clay__ElementHasConfig(openLayoutElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING);
 
     // Close the currently open element
     int32_t closingElementIndex = Clay__int32_tArray_RemoveSwapback(&context->openLayoutElementStack, (int)context->openLayoutElementStack.length - 1);
+    Clay__StoreSizingData(closingElementIndex, openLayoutElement);
     openLayoutElement = Clay__GetOpenLayoutElement();
 
     if (!elementIsFloating && context->openLayoutElementStack.length > 1) {
@@ -1761,6 +2528,17 @@ bool Clay__MemCmp(const char *s1, const char *s2, int32_t length);
     }
 #endif
 
+// Counts the element just added towards the tree root of the element it is declared in. A floating element moves to its own
+// root once it is configured.
+void Clay__AddElementToOpenTreeRoot(Clay_Context *context) {
+    int32_t treeRootIndex = 0;
+    if (context->openLayoutElementStack.length > 0) {
+        treeRootIndex = Clay__int32_tArray_GetValue(&context->layoutElementTreeRootIndexes, Clay__int32_tArray_GetValue(&context->openLayoutElementStack, (int)context->openLayoutElementStack.length - 1));
+        Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, treeRootIndex)->elementCount++;
+    }
+    Clay__int32_tArray_Set(&context->layoutElementTreeRootIndexes, context->layoutElements.length - 1, treeRootIndex);
+}
+
 void Clay__OpenElement(void) {
     Clay_Context* context = Clay_GetCurrentContext();
     if (context->layoutElements.length == context->layoutElements.capacity - 1 || context->booleanWarnings.maxElementsExceeded) {
@@ -1769,6 +2547,7 @@ void Clay__OpenElement(void) {
     }
     Clay_LayoutElement layoutElement = CLAY__DEFAULT_STRUCT;
     Clay_LayoutElementArray_Add(&context->layoutElements, layoutElement);
+    Clay__AddElementToOpenTreeRoot(context);
     Clay__int32_tArray_Add(&context->openLayoutElementStack, context->layoutElements.length - 1);
     if (context->openClipElementStack.length > 0) {
         Clay__int32_tArray_Set(&context->layoutElementClipElementIds, context->layoutElements.length - 1, Clay__int32_tArray_GetValue(&context->openClipElementStack, (int)context->openClipElementStack.length - 1));
@@ -1779,6 +2558,11 @@ void Clay__OpenElement(void) {
 
 void Clay__OpenTextElement(Clay_String text, Clay_TextElementConfig *textConfig) {
     Clay_Context* context = Clay_GetCurrentContext();
+    Clay__MemoOp *memoOp = Clay__AddMemoOp(CLAY__MEMO_OP_TEXT);
+    if (memoOp) {
+        memoOp->data.text.text = text;
+        memoOp->data.text.config = *textConfig;
+    }
     if (context->layoutElements.length == context->layoutElements.capacity - 1 || context->booleanWarnings.maxElementsExceeded) {
         context->booleanWarnings.maxElementsExceeded = true;
         return;
@@ -1787,6 +2571,7 @@ void Clay__OpenTextElement(Clay_String text, Clay_TextElementConfig *textConfig)
 
     Clay_LayoutElement layoutElement = CLAY__DEFAULT_STRUCT;
     Clay_LayoutElement *textElement = Clay_LayoutElementArray_Add(&context->layoutElements, layoutElement);
+    Clay__AddElementToOpenTreeRoot(context);
     if (context->openClipElementStack.length > 0) {
         Clay__int32_tArray_Set(&context->layoutElementClipElementIds, context->layoutElements.length - 1, Clay__int32_tArray_GetValue(&context->openClipElementStack, (int)context->openClipElementStack.length - 1));
     } else {
@@ -1802,12 +2587,15 @@ void Clay__OpenTextElement(Clay_String text, Clay_TextElementConfig *textConfig)
     Clay_Dimensions textDimensions = { .width = textMeasured->unwrappedDimensions.width, .height = textConfig->lineHeight > 0 ? (float)textConfig->lineHeight : textMeasured->unwrappedDimensions.height };
     textElement->dimensions = textDimensions;
     textElement->minDimensions = CLAY__INIT(Clay_Dimensions) { .width = textMeasured->unwrappedDimensions.height, .height = textDimensions.height }; // TODO not sure this is the best way to decide min width for text
-    textElement->childrenOrTextContent.textElementData = Clay__TextElementDataArray_Add(&context->textElementData, CLAY__INIT(Clay__TextElementData) { .text = text, .preferredDimensions = textMeasured->unwrappedDimensions, .elementIndex = context->layoutElements.length - 1 });
+    textElement->childrenOrTextContent.textElementData = Clay__TextElementDataArray_Add(&context->textElementData, CLAY__INIT(Clay__TextElementData) { .text = text, .preferredDimensions = textMeasured->unwrappedDimensions, .elementIndex = context->layoutElements.length - 1, .textId = textMeasured->id });
     textElement->elementConfigs = CLAY__INIT(Clay__ElementConfigArraySlice) {
             .length = 1,
             .internalArray = Clay__ElementConfigArray_Add(&context->elementConfigs, CLAY__INIT(Clay_ElementConfig) { .type = CLAY__ELEMENT_CONFIG_TYPE_TEXT, .config = { .textElementConfig = textConfig }})
     };
     textElement->layoutConfig = &CLAY_LAYOUT_DEFAULT;
+    // The measure cache id already covers the text and its config
+    textElement->fingerprint = textMeasured->id == 0 ? 0 : Clay__MixFingerprint(Clay__MixFingerprint(0, elementId.id), textMeasured->id) + 1;
+    Clay__StoreSizingData(context->layoutElements.length - 1, textElement);
     parentElement->childrenOrTextContent.children.length++;
 }
 
@@ -1826,6 +2614,10 @@ Clay_ElementId Clay__AttachId(Clay_ElementId elementId) {
 
 void Clay__ConfigureOpenElement(const Clay_ElementDeclaration declaration) {
     Clay_Context* context = Clay_GetCurrentContext();
+    Clay__MemoOp *memoOp = Clay__AddMemoOp(CLAY__MEMO_OP_OPEN);
+    if (memoOp) {
+        memoOp->data.declaration = declaration;
+    }
     Clay_LayoutElement *openLayoutElement = Clay__GetOpenLayoutElement();
     openLayoutElement->layoutConfig = Clay__StoreLayoutConfig(declaration.layout);
     if ((declaration.layout.sizing.width.type == CLAY__SIZING_TYPE_PERCENT && declaration.layout.sizing.width.size.percent > 1) || (declaration.layout.sizing.height.type == CLAY__SIZING_TYPE_PERCENT && declaration.layout.sizing.height.size.percent > 1)) {
@@ -1891,11 +2683,15 @@ void Clay__ConfigureOpenElement(const Clay_ElementDeclaration declaration) {
             if (!openLayoutElementId.id) {
                 openLayoutElementId = Clay__HashString(CLAY_STRING("Clay__FloatingContainer"), context->layoutElementTreeRoots.length, 0);
             }
+            int32_t floatingElementIndex = Clay__int32_tArray_GetValue(&context->openLayoutElementStack, context->openLayoutElementStack.length - 1);
+            Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, Clay__int32_tArray_GetValue(&context->layoutElementTreeRootIndexes, floatingElementIndex))->elementCount--;
+            Clay__int32_tArray_Set(&context->layoutElementTreeRootIndexes, floatingElementIndex, context->layoutElementTreeRoots.length);
             Clay__LayoutElementTreeRootArray_Add(&context->layoutElementTreeRoots, CLAY__INIT(Clay__LayoutElementTreeRoot) {
-                    .layoutElementIndex = Clay__int32_tArray_GetValue(&context->openLayoutElementStack, context->openLayoutElementStack.length - 1),
+                    .layoutElementIndex = floatingElementIndex,
                     .parentId = floatingConfig.parentId,
                     .clipElementId = clipElementId,
                     .zIndex = floatingConfig.zIndex,
+                    .elementCount = 1,
             });
             Clay__AttachElementConfig(CLAY__INIT(Clay_ElementConfigUnion) { .floatingElementConfig = Clay__StoreFloatingElementConfig(declaration.floating) }, CLAY__ELEMENT_CONFIG_TYPE_FLOATING);
         }
@@ -1944,6 +2740,7 @@ void Clay__InitializeEphemeralMemory(Clay_Context* context) {
     context->layoutElementChildrenBuffer = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
     context->layoutElements = Clay_LayoutElementArray_Allocate_Arena(maxElementCount, arena);
     context->warnings = Clay__WarningArray_Allocate_Arena(100, arena);
+    context->openMemos = Clay__OpenMemoArray_Allocate_Arena(maxElementCount, arena);
 
     context->layoutConfigs = Clay__LayoutConfigArray_Allocate_Arena(maxElementCount, arena);
     context->elementConfigs = Clay__ElementConfigArray_Allocate_Arena(maxElementCount, arena);
@@ -1959,6 +2756,7 @@ void Clay__InitializeEphemeralMemory(Clay_Context* context) {
     context->wrappedTextLines = Clay__WrappedTextLineArray_Allocate_Arena(maxElementCount, arena);
     context->layoutElementTreeNodeArray1 = Clay__LayoutElementTreeNodeArray_Allocate_Arena(maxElementCount, arena);
     context->layoutElementTreeRoots = Clay__LayoutElementTreeRootArray_Allocate_Arena(maxElementCount, arena);
+    context->layoutElementTreeRootsSortBuffer = Clay__LayoutElementTreeRootArray_Allocate_Arena(maxElementCount, arena);
     context->layoutElementChildren = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
     context->openLayoutElementStack = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
     context->textElementData = Clay__TextElementDataArray_Allocate_Arena(maxElementCount, arena);
@@ -1969,6 +2767,21 @@ void Clay__InitializeEphemeralMemory(Clay_Context* context) {
     context->openClipElementStack = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
     context->reusableElementIndexBuffer = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
     context->layoutElementClipElementIds = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->layoutElementTreeRootIndexes = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->treeRootSizingTasks = Clay__TreeRootSizingTaskArray_Allocate_Arena(CLAY__TREE_ROOT_SIZING_BATCH_SIZE, arena);
+    context->resizeScratch = Clay__int32_tArray_Allocate_Arena(maxElementCount * CLAY__RESIZE_SCRATCH_PER_ELEMENT, arena);
+    context->layoutElementSizing[0] = Clay__SizingAxisArray_Allocate_Arena(maxElementCount, arena);
+    context->layoutElementSizing[1] = Clay__SizingAxisArray_Allocate_Arena(maxElementCount, arena);
+    context->layoutElementSizingFlags = Clay__uint8_tArray_Allocate_Arena(maxElementCount, arena);
+    context->layoutElementResizePositions = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->layoutElementResizeSteps = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->pointerGrid.built = false;
+    context->pointerGridEntries = Clay__PointerGridEntryArray_Allocate_Arena(maxElementCount, arena);
+    context->pointerGridRootStarts = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->pointerGridCellHeads = Clay__int32_tArray_Allocate_Arena(CLAY__POINTER_GRID_MAX_COLUMNS * CLAY__POINTER_GRID_MAX_COLUMNS + 1, arena);
+    context->pointerGridCellTails = Clay__int32_tArray_Allocate_Arena(CLAY__POINTER_GRID_MAX_COLUMNS * CLAY__POINTER_GRID_MAX_COLUMNS + 1, arena);
+    // Large elements take one list entry each on top of what cells may use
+    context->pointerGridCellEntries = Clay__PointerGridCellEntryArray_Allocate_Arena(maxElementCount * (CLAY__POINTER_GRID_CELL_ENTRIES_PER_ELEMENT + 1), arena);
     context->dynamicStringData = Clay__charArray_Allocate_Arena(maxElementCount, arena);
 }
 
@@ -1980,216 +2793,687 @@ void Clay__InitializePersistentMemory(Clay_Context* context) {
 
     context->scrollContainerDatas = Clay__ScrollContainerDataInternalArray_Allocate_Arena(10, arena);
     context->layoutElementsHashMapInternal = Clay__LayoutElementHashMapItemArray_Allocate_Arena(maxElementCount, arena);
-    context->layoutElementsHashMap = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    int32_t hashMapGroupCount = 1;
+    while (hashMapGroupCount * CLAY__HASH_MAP_GROUP_WIDTH < maxElementCount + maxElementCount / 2) {
+        hashMapGroupCount *= 2;
+    }
+    context->layoutElementsHashMapGroups = Clay__HashMapGroupArray_Allocate_Arena(hashMapGroupCount, arena);
     context->measureTextHashMapInternal = Clay__MeasureTextCacheItemArray_Allocate_Arena(maxElementCount, arena);
     context->measureTextHashMapInternalFreeList = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
     context->measuredWordsFreeList = Clay__int32_tArray_Allocate_Arena(maxMeasureTextCacheWordCount, arena);
     context->measureTextHashMap = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
     context->measuredWords = Clay__MeasuredWordArray_Allocate_Arena(maxMeasureTextCacheWordCount, arena);
     context->pointerOverIds = Clay__ElementIdArray_Allocate_Arena(maxElementCount, arena);
+    context->pointerOverItems = Clay__int32_tArray_Allocate_Arena(maxElementCount, arena);
+    context->pointerTests = Clay__PointerTestArray_Allocate_Arena(maxElementCount, arena);
     context->debugElementData = Clay__DebugElementDataArray_Allocate_Arena(maxElementCount, arena);
+    int32_t wrapCacheCapacity = 1;
+    while (wrapCacheCapacity < maxElementCount * 2) {
+        wrapCacheCapacity *= 2;
+    }
+    for (int32_t i = 0; i < 2; ++i) {
+        context->wrapCacheItems[i] = Clay__WrapCacheItemArray_Allocate_Arena(wrapCacheCapacity, arena);
+        context->wrapCacheLines[i] = Clay__WrapCacheLineArray_Allocate_Arena(maxElementCount, arena);
+        context->memoItems[i] = Clay__MemoItemArray_Allocate_Arena(wrapCacheCapacity, arena);
+        context->memoOps[i] = Clay__MemoOpArray_Allocate_Arena(maxElementCount, arena);
+    }
     context->arenaResetOffset = arena->nextAllocation;
 }
 
-void Clay__CompressChildrenAlongAxis(bool xAxis, float totalSizeToDistribute, Clay__int32_tArray resizableContainerBuffer) {
-    Clay_Context* context = Clay_GetCurrentContext();
-    Clay__int32_tArray largestContainers = context->openClipElementStack;
+typedef CLAY_PACKED_ENUM {
+    CLAY__RESIZE_SORT_SIZE,
+    CLAY__RESIZE_SORT_MIN_SIZE,
+} Clay__ResizeSortKey;
+
+float Clay__ResizeSortValue(Clay_Context *context, int32_t elementIndex, bool xAxis, Clay__ResizeSortKey key) {
+    Clay_LayoutElement *element = &context->layoutElements.internalArray[elementIndex];
+    Clay_Dimensions dimensions = key == CLAY__RESIZE_SORT_MIN_SIZE ? element->minDimensions : element->dimensions;
+    return xAxis ? dimensions.width : dimensions.height;
+}
 
-    while (totalSizeToDistribute > 0.1) {
-        largestContainers.length = 0;
-        float largestSize = 0;
-        float targetSize = 0;
-        for (int32_t i = 0; i < resizableContainerBuffer.length; ++i) {
-            Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, i));
-            float childSize = xAxis ? childElement->dimensions.width : childElement->dimensions.height;
-            if ((childSize - largestSize) < 0.1 && (childSize - largestSize) > -0.1) {
-                Clay__int32_tArray_Add(&largestContainers, Clay__int32_tArray_GetValue(&resizableContainerBuffer, i));
-            } else if (childSize > largestSize) {
-                targetSize = largestSize;
-                largestSize = childSize;
-                largestContainers.length = 0;
-                Clay__int32_tArray_Add(&largestContainers, Clay__int32_tArray_GetValue(&resizableContainerBuffer, i));
+#define CLAY__RESIZE_SORT_RUN_LENGTH 16
+
+// Stable sort of element indexes by key, smallest first. buffer needs room for as many indexes. Short runs are insertion
+// sorted, then merged in pairs until one is left.
+void Clay__SortResizableChildren(Clay_Context *context, int32_t *elementIndexes, int32_t length, int32_t *buffer, bool xAxis, Clay__ResizeSortKey key) {
+    for (int32_t runStart = 0; runStart < length; runStart += CLAY__RESIZE_SORT_RUN_LENGTH) {
+        int32_t runEnd = CLAY__MIN(runStart + CLAY__RESIZE_SORT_RUN_LENGTH, length);
+        for (int32_t i = runStart + 1; i < runEnd; ++i) {
+            int32_t elementIndex = elementIndexes[i];
+            float value = Clay__ResizeSortValue(context, elementIndex, xAxis, key);
+            int32_t j = i;
+            for (; j > runStart && Clay__ResizeSortValue(context, elementIndexes[j - 1], xAxis, key) > value; --j) {
+                elementIndexes[j] = elementIndexes[j - 1];
             }
-            else if (childSize > targetSize) {
-                targetSize = childSize;
+            elementIndexes[j] = elementIndex;
+        }
+    }
+    int32_t *from = elementIndexes;
+    int32_t *to = buffer;
+    for (int32_t width = CLAY__RESIZE_SORT_RUN_LENGTH; width < length; width *= 2) {
+        for (int32_t start = 0; start < length; start += width * 2) {
+            int32_t middle = CLAY__MIN(start + width, length);
+            int32_t end = CLAY__MIN(start + width * 2, length);
+            int32_t left = start, right = middle;
+            for (int32_t i = start; i < end; ++i) {
+                if (left < middle && (right == end || Clay__ResizeSortValue(context, from[left], xAxis, key) <= Clay__ResizeSortValue(context, from[right], xAxis, key))) {
+                    to[i] = from[left++];
+                } else {
+                    to[i] = from[right++];
+                }
             }
         }
+        int32_t *swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != elementIndexes) {
+        for (int32_t i = 0; i < length; ++i) {
+            elementIndexes[i] = from[i];
+        }
+    }
+}
+
+// Swaps the child at position out of resizableContainerBuffer, keeping layoutElementResizePositions up to date, and
+// returns the child moved into its place, or -1 if it was the last one.
+int32_t Clay__RemoveResizableChild(Clay_Context *context, Clay__int32_tArray *resizableContainerBuffer, int32_t position) {
+    resizableContainerBuffer->length--;
+    if (position == resizableContainerBuffer->length) {
+        return -1;
+    }
+    int32_t movedElementIndex = resizableContainerBuffer->internalArray[resizableContainerBuffer->length];
+    resizableContainerBuffer->internalArray[position] = movedElementIndex;
+    context->layoutElementResizePositions.internalArray[movedElementIndex] = position;
+    return movedElementIndex;
+}
+
+// Sizes of the children being compressed, by buffer position, in a tree where each node holds the largest size below
+// it. Leaves start at leafCount, and positions past the end of the buffer hold -CLAY__MAXFLOAT.
+void Clay__SetCompressedChildSize(float *sizes, int32_t leafCount, int32_t position, float size) {
+    int32_t node = leafCount + position;
+    sizes[node] = size;
+    // Stop once a node keeps its size, as none above it can change then
+    for (node /= 2; node > 0; node /= 2) {
+        float largest = CLAY__MAX(sizes[node * 2], sizes[node * 2 + 1]);
+        if (sizes[node] == largest) {
+            break;
+        }
+        sizes[node] = largest;
+    }
+}
 
-        if (largestContainers.length == 0) {
+// The first position from `from` on where a scan would take a new largest size, one 0.1 or more above largestSize, or -1.
+int32_t Clay__FindLargerCompressedChild(float *sizes, int32_t node, int32_t nodeStart, int32_t nodeSize, int32_t from, float largestSize) {
+    if (nodeStart + nodeSize <= from || !((sizes[node] - largestSize) >= 0.1)) {
+        return -1;
+    }
+    if (nodeSize == 1) {
+        return nodeStart;
+    }
+    int32_t position = Clay__FindLargerCompressedChild(sizes, node * 2, nodeStart, nodeSize / 2, from, largestSize);
+    if (position < 0) {
+        position = Clay__FindLargerCompressedChild(sizes, node * 2 + 1, nodeStart + nodeSize / 2, nodeSize / 2, from, largestSize);
+    }
+    return position;
+}
+
+// Adds the children from `from` on within 0.1 of largestSize to largestContainers in buffer order, and raises targetSize to
+// the largest size of the rest. None of them are 0.1 or more above largestSize.
+void Clay__CollectLargestCompressedChildren(float *sizes, int32_t *resizableContainers, int32_t node, int32_t nodeStart, int32_t nodeSize, int32_t from, float largestSize, int32_t *largestContainers, int32_t *largestCount, float *targetSize) {
+    if (nodeStart + nodeSize <= from) {
+        return;
+    }
+    if (nodeStart >= from && !((sizes[node] - largestSize) > -0.1)) {
+        *targetSize = CLAY__MAX(*targetSize, sizes[node]);
+        return;
+    }
+    if (nodeSize == 1) {
+        largestContainers[(*largestCount)++] = resizableContainers[nodeStart];
+        return;
+    }
+    Clay__CollectLargestCompressedChildren(sizes, resizableContainers, node * 2, nodeStart, nodeSize / 2, from, largestSize, largestContainers, largestCount, targetSize);
+    Clay__CollectLargestCompressedChildren(sizes, resizableContainers, node * 2 + 1, nodeStart + nodeSize / 2, nodeSize / 2, from, largestSize, largestContainers, largestCount, targetSize);
+}
+
+// Takes totalSizeToDistribute away from the children a step at a time. A step scans resizableContainerBuffer in order for
+// the largest children, those within 0.1 of the largest size met so far, and the size below them. They shrink to that
+// size or to what takes away the rest, and those that reach their minimum size are swapped out of the buffer.
+// The scan is replayed rather than run. The positions where it takes a new largest size form a chain, each one the first
+// 0.1 or more above the one before, found from a tree of the largest size under each range of positions. A step only
+// changes children from the last of them on, so the chain is kept between steps, and the next scan picks up from the one
+// before. The largest children and the size below them are then read from the tree past the end of the chain.
+// Each step still has to shrink its largest children one at a time in buffer order, as totalSizeToDistribute has to come
+// out the same, so with n children and k of them shrunk over all steps, compressing takes O((n + k) log n) against the
+// O(n) per step of a full scan.
+void Clay__CompressChildrenAlongAxis(Clay_Context *context, bool xAxis, float totalSizeToDistribute, Clay__int32_tArray resizableContainerBuffer, Clay__int32_tArray scratch) {
+    int32_t *positions = context->layoutElementResizePositions.internalArray;
+    int32_t leafCount = 1;
+    while (leafCount < resizableContainerBuffer.length) {
+        leafCount *= 2;
+    }
+    float *sizes = (float *)scratch.internalArray;
+    int32_t *chain = scratch.internalArray + leafCount * 2;
+    int32_t *largestContainers = chain + resizableContainerBuffer.length;
+    for (int32_t i = 0; i < leafCount; ++i) {
+        if (i < resizableContainerBuffer.length) {
+            positions[resizableContainerBuffer.internalArray[i]] = i;
+            sizes[leafCount + i] = Clay__ResizeSortValue(context, resizableContainerBuffer.internalArray[i], xAxis, CLAY__RESIZE_SORT_SIZE);
+        } else {
+            sizes[leafCount + i] = -CLAY__MAXFLOAT;
+        }
+    }
+    for (int32_t node = leafCount - 1; node > 0; --node) {
+        sizes[node] = CLAY__MAX(sizes[node * 2], sizes[node * 2 + 1]);
+    }
+
+    int32_t chainLength = 0;
+    int32_t scanFrom = 0;
+    while (totalSizeToDistribute > 0.1) {
+        float largestSize = chainLength > 0 ? sizes[leafCount + chain[chainLength - 1]] : 0;
+        for (int32_t position; (position = Clay__FindLargerCompressedChild(sizes, 1, 0, leafCount, scanFrom, largestSize)) >= 0; ) {
+            chain[chainLength++] = position;
+            largestSize = sizes[leafCount + position];
+            scanFrom = position + 1;
+        }
+
+        int32_t largestCount = 0;
+        float targetSize = chainLength > 1 ? sizes[leafCount + chain[chainLength - 2]] : 0;
+        int32_t collectFrom = 0;
+        if (chainLength > 0) {
+            largestContainers[largestCount++] = resizableContainerBuffer.internalArray[chain[chainLength - 1]];
+            collectFrom = chain[chainLength - 1] + 1;
+        }
+        Clay__CollectLargestCompressedChildren(sizes, resizableContainerBuffer.internalArray, 1, 0, leafCount, collectFrom, largestSize, largestContainers, &largestCount, &targetSize);
+
+        if (largestCount == 0) {
             return;
         }
 
-        targetSize = CLAY__MAX(targetSize, (largestSize * largestContainers.length) - totalSizeToDistribute) / largestContainers.length;
+        targetSize = CLAY__MAX(targetSize, (largestSize * largestCount) - totalSizeToDistribute) / largestCount;
+
+        for (int32_t childOffset = 0; childOffset < largestCount; childOffset++) {
+            int32_t childIndex = largestContainers[childOffset];
+            Clay_LayoutElement *childElement = &context->layoutElements.internalArray[childIndex];
+            float *childSize = xAxis ? &childElement->dimensions.width : &childElement->dimensions.height;
+            float childMinSize = xAxis ? childElement->minDimensions.width : childElement->minDimensions.height;
+            float oldChildSize = *childSize;
+            *childSize = CLAY__MAX(childMinSize, targetSize);
+            totalSizeToDistribute -= (oldChildSize - *childSize);
+            int32_t position = positions[childIndex];
+            if (*childSize == childMinSize) {
+                int32_t lastPosition = resizableContainerBuffer.length - 1;
+                float movedSize = sizes[leafCount + lastPosition];
+                Clay__RemoveResizableChild(context, &resizableContainerBuffer, position);
+                Clay__SetCompressedChildSize(sizes, leafCount, lastPosition, -CLAY__MAXFLOAT);
+                if (position != lastPosition) {
+                    Clay__SetCompressedChildSize(sizes, leafCount, position, movedSize);
+                }
+            } else {
+                Clay__SetCompressedChildSize(sizes, leafCount, position, *childSize);
+            }
+        }
+
+        // The children before the last link of the chain are as they were, so the next scan goes on from the link before it
+        if (chainLength > 0) {
+            scanFrom = chain[--chainLength];
+        }
+    }
+}
+
+// A GROW step that may still be the last to have reached some of the buffer, see Clay__GrowChildrenAlongAxis()
+typedef struct {
+    int32_t step;
+    int32_t position;
+    float targetSize;
+} Clay__GrowStep;
+
+void Clay__SetResizeBit(uint32_t *words, uint32_t *summary, int32_t position, bool value) {
+    int32_t word = position / 32;
+    if (value) {
+        words[word] |= 1u << (position % 32);
+        summary[word / 32] |= 1u << (word % 32);
+    } else {
+        words[word] &= ~(1u << (position % 32));
+        if (words[word] == 0) {
+            summary[word / 32] &= ~(1u << (word % 32));
+        }
+    }
+}
+
+// Gives the child at position the share of the latest step that scanned past it, if that came after the step it was
+// last given a size at.
+void Clay__ApplyGrowSteps(Clay_Context *context, bool xAxis, Clay__GrowStep *steps, int32_t stepCount, int32_t elementIndex, int32_t position) {
+    int32_t low = 0, high = stepCount;
+    while (low < high) {
+        int32_t middle = low + (high - low) / 2;
+        if (steps[middle].position > position) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low > 0 && steps[low - 1].step >= context->layoutElementResizeSteps.internalArray[elementIndex]) {
+        Clay_LayoutElement *childElement = &context->layoutElements.internalArray[elementIndex];
+        *(xAxis ? &childElement->dimensions.width : &childElement->dimensions.height) = steps[low - 1].targetSize;
+    }
+}
+
+// Shares sizeToDistribute and the size of the GROW children between them. Scanning resizableContainerBuffer in order, the
+// first child with a minimum size above the share is swapped out of the buffer, keeping its size and leaving the share to
+// the rest, and the scan starts over, so the children passed on the way keep the share they were given if they leave
+// later. Once none are left above it, all of them are given the share.
+// Children with a minimum above the share are found from the children sorted by minimum size, and the first of them from
+// a bitset of buffer positions. The share a leaving child was last given comes from a stack of the steps that scanned
+// furthest, as a later step that scans at least as far hides the ones before it.
+void Clay__GrowChildrenAlongAxis(Clay_Context *context, bool xAxis, float sizeToDistribute, float growContainerContentSize, int32_t growContainerCount, Clay__int32_tArray resizableContainerBuffer, Clay__int32_tArray scratch) {
+    Clay_SizingAxis *sizings = context->layoutElementSizing[xAxis ? 0 : 1].internalArray;
+    float targetSize = (sizeToDistribute + growContainerContentSize) / (float)growContainerCount;
+    int32_t *growChildren = scratch.internalArray;
+    int32_t growChildCount = 0;
+    bool minSizeAboveTarget = false;
+    for (int32_t childOffset = 0; childOffset < resizableContainerBuffer.length; childOffset++) {
+        int32_t childElementIndex = resizableContainerBuffer.internalArray[childOffset];
+        if (sizings[childElementIndex].type == CLAY__SIZING_TYPE_GROW) {
+            growChildren[growChildCount++] = childElementIndex;
+            minSizeAboveTarget |= targetSize < Clay__ResizeSortValue(context, childElementIndex, xAxis, CLAY__RESIZE_SORT_MIN_SIZE);
+            context->layoutElementResizePositions.internalArray[childElementIndex] = childOffset;
+            context->layoutElementResizeSteps.internalArray[childElementIndex] = 0;
+        }
+    }
+
+    if (minSizeAboveTarget) {
+        Clay__SortResizableChildren(context, growChildren, growChildCount, growChildren + growChildCount, xAxis, CLAY__RESIZE_SORT_MIN_SIZE);
+        int32_t wordCount = (resizableContainerBuffer.length + 31) / 32;
+        int32_t summaryCount = (wordCount + 31) / 32;
+        uint32_t *words = (uint32_t *)(growChildren + growChildCount);
+        uint32_t *summary = words + wordCount;
+        Clay__GrowStep *steps = (Clay__GrowStep *)(summary + summaryCount);
+        int32_t stepCount = 0;
+        for (int32_t i = 0; i < wordCount + summaryCount; ++i) {
+            words[i] = 0;
+        }
+        for (int32_t step = 0; ; ++step) {
+            while (growChildCount > 0 && targetSize < Clay__ResizeSortValue(context, growChildren[growChildCount - 1], xAxis, CLAY__RESIZE_SORT_MIN_SIZE)) {
+                growChildCount--;
+                Clay__SetResizeBit(words, summary, context->layoutElementResizePositions.internalArray[growChildren[growChildCount]], true);
+            }
+            int32_t position = -1;
+            for (int32_t i = 0; i < summaryCount; ++i) {
+                if (summary[i]) {
+                    int32_t word = i * 32 + Clay__LowestSetBit(summary[i]);
+                    position = word * 32 + Clay__LowestSetBit(words[word]);
+                    break;
+                }
+            }
+            if (position < 0) {
+                break;
+            }
+
+            while (stepCount > 0 && steps[stepCount - 1].position <= position) {
+                stepCount--;
+            }
+            steps[stepCount++] = CLAY__INIT(Clay__GrowStep) { .step = step, .position = position, .targetSize = targetSize };
+            int32_t childElementIndex = resizableContainerBuffer.internalArray[position];
+            Clay__ApplyGrowSteps(context, xAxis, steps, stepCount, childElementIndex, position);
+            growContainerContentSize -= Clay__ResizeSortValue(context, childElementIndex, xAxis, CLAY__RESIZE_SORT_MIN_SIZE);
+            growContainerCount--;
+            targetSize = (sizeToDistribute + growContainerContentSize) / (float)growContainerCount;
+
+            Clay__SetResizeBit(words, summary, position, false);
+            int32_t lastPosition = resizableContainerBuffer.length - 1;
+            int32_t movedElementIndex = resizableContainerBuffer.internalArray[lastPosition];
+            if (position != lastPosition && sizings[movedElementIndex].type == CLAY__SIZING_TYPE_GROW) {
+                Clay__ApplyGrowSteps(context, xAxis, steps, stepCount, movedElementIndex, lastPosition);
+                context->layoutElementResizeSteps.internalArray[movedElementIndex] = step + 1;
+                if (words[lastPosition / 32] & (1u << (lastPosition % 32))) {
+                    Clay__SetResizeBit(words, summary, lastPosition, false);
+                    Clay__SetResizeBit(words, summary, position, true);
+                }
+            }
+            Clay__RemoveResizableChild(context, &resizableContainerBuffer, position);
+        }
+    }
+
+    for (int32_t childOffset = 0; childOffset < resizableContainerBuffer.length; childOffset++) {
+        int32_t childElementIndex = resizableContainerBuffer.internalArray[childOffset];
+        if (sizings[childElementIndex].type == CLAY__SIZING_TYPE_GROW) {
+            Clay_LayoutElement *childElement = &context->layoutElements.internalArray[childElementIndex];
+            *(xAxis ? &childElement->dimensions.width : &childElement->dimensions.height) = targetSize;
+        }
+    }
+}
+
+bool Clay__SizingAxisEquals(Clay_SizingAxis a, Clay_SizingAxis b) {
+    if (a.type != b.type) {
+        return false;
+    }
+    if (a.type == CLAY__SIZING_TYPE_PERCENT) {
+        return a.size.percent == b.size.percent;
+    }
+    return a.size.minMax.min == b.size.minMax.min && a.size.minMax.max == b.size.minMax.max;
+}
+
+float Clay__AxisPadding(Clay_LayoutConfig *layoutConfig, bool xAxis) {
+    return (float)(xAxis ? (layoutConfig->padding.left + layoutConfig->padding.right) : (layoutConfig->padding.top + layoutConfig->padding.bottom));
+}
+
+// Records what sizing parent's children along an axis reads, before it runs. Elements declared under an id that was already
+// taken have no hash map item of their own and are left out.
+void Clay__RecordSizingInputs(Clay_Context *context, Clay_LayoutElement *parent, int32_t parentIndex, bool xAxis, Clay_ElementHashMapStats *hashMapStats) {
+    int32_t axis = xAxis ? 0 : 1;
+    Clay_LayoutElementHashMapItem *parentItem = Clay__LookUpHashMapItem(context, parent->id, hashMapStats);
+    if (parentItem->layoutElement == parent) {
+        parentItem->parentSizing[axis] = CLAY__INIT(Clay__ParentSizingRecord) {
+            .generation = context->generation,
+            .size = xAxis ? parent->dimensions.width : parent->dimensions.height,
+            .padding = Clay__AxisPadding(parent->layoutConfig, xAxis),
+            .childGap = parent->layoutConfig->childGap,
+            .childCount = parent->childrenOrTextContent.children.length,
+            .layoutDirection = parent->layoutConfig->layoutDirection,
+            .flags = context->layoutElementSizingFlags.internalArray[parentIndex],
+        };
+    }
+    for (int32_t childOffset = 0; childOffset < parent->childrenOrTextContent.children.length; childOffset++) {
+        int32_t childElementIndex = parent->childrenOrTextContent.children.elements[childOffset];
+        Clay_LayoutElement *childElement = &context->layoutElements.internalArray[childElementIndex];
+        Clay_LayoutElementHashMapItem *childItem = Clay__LookUpHashMapItem(context, childElement->id, hashMapStats);
+        if (childItem->layoutElement == childElement) {
+            childItem->childSizing[axis] = CLAY__INIT(Clay__ChildSizingRecord) {
+                .parentId = parent->id,
+                .parentGeneration = context->generation,
+                .childOffset = childOffset,
+                .sizing = context->layoutElementSizing[axis].internalArray[childElementIndex],
+                .size = xAxis ? childElement->dimensions.width : childElement->dimensions.height,
+                .minSize = xAxis ? childElement->minDimensions.width : childElement->minDimensions.height,
+                .flags = context->layoutElementSizingFlags.internalArray[childElementIndex],
+            };
+        }
+    }
+}
+
+// Records the sizes that sizing parent's children along an axis gave them, after it has run.
+void Clay__RecordSizingResults(Clay_Context *context, Clay_LayoutElement *parent, bool xAxis, Clay_ElementHashMapStats *hashMapStats) {
+    for (int32_t childOffset = 0; childOffset < parent->childrenOrTextContent.children.length; childOffset++) {
+        Clay_LayoutElement *childElement = &context->layoutElements.internalArray[parent->childrenOrTextContent.children.elements[childOffset]];
+        Clay_LayoutElementHashMapItem *childItem = Clay__LookUpHashMapItem(context, childElement->id, hashMapStats);
+        if (childItem->layoutElement == childElement) {
+            childItem->childSizing[xAxis ? 0 : 1].sizedSize = xAxis ? childElement->dimensions.width : childElement->dimensions.height;
+        }
+    }
+}
 
-        for (int32_t childOffset = 0; childOffset < largestContainers.length; childOffset++) {
-            int32_t childIndex = Clay__int32_tArray_GetValue(&largestContainers, childOffset);
-            Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, childIndex);
-            float *childSize = xAxis ? &childElement->dimensions.width : &childElement->dimensions.height;
-            float childMinSize = xAxis ? childElement->minDimensions.width : childElement->minDimensions.height;
-            float oldChildSize = *childSize;
-            *childSize = CLAY__MAX(childMinSize, targetSize);
-            totalSizeToDistribute -= (oldChildSize - *childSize);
-            if (*childSize == childMinSize) {
-                for (int32_t i = 0; i < resizableContainerBuffer.length; i++) {
-                    if (Clay__int32_tArray_GetValue(&resizableContainerBuffer, i) == childIndex) {
-                        Clay__int32_tArray_RemoveSwapback(&resizableContainerBuffer, i);
-                        break;
-                    }
-                }
-            }
+// If parent's subtree fingerprint is the same as when it was last laid out, its children are likely to be sized as they
+// were then. As different subtrees can share a 32 bit fingerprint, last sizes are only copied once everything sizing would
+// read matches what the last run that sized these children read: the parent's size and layout, and each child's position,
+// sizing, size and minimum size. That run wrote the parent's record and those of every child, as each carries its generation.
+bool Clay__ReuseChildSizes(Clay_Context *context, Clay_LayoutElement *parent, int32_t parentIndex, bool xAxis, Clay_ElementHashMapStats *hashMapStats) {
+    if (parent->fingerprint == 0) {
+        return false;
+    }
+    int32_t axis = xAxis ? 0 : 1;
+    Clay_LayoutElementHashMapItem *parentItem = Clay__LookUpHashMapItem(context, parent->id, hashMapStats);
+    Clay__ParentSizingRecord *parentRecord = &parentItem->parentSizing[axis];
+    if (parentItem->layoutElement != parent || parentItem->layoutFingerprint != parent->fingerprint
+        || parentRecord->size != (xAxis ? parent->dimensions.width : parent->dimensions.height)
+        || parentRecord->padding != Clay__AxisPadding(parent->layoutConfig, xAxis)
+        || parentRecord->childGap != parent->layoutConfig->childGap
+        || parentRecord->childCount != parent->childrenOrTextContent.children.length
+        || parentRecord->layoutDirection != parent->layoutConfig->layoutDirection
+        || parentRecord->flags != context->layoutElementSizingFlags.internalArray[parentIndex]) {
+        return false;
+    }
+    for (int32_t childOffset = 0; childOffset < parent->childrenOrTextContent.children.length; childOffset++) {
+        int32_t childElementIndex = parent->childrenOrTextContent.children.elements[childOffset];
+        Clay_LayoutElement *childElement = &context->layoutElements.internalArray[childElementIndex];
+        Clay_LayoutElementHashMapItem *childItem = Clay__LookUpHashMapItem(context, childElement->id, hashMapStats);
+        Clay__ChildSizingRecord *childRecord = &childItem->childSizing[axis];
+        if (childItem->layoutElement != childElement || childRecord->parentId != parent->id || childRecord->parentGeneration != parentRecord->generation
+            || childRecord->childOffset != childOffset
+            || !Clay__SizingAxisEquals(childRecord->sizing, context->layoutElementSizing[axis].internalArray[childElementIndex])
+            || childRecord->size != (xAxis ? childElement->dimensions.width : childElement->dimensions.height)
+            || childRecord->minSize != (xAxis ? childElement->minDimensions.width : childElement->minDimensions.height)
+            || childRecord->flags != context->layoutElementSizingFlags.internalArray[childElementIndex]) {
+            return false;
         }
     }
+    for (int32_t childOffset = 0; childOffset < parent->childrenOrTextContent.children.length; childOffset++) {
+        Clay_LayoutElement *childElement = &context->layoutElements.internalArray[parent->childrenOrTextContent.children.elements[childOffset]];
+        Clay_LayoutElementHashMapItem *childItem = Clay__LookUpHashMapItem(context, childElement->id, hashMapStats);
+        *(xAxis ? &childElement->dimensions.width : &childElement->dimensions.height) = childItem->childSizing[axis].sizedSize;
+    }
+    return true;
 }
 
-void Clay__SizeContainersAlongAxis(bool xAxis) {
-    Clay_Context* context = Clay_GetCurrentContext();
-    Clay__int32_tArray bfsBuffer = context->layoutElementChildrenBuffer;
-    Clay__int32_tArray resizableContainerBuffer = context->openLayoutElementStack;
-    for (int32_t rootIndex = 0; rootIndex < context->layoutElementTreeRoots.length; ++rootIndex) {
-        bfsBuffer.length = 0;
-        Clay__LayoutElementTreeRoot *root = Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, rootIndex);
-        Clay_LayoutElement *rootElement = Clay_LayoutElementArray_Get(&context->layoutElements, (int)root->layoutElementIndex);
-        Clay__int32_tArray_Add(&bfsBuffer, (int32_t)root->layoutElementIndex);
-
-        // Size floating containers to their parents
-        if (Clay__ElementHasConfig(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING)) {
-            Clay_FloatingElementConfig *floatingElementConfig = Clay__FindElementConfigWithType(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig;
-            Clay_LayoutElementHashMapItem *parentItem = Clay__GetHashMapItem(floatingElementConfig->parentId);
-            if (parentItem && parentItem != &Clay_LayoutElementHashMapItem_DEFAULT) {
-                Clay_LayoutElement *parentLayoutElement = parentItem->layoutElement;
-                if (rootElement->layoutConfig->sizing.width.type == CLAY__SIZING_TYPE_GROW) {
-                    rootElement->dimensions.width = parentLayoutElement->dimensions.width;
-                }
-                if (rootElement->layoutConfig->sizing.height.type == CLAY__SIZING_TYPE_GROW) {
-                    rootElement->dimensions.height = parentLayoutElement->dimensions.height;
-                }
+// Sizes the elements of one tree root along an axis. Only that root's elements are written, and the only other element
+// read is the parent a floating root grows to, so roots can be sized on different threads, see Clay__SizeContainersAlongAxis().
+// Arrays are indexed directly from here down rather than through the checked accessors, as their error paths report through
+// the current context, which the thread running a task may not have. Indexes come from the tree, and each scratch buffer has
+// room for all of the root's elements.
+void Clay__SizeTreeRootAlongAxis(Clay_Context *context, bool xAxis, Clay__TreeRootSizingTask *task) {
+    Clay__int32_tArray bfsBuffer = { .capacity = task->scratchCapacity, .internalArray = context->layoutElementChildrenBuffer.internalArray + task->scratchOffset };
+    Clay__int32_tArray resizableContainerBuffer = { .capacity = task->scratchCapacity, .internalArray = context->openLayoutElementStack.internalArray + task->scratchOffset };
+    Clay__int32_tArray resizeScratch = { .capacity = task->scratchCapacity * CLAY__RESIZE_SCRATCH_PER_ELEMENT, .internalArray = context->resizeScratch.internalArray + task->scratchOffset * CLAY__RESIZE_SCRATCH_PER_ELEMENT };
+    Clay_SizingAxis *sizings = context->layoutElementSizing[xAxis ? 0 : 1].internalArray;
+    uint8_t *sizingFlags = context->layoutElementSizingFlags.internalArray;
+    uint8_t scrollFlag = xAxis ? CLAY__SIZING_FLAG_SCROLL_HORIZONTAL : CLAY__SIZING_FLAG_SCROLL_VERTICAL;
+    Clay__LayoutElementTreeRoot *root = &context->layoutElementTreeRoots.internalArray[task->rootIndex];
+    Clay_LayoutElement *rootElement = &context->layoutElements.internalArray[(int)root->layoutElementIndex];
+    bfsBuffer.internalArray[bfsBuffer.length++] = (int32_t)root->layoutElementIndex;
+
+    // Size floating containers to their parents
+    if (Clay__ElementHasConfig(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING)) {
+        Clay_FloatingElementConfig *floatingElementConfig = Clay__FindElementConfigWithType(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig;
+        Clay_LayoutElementHashMapItem *parentItem = Clay__LookUpHashMapItem(context, floatingElementConfig->parentId, &task->hashMapStats);
+        if (parentItem && parentItem != &Clay_LayoutElementHashMapItem_DEFAULT) {
+            Clay_LayoutElement *parentLayoutElement = parentItem->layoutElement;
+            if (rootElement->layoutConfig->sizing.width.type == CLAY__SIZING_TYPE_GROW) {
+                rootElement->dimensions.width = parentLayoutElement->dimensions.width;
+            }
+            if (rootElement->layoutConfig->sizing.height.type == CLAY__SIZING_TYPE_GROW) {
+                rootElement->dimensions.height = parentLayoutElement->dimensions.height;
             }
         }
+    }
 
-        rootElement->dimensions.width = CLAY__MIN(CLAY__MAX(rootElement->dimensions.width, rootElement->layoutConfig->sizing.width.size.minMax.min), rootElement->layoutConfig->sizing.width.size.minMax.max);
-        rootElement->dimensions.height = CLAY__MIN(CLAY__MAX(rootElement->dimensions.height, rootElement->layoutConfig->sizing.height.size.minMax.min), rootElement->layoutConfig->sizing.height.size.minMax.max);
-
-        for (int32_t i = 0; i < bfsBuffer.length; ++i) {
-            int32_t parentIndex = Clay__int32_tArray_GetValue(&bfsBuffer, i);
-            Clay_LayoutElement *parent = Clay_LayoutElementArray_Get(&context->layoutElements, parentIndex);
-            Clay_LayoutConfig *parentStyleConfig = parent->layoutConfig;
-            int32_t growContainerCount = 0;
-            float parentSize = xAxis ? parent->dimensions.width : parent->dimensions.height;
-            float parentPadding = (float)(xAxis ? (parent->layoutConfig->padding.left + parent->layoutConfig->padding.right) : (parent->layoutConfig->padding.top + parent->layoutConfig->padding.bottom));
-            float innerContentSize = 0, growContainerContentSize = 0, totalPaddingAndChildGaps = parentPadding;
-            bool sizingAlongAxis = (xAxis && parentStyleConfig->layoutDirection == CLAY_LEFT_TO_RIGHT) || (!xAxis && parentStyleConfig->layoutDirection == CLAY_TOP_TO_BOTTOM);
-            resizableContainerBuffer.length = 0;
-            float parentChildGap = parentStyleConfig->childGap;
+    rootElement->dimensions.width = CLAY__MIN(CLAY__MAX(rootElement->dimensions.width, rootElement->layoutConfig->sizing.width.size.minMax.min), rootElement->layoutConfig->sizing.width.size.minMax.max);
+    rootElement->dimensions.height = CLAY__MIN(CLAY__MAX(rootElement->dimensions.height, rootElement->layoutConfig->sizing.height.size.minMax.min), rootElement->layoutConfig->sizing.height.size.minMax.max);
 
+    for (int32_t i = 0; i < bfsBuffer.length; ++i) {
+        int32_t parentIndex = bfsBuffer.internalArray[i];
+        Clay_LayoutElement *parent = &context->layoutElements.internalArray[parentIndex];
+        if (context->incrementalLayoutEnabled && Clay__ReuseChildSizes(context, parent, parentIndex, xAxis, &task->hashMapStats)) {
+            task->elementsReused += parent->childrenOrTextContent.children.length;
             for (int32_t childOffset = 0; childOffset < parent->childrenOrTextContent.children.length; childOffset++) {
                 int32_t childElementIndex = parent->childrenOrTextContent.children.elements[childOffset];
-                Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, childElementIndex);
-                Clay_SizingAxis childSizing = xAxis ? childElement->layoutConfig->sizing.width : childElement->layoutConfig->sizing.height;
-                float childSize = xAxis ? childElement->dimensions.width : childElement->dimensions.height;
-
-                if (!Clay__ElementHasConfig(childElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT) && childElement->childrenOrTextContent.children.length > 0) {
-                    Clay__int32_tArray_Add(&bfsBuffer, childElementIndex);
+                Clay_LayoutElement *childElement = &context->layoutElements.internalArray[childElementIndex];
+                if (!(sizingFlags[childElementIndex] & CLAY__SIZING_FLAG_TEXT) && childElement->childrenOrTextContent.children.length > 0) {
+                    bfsBuffer.internalArray[bfsBuffer.length++] = childElementIndex;
                 }
+            }
+            continue;
+        }
+        task->elementsRecomputed += parent->childrenOrTextContent.children.length;
+        if (context->incrementalLayoutEnabled) {
+            Clay__RecordSizingInputs(context, parent, parentIndex, xAxis, &task->hashMapStats);
+        }
+        Clay_LayoutConfig *parentStyleConfig = parent->layoutConfig;
+        int32_t growContainerCount = 0;
+        float parentSize = xAxis ? parent->dimensions.width : parent->dimensions.height;
+        float parentPadding = Clay__AxisPadding(parent->layoutConfig, xAxis);
+        float innerContentSize = 0, growContainerContentSize = 0, totalPaddingAndChildGaps = parentPadding;
+        bool sizingAlongAxis = (xAxis && parentStyleConfig->layoutDirection == CLAY_LEFT_TO_RIGHT) || (!xAxis && parentStyleConfig->layoutDirection == CLAY_TOP_TO_BOTTOM);
+        resizableContainerBuffer.length = 0;
+        float parentChildGap = parentStyleConfig->childGap;
+
+        for (int32_t childOffset = 0; childOffset < parent->childrenOrTextContent.children.length; childOffset++) {
+            int32_t childElementIndex = parent->childrenOrTextContent.children.elements[childOffset];
+            Clay_LayoutElement *childElement = &context->layoutElements.internalArray[childElementIndex];
+            Clay_SizingAxis childSizing = sizings[childElementIndex];
+            uint8_t childFlags = sizingFlags[childElementIndex];
+            float childSize = xAxis ? childElement->dimensions.width : childElement->dimensions.height;
 
-                if (childSizing.type != CLAY__SIZING_TYPE_PERCENT
-                    && childSizing.type != CLAY__SIZING_TYPE_FIXED
-                    && (!Clay__ElementHasConfig(childElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT) || (Clay__FindElementConfigWithType(childElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT).textElementConfig->wrapMode == CLAY_TEXT_WRAP_WORDS)) // todo too many loops
-                    && (xAxis || !Clay__ElementHasConfig(childElement, CLAY__ELEMENT_CONFIG_TYPE_IMAGE))
-                ) {
-                    Clay__int32_tArray_Add(&resizableContainerBuffer, childElementIndex);
-                }
+            if (!(childFlags & CLAY__SIZING_FLAG_TEXT) && childElement->childrenOrTextContent.children.length > 0) {
+                bfsBuffer.internalArray[bfsBuffer.length++] = childElementIndex;
+            }
 
-                if (sizingAlongAxis) {
-                    innerContentSize += (childSizing.type == CLAY__SIZING_TYPE_PERCENT ? 0 : childSize);
-                    if (childSizing.type == CLAY__SIZING_TYPE_GROW) {
-                        growContainerContentSize += childSize;
-                        growContainerCount++;
-                    }
-                    if (childOffset > 0) {
-                        innerContentSize += parentChildGap; // For children after index 0, the childAxisOffset is the gap from the previous child
-                        totalPaddingAndChildGaps += parentChildGap;
-                    }
-                } else {
-                    innerContentSize = CLAY__MAX(childSize, innerContentSize);
+            if (childSizing.type != CLAY__SIZING_TYPE_PERCENT
+                && childSizing.type != CLAY__SIZING_TYPE_FIXED
+                && (!(childFlags & CLAY__SIZING_FLAG_TEXT) || (childFlags & CLAY__SIZING_FLAG_WRAP_WORDS))
+                && (xAxis || !(childFlags & CLAY__SIZING_FLAG_IMAGE))
+            ) {
+                resizableContainerBuffer.internalArray[resizableContainerBuffer.length++] = childElementIndex;
+            }
+
+            if (sizingAlongAxis) {
+                innerContentSize += (childSizing.type == CLAY__SIZING_TYPE_PERCENT ? 0 : childSize);
+                if (childSizing.type == CLAY__SIZING_TYPE_GROW) {
+                    growContainerContentSize += childSize;
+                    growContainerCount++;
                 }
+                if (childOffset > 0) {
+                    innerContentSize += parentChildGap; // For children after index 0, the childAxisOffset is the gap from the previous child
+                    totalPaddingAndChildGaps += parentChildGap;
+                }
+            } else {
+                innerContentSize = CLAY__MAX(childSize, innerContentSize);
             }
+        }
 
-            // Expand percentage containers to size
-            for (int32_t childOffset = 0; childOffset < parent->childrenOrTextContent.children.length; childOffset++) {
-                int32_t childElementIndex = parent->childrenOrTextContent.children.elements[childOffset];
-                Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, childElementIndex);
-                Clay_SizingAxis childSizing = xAxis ? childElement->layoutConfig->sizing.width : childElement->layoutConfig->sizing.height;
+        // Expand percentage containers to size
+        for (int32_t childOffset = 0; childOffset < parent->childrenOrTextContent.children.length; childOffset++) {
+            int32_t childElementIndex = parent->childrenOrTextContent.children.elements[childOffset];
+            Clay_SizingAxis childSizing = sizings[childElementIndex];
+            if (childSizing.type == CLAY__SIZING_TYPE_PERCENT) {
+                Clay_LayoutElement *childElement = &context->layoutElements.internalArray[childElementIndex];
                 float *childSize = xAxis ? &childElement->dimensions.width : &childElement->dimensions.height;
-                if (childSizing.type == CLAY__SIZING_TYPE_PERCENT) {
-                    *childSize = (parentSize - totalPaddingAndChildGaps) * childSizing.size.percent;
-                    if (sizingAlongAxis) {
-                        innerContentSize += *childSize;
-                    }
+                *childSize = (parentSize - totalPaddingAndChildGaps) * childSizing.size.percent;
+                if (sizingAlongAxis) {
+                    innerContentSize += *childSize;
                 }
             }
+        }
 
-            if (sizingAlongAxis) {
-                float sizeToDistribute = parentSize - parentPadding - innerContentSize;
-                // The content is too large, compress the children as much as possible
-                if (sizeToDistribute < 0) {
-                    // If the parent can scroll in the axis direction in this direction, don't compress children, just leave them alone
-                    Clay_ScrollElementConfig *scrollElementConfig = Clay__FindElementConfigWithType(parent, CLAY__ELEMENT_CONFIG_TYPE_SCROLL).scrollElementConfig;
-                    if (scrollElementConfig) {
-                        if (((xAxis && scrollElementConfig->horizontal) || (!xAxis && scrollElementConfig->vertical))) {
-                            continue;
-                        }
-                    }
+        if (sizingAlongAxis) {
+            float sizeToDistribute = parentSize - parentPadding - innerContentSize;
+            // The content is too large, compress the children as much as possible
+            if (sizeToDistribute < 0) {
+                // If the parent can scroll in the axis direction in this direction, don't compress children, just leave them alone
+                if (!(sizingFlags[parentIndex] & scrollFlag)) {
                     // Scrolling containers preferentially compress before others
-                    Clay__CompressChildrenAlongAxis(xAxis, -sizeToDistribute, resizableContainerBuffer);
-                // The content is too small, allow SIZING_GROW containers to expand
-                } else if (sizeToDistribute > 0 && growContainerCount > 0) {
-                    float targetSize = (sizeToDistribute + growContainerContentSize) / (float)growContainerCount;
-                    for (int32_t childOffset = 0; childOffset < resizableContainerBuffer.length; childOffset++) {
-                        Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childOffset));
-                        Clay_SizingAxis childSizing = xAxis ? childElement->layoutConfig->sizing.width : childElement->layoutConfig->sizing.height;
-                        if (childSizing.type == CLAY__SIZING_TYPE_GROW) {
-                            float *childSize = xAxis ? &childElement->dimensions.width : &childElement->dimensions.height;
-                            float *minSize = xAxis ? &childElement->minDimensions.width : &childElement->minDimensions.height;
-                            if (targetSize < *minSize) {
-                                growContainerContentSize -= *minSize;
-                                Clay__int32_tArray_RemoveSwapback(&resizableContainerBuffer, childOffset);
-                                growContainerCount--;
-                                targetSize = (sizeToDistribute + growContainerContentSize) / (float)growContainerCount;
-                                childOffset = -1;
-                                continue;
-                            }
-                            *childSize = targetSize;
-                        }
-                    }
+                    Clay__CompressChildrenAlongAxis(context, xAxis, -sizeToDistribute, resizableContainerBuffer, resizeScratch);
                 }
-            // Sizing along the non layout axis ("off axis")
-            } else {
-                for (int32_t childOffset = 0; childOffset < resizableContainerBuffer.length; childOffset++) {
-                    Clay_LayoutElement *childElement = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&resizableContainerBuffer, childOffset));
-                    Clay_SizingAxis childSizing = xAxis ? childElement->layoutConfig->sizing.width : childElement->layoutConfig->sizing.height;
-                    float *childSize = xAxis ? &childElement->dimensions.width : &childElement->dimensions.height;
+            // The content is too small, allow SIZING_GROW containers to expand
+            } else if (sizeToDistribute > 0 && growContainerCount > 0) {
+                Clay__GrowChildrenAlongAxis(context, xAxis, sizeToDistribute, growContainerContentSize, growContainerCount, resizableContainerBuffer, resizeScratch);
+            }
+        // Sizing along the non layout axis ("off axis")
+        } else {
+            for (int32_t childOffset = 0; childOffset < resizableContainerBuffer.length; childOffset++) {
+                int32_t childElementIndex = resizableContainerBuffer.internalArray[childOffset];
+                Clay_LayoutElement *childElement = &context->layoutElements.internalArray[childElementIndex];
+                Clay_SizingAxis childSizing = sizings[childElementIndex];
+                float *childSize = xAxis ? &childElement->dimensions.width : &childElement->dimensions.height;
 
-                    if (!xAxis && Clay__ElementHasConfig(childElement, CLAY__ELEMENT_CONFIG_TYPE_IMAGE)) {
-                        continue; // Currently we don't support resizing aspect ratio images on the Y axis because it would break the ratio
-                    }
+                if (!xAxis && (sizingFlags[childElementIndex] & CLAY__SIZING_FLAG_IMAGE)) {
+                    continue; // Currently we don't support resizing aspect ratio images on the Y axis because it would break the ratio
+                }
 
-                    // If we're laying out the children of a scroll panel, grow containers expand to the height of the inner content, not the outer container
-                    float maxSize = parentSize - parentPadding;
-                    if (Clay__ElementHasConfig(parent, CLAY__ELEMENT_CONFIG_TYPE_SCROLL)) {
-                        Clay_ScrollElementConfig *scrollElementConfig = Clay__FindElementConfigWithType(parent, CLAY__ELEMENT_CONFIG_TYPE_SCROLL).scrollElementConfig;
-                        if (((xAxis && scrollElementConfig->horizontal) || (!xAxis && scrollElementConfig->vertical))) {
-                            maxSize = CLAY__MAX(maxSize, innerContentSize);
-                        }
-                    }
-                    if (childSizing.type == CLAY__SIZING_TYPE_FIT) {
-                        *childSize = CLAY__MAX(childSizing.size.minMax.min, CLAY__MIN(*childSize, maxSize));
-                    } else if (childSizing.type == CLAY__SIZING_TYPE_GROW) {
-                        *childSize = CLAY__MIN(maxSize, childSizing.size.minMax.max);
-                    }
+                // If we're laying out the children of a scroll panel, grow containers expand to the height of the inner content, not the outer container
+                float maxSize = parentSize - parentPadding;
+                if (sizingFlags[parentIndex] & scrollFlag) {
+                    maxSize = CLAY__MAX(maxSize, innerContentSize);
+                }
+                if (childSizing.type == CLAY__SIZING_TYPE_FIT) {
+                    *childSize = CLAY__MAX(childSizing.size.minMax.min, CLAY__MIN(*childSize, maxSize));
+                } else if (childSizing.type == CLAY__SIZING_TYPE_GROW) {
+                    *childSize = CLAY__MIN(maxSize, childSizing.size.minMax.max);
                 }
             }
         }
+        if (context->incrementalLayoutEnabled) {
+            Clay__RecordSizingResults(context, parent, xAxis, &task->hashMapStats);
+        }
+    }
+}
+
+void Clay__SizeTreeRootTask(int32_t index, void *taskData) {
+    Clay__TreeRootSizingBatch *batch = (Clay__TreeRootSizingBatch *)taskData;
+    Clay__SizeTreeRootAlongAxis(batch->context, batch->xAxis, &batch->tasks[index]);
+}
+
+void Clay__RunTreeRootSizingBatch(Clay_Context *context, bool xAxis) {
+    Clay__TreeRootSizingTaskArray *tasks = &context->treeRootSizingTasks;
+    Clay__TreeRootSizingBatch batch = { .context = context, .tasks = tasks->internalArray, .xAxis = xAxis };
+    if (tasks->length > 1 && context->parallelForFunction) {
+        context->parallelForFunction(Clay__SizeTreeRootTask, tasks->length, &batch, context->parallelForUserData);
+    } else {
+        for (int32_t i = 0; i < tasks->length; ++i) {
+            Clay__SizeTreeRootTask(i, &batch);
+        }
+    }
+    Clay_ElementHashMapStats *hashMapStats = &context->layoutElementsHashMapStats;
+    for (int32_t i = 0; i < tasks->length; ++i) {
+        Clay__TreeRootSizingTask *task = &tasks->internalArray[i];
+        context->layoutStats.elementsRecomputed += task->elementsRecomputed;
+        context->layoutStats.elementsReused += task->elementsReused;
+        hashMapStats->lookups += task->hashMapStats.lookups;
+        hashMapStats->groupsProbed += task->hashMapStats.groupsProbed;
+        hashMapStats->longestProbe = CLAY__MAX(hashMapStats->longestProbe, task->hashMapStats.longestProbe);
+    }
+    tasks->length = 0;
+}
+
+// Returns the tree root holding the parent a floating root grows to, or -1 if its size doesn't depend on another root.
+int32_t Clay__TreeRootSizingDependency(Clay_Context *context, Clay__LayoutElementTreeRoot *root) {
+    Clay_LayoutElement *rootElement = Clay_LayoutElementArray_Get(&context->layoutElements, root->layoutElementIndex);
+    if (!Clay__ElementHasConfig(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING)
+        || (rootElement->layoutConfig->sizing.width.type != CLAY__SIZING_TYPE_GROW && rootElement->layoutConfig->sizing.height.type != CLAY__SIZING_TYPE_GROW)) {
+        return -1;
+    }
+    Clay_FloatingElementConfig *floatingElementConfig = Clay__FindElementConfigWithType(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig;
+    Clay_LayoutElementHashMapItem *parentItem = Clay__GetHashMapItem(floatingElementConfig->parentId);
+    if (parentItem == &Clay_LayoutElementHashMapItem_DEFAULT) {
+        return -1;
+    }
+    int32_t parentIndex = (int32_t)(parentItem->layoutElement - context->layoutElements.internalArray);
+    if (parentIndex < 0 || parentIndex >= context->layoutElements.length) {
+        return -1;
+    }
+    return Clay__int32_tArray_GetValue(&context->layoutElementTreeRootIndexes, parentIndex);
+}
+
+// Tree roots are sized in order. With a parallel for function bound, runs of roots that don't depend on each other are
+// sized as one batch, giving the same sizes as sizing them in order: a root joins the batch unless it grows to a parent in
+// a root of the batch, and the batch ends before any root that one of its roots grows to, as that must be read unsized.
+void Clay__SizeContainersAlongAxis(bool xAxis) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__TreeRootSizingTaskArray *tasks = &context->treeRootSizingTasks;
+    int32_t batchStart = 0;
+    int32_t batchEnd = context->layoutElementTreeRoots.length;
+    int32_t scratchUsed = 0;
+    tasks->length = 0;
+    for (int32_t rootIndex = 0; rootIndex < context->layoutElementTreeRoots.length; ++rootIndex) {
+        Clay__LayoutElementTreeRoot *root = Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, rootIndex);
+        if (!context->parallelForFunction) {
+            Clay__TreeRootSizingTaskArray_Add(tasks, CLAY__INIT(Clay__TreeRootSizingTask) { .rootIndex = rootIndex, .scratchCapacity = context->maxElementCount });
+            Clay__RunTreeRootSizingBatch(context, xAxis);
+            continue;
+        }
+        int32_t dependency = Clay__TreeRootSizingDependency(context, root);
+        if ((dependency >= batchStart && dependency < rootIndex) || rootIndex >= batchEnd || tasks->length == tasks->capacity) {
+            Clay__RunTreeRootSizingBatch(context, xAxis);
+            batchStart = rootIndex;
+            batchEnd = context->layoutElementTreeRoots.length;
+            scratchUsed = 0;
+        }
+        if (dependency > rootIndex) {
+            batchEnd = CLAY__MIN(batchEnd, dependency);
+        }
+        // A root's scratch buffers never hold more than its own elements, so the roots of a batch share them
+        Clay__TreeRootSizingTaskArray_Add(tasks, CLAY__INIT(Clay__TreeRootSizingTask) { .rootIndex = rootIndex, .scratchOffset = scratchUsed, .scratchCapacity = root->elementCount });
+        scratchUsed += root->elementCount;
     }
+    Clay__RunTreeRootSizingBatch(context, xAxis);
 }
 
 Clay_String Clay__IntToString(int32_t integer) {
@@ -2250,64 +3534,245 @@ bool Clay__ElementIsOffscreen(Clay_BoundingBox *boundingBox) {
            (boundingBox->y + boundingBox->height < 0);
 }
 
+void Clay__ResetWrapCache(Clay_Context *context) {
+    for (int32_t i = 0; i < 2; ++i) {
+        for (int32_t j = 0; j < context->wrapCacheItems[i].capacity; ++j) {
+            context->wrapCacheItems[i].internalArray[j] = CLAY__INIT(Clay__WrapCacheItem) CLAY__DEFAULT_STRUCT;
+        }
+        context->wrapCacheItems[i].length = context->wrapCacheItems[i].capacity; // This array is accessed directly rather than behaving as a list
+        context->wrapCacheLines[i].length = 0;
+    }
+    // Frame 0 is what an empty slot has, so live frames start after it
+    context->wrapCacheFrame = 1;
+}
+
+// Returns the slot for id and quantizedWidth in a wrap cache table, or the empty slot it would go in.
+Clay__WrapCacheItem *Clay__FindWrapCacheSlot(Clay__WrapCacheItemArray *items, uint32_t frame, uint32_t id, uint32_t quantizedWidth) {
+    uint32_t mask = (uint32_t)items->capacity - 1;
+    uint32_t index = (id ^ (quantizedWidth * 2654435761u)) & mask;
+    while (true) {
+        Clay__WrapCacheItem *item = &items->internalArray[index];
+        if (item->frame != frame || (item->id == id && item->quantizedWidth == quantizedWidth)) {
+            return item;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+// Emits the previous frame's lines for a text element if they still hold at the container's width, carrying them over into
+// this frame's buffer so they survive another frame.
+bool Clay__ReuseWrappedLines(Clay__TextElementData *textElementData, uint32_t id, float width, float lineHeight) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    uint32_t current = context->wrapCacheFrame & 1;
+    uint32_t quantizedWidth = (uint32_t)CLAY__MAX(width, 0);
+    Clay__WrapCacheItem *previous = Clay__FindWrapCacheSlot(&context->wrapCacheItems[current ^ 1], context->wrapCacheFrame - 1, id, quantizedWidth);
+    if (previous->frame != context->wrapCacheFrame - 1 || width < previous->minWidth || width >= previous->maxWidth) {
+        return false;
+    }
+    Clay__WrapCacheLineArray *previousLines = &context->wrapCacheLines[current ^ 1];
+    Clay__WrapCacheLineArray *currentLines = &context->wrapCacheLines[current];
+    if (context->wrappedTextLines.length + previous->lineCount > context->wrappedTextLines.capacity || currentLines->length + previous->lineCount > currentLines->capacity) {
+        return false;
+    }
+    Clay__WrapCacheItem *item = Clay__FindWrapCacheSlot(&context->wrapCacheItems[current], context->wrapCacheFrame, id, quantizedWidth);
+    if (item->frame != context->wrapCacheFrame) {
+        *item = *previous;
+        item->frame = context->wrapCacheFrame;
+        item->linesStartIndex = currentLines->length;
+        for (int32_t i = 0; i < previous->lineCount; ++i) {
+            Clay__WrapCacheLineArray_Add(currentLines, previousLines->internalArray[previous->linesStartIndex + i]);
+        }
+    }
+    for (int32_t i = 0; i < previous->lineCount; ++i) {
+        Clay__WrapCacheLine line = previousLines->internalArray[previous->linesStartIndex + i];
+        Clay__WrappedTextLineArray_Add(&context->wrappedTextLines, CLAY__INIT(Clay__WrappedTextLine) { { line.width, lineHeight }, { .length = line.length, .chars = &textElementData->text.chars[line.startOffset] } });
+    }
+    textElementData->wrappedLines.length = previous->lineCount;
+    return true;
+}
+
+void Clay__StoreWrappedLines(Clay__TextElementData *textElementData, uint32_t id, float width, float minWidth, float maxWidth) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    uint32_t current = context->wrapCacheFrame & 1;
+    Clay__WrapCacheLineArray *currentLines = &context->wrapCacheLines[current];
+    if (currentLines->length + textElementData->wrappedLines.length > currentLines->capacity) {
+        return;
+    }
+    uint32_t quantizedWidth = (uint32_t)CLAY__MAX(width, 0);
+    Clay__WrapCacheItem *item = Clay__FindWrapCacheSlot(&context->wrapCacheItems[current], context->wrapCacheFrame, id, quantizedWidth);
+    if (item->frame == context->wrapCacheFrame) {
+        return;
+    }
+    *item = CLAY__INIT(Clay__WrapCacheItem) { .id = id, .quantizedWidth = quantizedWidth, .frame = context->wrapCacheFrame, .minWidth = minWidth, .maxWidth = maxWidth, .linesStartIndex = currentLines->length, .lineCount = textElementData->wrappedLines.length };
+    for (int32_t i = 0; i < textElementData->wrappedLines.length; ++i) {
+        Clay__WrappedTextLine *line = &textElementData->wrappedLines.internalArray[i];
+        Clay__WrapCacheLineArray_Add(currentLines, CLAY__INIT(Clay__WrapCacheLine) { .width = line->dimensions.width, .startOffset = (int32_t)(line->line.chars - textElementData->text.chars), .length = line->line.length });
+    }
+}
+
+// Breaks a text element into lines at its container's current width, and sets the container's height from them.
+void Clay__WrapTextElement(Clay__TextElementData *textElementData) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    textElementData->wrappedLines = CLAY__INIT(Clay__WrappedTextLineArraySlice) { .length = 0, .internalArray = &context->wrappedTextLines.internalArray[context->wrappedTextLines.length] };
+    Clay_LayoutElement *containerElement = Clay_LayoutElementArray_Get(&context->layoutElements, (int)textElementData->elementIndex);
+    Clay_TextElementConfig *textConfig = Clay__FindElementConfigWithType(containerElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT).textElementConfig;
+    Clay__MeasureTextCacheItem *measureTextCacheItem = Clay__MeasureTextCached(&textElementData->text, textConfig);
+    float lineWidth = 0;
+    float lineHeight = textConfig->lineHeight > 0 ? (float)textConfig->lineHeight : textElementData->preferredDimensions.height;
+    int32_t lineLengthChars = 0;
+    int32_t lineStartOffset = 0;
+    if (!measureTextCacheItem->containsNewlines && textElementData->preferredDimensions.width <= containerElement->dimensions.width) {
+        Clay__WrappedTextLineArray_Add(&context->wrappedTextLines, CLAY__INIT(Clay__WrappedTextLine) { containerElement->dimensions,  textElementData->text });
+        textElementData->wrappedLines.length++;
+        return;
+    }
+    if (measureTextCacheItem->id != 0 && Clay__ReuseWrappedLines(textElementData, measureTextCacheItem->id, containerElement->dimensions.width, lineHeight)) {
+        context->layoutStats.textElementsWrapReused++;
+        containerElement->dimensions.height = lineHeight * (float)textElementData->wrappedLines.length;
+        return;
+    }
+    context->layoutStats.textElementsWrapped++;
+    // Every width comparison below narrows the range of container widths that would break the text the same way
+    float minWidth = 0;
+    float maxWidth = measureTextCacheItem->containsNewlines ? CLAY__MAXFLOAT : textElementData->preferredDimensions.width;
+    bool complete = true;
+    float spaceWidth = measureTextCacheItem->spaceWidth;
+    int32_t wordIndex = measureTextCacheItem->measuredWordsStartIndex;
+    while (wordIndex != -1) {
+        if (context->wrappedTextLines.length > context->wrappedTextLines.capacity - 1) {
+            complete = false;
+            break;
+        }
+        Clay__MeasuredWord *measuredWord = Clay__MeasuredWordArray_Get(&context->measuredWords, wordIndex);
+        context->layoutStats.wordsWrapped++;
+        if (lineLengthChars == 0 || measuredWord->length != 0) {
+            if (lineWidth + measuredWord->width > containerElement->dimensions.width) {
+                maxWidth = CLAY__MIN(maxWidth, lineWidth + measuredWord->width);
+            } else {
+                minWidth = CLAY__MAX(minWidth, lineWidth + measuredWord->width);
+            }
+        }
+        // Only word on the line is too large, just render it anyway
+        if (lineLengthChars == 0 && lineWidth + measuredWord->width > containerElement->dimensions.width) {
+            Clay__WrappedTextLineArray_Add(&context->wrappedTextLines, CLAY__INIT(Clay__WrappedTextLine) { { measuredWord->width, lineHeight }, { .length = measuredWord->length, .chars = &textElementData->text.chars[measuredWord->startOffset] } });
+            textElementData->wrappedLines.length++;
+            wordIndex = measuredWord->next;
+            lineStartOffset = measuredWord->startOffset + measuredWord->length;
+        }
+        // measuredWord->length == 0 means a newline character
+        else if (measuredWord->length == 0 || lineWidth + measuredWord->width > containerElement->dimensions.width) {
+            // Wrapped text lines list has overflowed, just render out the line
+            bool finalCharIsSpace = textElementData->text.chars[lineStartOffset + lineLengthChars - 1] == ' ';
+            Clay__WrappedTextLineArray_Add(&context->wrappedTextLines, CLAY__INIT(Clay__WrappedTextLine) { { lineWidth + (finalCharIsSpace ? -spaceWidth : 0), lineHeight }, { .length = lineLengthChars + (finalCharIsSpace ? -1 : 0), .chars = &textElementData->text.chars[lineStartOffset] } });
+            textElementData->wrappedLines.length++;
+            if (lineLengthChars == 0 || measuredWord->length == 0) {
+                wordIndex = measuredWord->next;
+            }
+            lineWidth = 0;
+            lineLengthChars = 0;
+            lineStartOffset = measuredWord->startOffset;
+        } else {
+            lineWidth += measuredWord->width;
+            lineLengthChars += measuredWord->length;
+            wordIndex = measuredWord->next;
+        }
+    }
+    if (lineLengthChars > 0) {
+        Clay__WrappedTextLineArray_Add(&context->wrappedTextLines, CLAY__INIT(Clay__WrappedTextLine) { { lineWidth, lineHeight }, {.length = lineLengthChars, .chars = &textElementData->text.chars[lineStartOffset] } });
+        textElementData->wrappedLines.length++;
+    }
+    if (complete && measureTextCacheItem->id != 0) {
+        Clay__StoreWrappedLines(textElementData, measureTextCacheItem->id, containerElement->dimensions.width, minWidth, maxWidth);
+    }
+    containerElement->dimensions.height = lineHeight * (float)textElementData->wrappedLines.length;
+}
+
+// With lazy text wrapping, a text element that was hidden last frame and whose text and width have not changed keeps its
+// previous height and is left unwrapped. It is only wrapped if it turns out to be visible when render commands are generated.
+bool Clay__DeferTextWrap(Clay__TextElementData *textElementData) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay_LayoutElement *containerElement = Clay_LayoutElementArray_Get(&context->layoutElements, (int)textElementData->elementIndex);
+    Clay_LayoutElementHashMapItem *hashMapItem = Clay__GetHashMapItem(containerElement->id);
+    if (textElementData->textId == 0 || hashMapItem->layoutElement != containerElement || hashMapItem->wrapVisible || hashMapItem->wrapTextId != textElementData->textId || hashMapItem->wrapWidth != containerElement->dimensions.width) {
+        return false;
+    }
+    textElementData->wrappedLines = CLAY__INIT(Clay__WrappedTextLineArraySlice) { .length = 0, .internalArray = &context->wrappedTextLines.internalArray[context->wrappedTextLines.length] };
+    textElementData->wrapDeferred = true;
+    containerElement->dimensions.height = hashMapItem->wrapHeight;
+    return true;
+}
+
+// True when the element lies entirely outside the scroll container clipping it.
+bool Clay__ElementIsClippedAway(Clay_LayoutElement *element, Clay_BoundingBox *boundingBox) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    uint32_t clipElementId = (uint32_t)Clay__int32_tArray_GetValue(&context->layoutElementClipElementIds, (int32_t)(element - context->layoutElements.internalArray));
+    if (clipElementId == 0) {
+        return false;
+    }
+    Clay_LayoutElementHashMapItem *clipItem = Clay__GetHashMapItem(clipElementId);
+    Clay_BoundingBox clip = clipItem->boundingBox;
+    return boundingBox->x > clip.x + clip.width || boundingBox->y > clip.y + clip.height || boundingBox->x + boundingBox->width < clip.x || boundingBox->y + boundingBox->height < clip.y;
+}
+
+// Stable LSD radix sort of the tree roots on zIndex, a byte at a time. Passes where every root has the same byte are skipped,
+// so the common case of no or few distinct z-indexes costs one counting pass.
+void Clay__SortTreeRootsByZIndex(Clay_Context *context) {
+    Clay__LayoutElementTreeRootArray *roots = &context->layoutElementTreeRoots;
+    Clay__LayoutElementTreeRootArray *buffer = &context->layoutElementTreeRootsSortBuffer;
+    for (int32_t shift = 0; shift < 16; shift += 8) {
+        int32_t counts[256] = CLAY__DEFAULT_STRUCT;
+        for (int32_t i = 0; i < roots->length; ++i) {
+            counts[(((uint16_t)roots->internalArray[i].zIndex ^ 0x8000) >> shift) & 0xFF]++; // Flip the sign bit so negative z-indexes sort first
+        }
+        if (roots->length == 0 || counts[(((uint16_t)roots->internalArray[0].zIndex ^ 0x8000) >> shift) & 0xFF] == roots->length) {
+            continue;
+        }
+        int32_t offset = 0;
+        for (int32_t bucket = 0; bucket < 256; ++bucket) {
+            int32_t count = counts[bucket];
+            counts[bucket] = offset;
+            offset += count;
+        }
+        for (int32_t i = 0; i < roots->length; ++i) {
+            Clay__LayoutElementTreeRoot root = roots->internalArray[i];
+            buffer->internalArray[counts[(((uint16_t)root.zIndex ^ 0x8000) >> shift) & 0xFF]++] = root;
+        }
+        Clay__LayoutElementTreeRoot *sorted = buffer->internalArray;
+        buffer->internalArray = roots->internalArray;
+        roots->internalArray = sorted;
+    }
+}
+
+int32_t Clay__ElementConfigRenderRank(Clay__ElementConfigType type) {
+    return type == CLAY__ELEMENT_CONFIG_TYPE_SCROLL ? 0 : type == CLAY__ELEMENT_CONFIG_TYPE_BORDER ? 2 : 1;
+}
+
 void Clay__CalculateFinalLayout(void) {
     Clay_Context* context = Clay_GetCurrentContext();
     // Calculate sizing along the X axis
     Clay__SizeContainersAlongAxis(true);
 
-    // Wrap text
+    // Wrap text, reusing last frame's line breaks where they still hold
+    context->wrapCacheFrame++;
+    context->wrapCacheLines[context->wrapCacheFrame & 1].length = 0;
     for (int32_t textElementIndex = 0; textElementIndex < context->textElementData.length; ++textElementIndex) {
         Clay__TextElementData *textElementData = Clay__TextElementDataArray_Get(&context->textElementData, textElementIndex);
-        textElementData->wrappedLines = CLAY__INIT(Clay__WrappedTextLineArraySlice) { .length = 0, .internalArray = &context->wrappedTextLines.internalArray[context->wrappedTextLines.length] };
-        Clay_LayoutElement *containerElement = Clay_LayoutElementArray_Get(&context->layoutElements, (int)textElementData->elementIndex);
-        Clay_TextElementConfig *textConfig = Clay__FindElementConfigWithType(containerElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT).textElementConfig;
-        Clay__MeasureTextCacheItem *measureTextCacheItem = Clay__MeasureTextCached(&textElementData->text, textConfig);
-        float lineWidth = 0;
-        float lineHeight = textConfig->lineHeight > 0 ? (float)textConfig->lineHeight : textElementData->preferredDimensions.height;
-        int32_t lineLengthChars = 0;
-        int32_t lineStartOffset = 0;
-        if (!measureTextCacheItem->containsNewlines && textElementData->preferredDimensions.width <= containerElement->dimensions.width) {
-            Clay__WrappedTextLineArray_Add(&context->wrappedTextLines, CLAY__INIT(Clay__WrappedTextLine) { containerElement->dimensions,  textElementData->text });
-            textElementData->wrappedLines.length++;
-            continue;
-        }
-        float spaceWidth = Clay__MeasureText(CLAY__INIT(Clay_StringSlice) { .length = 1, .chars = CLAY__SPACECHAR.chars, .baseChars = CLAY__SPACECHAR.chars }, textConfig, context->measureTextUserData).width;
-        int32_t wordIndex = measureTextCacheItem->measuredWordsStartIndex;
-        while (wordIndex != -1) {
-            if (context->wrappedTextLines.length > context->wrappedTextLines.capacity - 1) {
-                break;
+        if (context->lazyTextWrappingEnabled) {
+            if (Clay__DeferTextWrap(textElementData)) {
+                context->layoutStats.textElementsWrapDeferred++;
+                continue;
             }
-            Clay__MeasuredWord *measuredWord = Clay__MeasuredWordArray_Get(&context->measuredWords, wordIndex);
-            // Only word on the line is too large, just render it anyway
-            if (lineLengthChars == 0 && lineWidth + measuredWord->width > containerElement->dimensions.width) {
-                Clay__WrappedTextLineArray_Add(&context->wrappedTextLines, CLAY__INIT(Clay__WrappedTextLine) { { measuredWord->width, lineHeight }, { .length = measuredWord->length, .chars = &textElementData->text.chars[measuredWord->startOffset] } });
-                textElementData->wrappedLines.length++;
-                wordIndex = measuredWord->next;
-                lineStartOffset = measuredWord->startOffset + measuredWord->length;
-            }
-            // measuredWord->length == 0 means a newline character
-            else if (measuredWord->length == 0 || lineWidth + measuredWord->width > containerElement->dimensions.width) {
-                // Wrapped text lines list has overflowed, just render out the line
-                bool finalCharIsSpace = textElementData->text.chars[lineStartOffset + lineLengthChars - 1] == ' ';
-                Clay__WrappedTextLineArray_Add(&context->wrappedTextLines, CLAY__INIT(Clay__WrappedTextLine) { { lineWidth + (finalCharIsSpace ? -spaceWidth : 0), lineHeight }, { .length = lineLengthChars + (finalCharIsSpace ? -1 : 0), .chars = &textElementData->text.chars[lineStartOffset] } });
-                textElementData->wrappedLines.length++;
-                if (lineLengthChars == 0 || measuredWord->length == 0) {
-                    wordIndex = measuredWord->next;
-                }
-                lineWidth = 0;
-                lineLengthChars = 0;
-                lineStartOffset = measuredWord->startOffset;
-            } else {
-                lineWidth += measuredWord->width;
-                lineLengthChars += measuredWord->length;
-                wordIndex = measuredWord->next;
+            Clay__WrapTextElement(textElementData);
+            Clay_LayoutElement *containerElement = Clay_LayoutElementArray_Get(&context->layoutElements, (int)textElementData->elementIndex);
+            Clay_LayoutElementHashMapItem *hashMapItem = Clay__GetHashMapItem(containerElement->id);
+            if (hashMapItem->layoutElement == containerElement) {
+                hashMapItem->wrapTextId = textElementData->textId;
+                hashMapItem->wrapWidth = containerElement->dimensions.width;
+                hashMapItem->wrapHeight = containerElement->dimensions.height;
             }
+        } else {
+            Clay__WrapTextElement(textElementData);
         }
-        if (lineLengthChars > 0) {
-            Clay__WrappedTextLineArray_Add(&context->wrappedTextLines, CLAY__INIT(Clay__WrappedTextLine) { { lineWidth, lineHeight }, {.length = lineLengthChars, .chars = &textElementData->text.chars[lineStartOffset] } });
-            textElementData->wrappedLines.length++;
-        }
-        containerElement->dimensions.height = lineHeight * (float)textElementData->wrappedLines.length;
     }
 
     // Scale vertical image heights according to aspect ratio
@@ -2368,31 +3833,28 @@ void Clay__CalculateFinalLayout(void) {
     // Calculate sizing along the Y axis
     Clay__SizeContainersAlongAxis(false);
 
-    // Sort tree roots by z-index
-    int32_t sortMax = context->layoutElementTreeRoots.length - 1;
-    while (sortMax > 0) { // todo dumb bubble sort
-        for (int32_t i = 0; i < sortMax; ++i) {
-            Clay__LayoutElementTreeRoot current = *Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, i);
-            Clay__LayoutElementTreeRoot next = *Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, i + 1);
-            if (next.zIndex < current.zIndex) {
-                Clay__LayoutElementTreeRootArray_Set(&context->layoutElementTreeRoots, i, next);
-                Clay__LayoutElementTreeRootArray_Set(&context->layoutElementTreeRoots, i + 1, current);
-            }
-        }
-        sortMax--;
-    }
+    Clay__SortTreeRootsByZIndex(context);
 
     // Calculate final positions and generate render commands
     context->renderCommands.length = 0;
+    context->pointerGridEntries.length = 0;
+    context->pointerGridRootStarts.length = 0;
+    context->pointerGrid.built = false;
+    // Each element's pointer test is checked against the one at its index in the last layout as it is overwritten
+    int32_t pointerTestCount = 0;
+    bool pointerTestsChanged = false;
     dfsBuffer.length = 0;
     for (int32_t rootIndex = 0; rootIndex < context->layoutElementTreeRoots.length; ++rootIndex) {
         dfsBuffer.length = 0;
         Clay__LayoutElementTreeRoot *root = Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, rootIndex);
+        Clay__int32_tArray_Add(&context->pointerGridRootStarts, context->pointerGridEntries.length);
         Clay_LayoutElement *rootElement = Clay_LayoutElementArray_Get(&context->layoutElements, (int)root->layoutElementIndex);
+        bool rootIsFloating = Clay__ElementHasConfig(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING);
+        int32_t rootCaptureMode = rootIsFloating ? Clay__FindElementConfigWithType(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig->pointerCaptureMode + 1 : 0;
         Clay_Vector2 rootPosition = CLAY__DEFAULT_STRUCT;
         Clay_LayoutElementHashMapItem *parentHashMapItem = Clay__GetHashMapItem(root->parentId);
         // Position root floating containers
-        if (Clay__ElementHasConfig(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING) && parentHashMapItem) {
+        if (rootIsFloating && parentHashMapItem) {
             Clay_FloatingElementConfig *config = Clay__FindElementConfigWithType(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig;
             Clay_Dimensions rootDimensions = rootElement->dimensions;
             Clay_BoundingBox parentBoundingBox = parentHashMapItem->boundingBox;
@@ -2523,9 +3985,30 @@ void Clay__CalculateFinalLayout(void) {
                     }
                 }
 
+                Clay__PointerGridEntry *pointerGridEntry = Clay__PointerGridEntryArray_Add(&context->pointerGridEntries, CLAY__INIT(Clay__PointerGridEntry) {
+                    .boundingBox = { currentElementBoundingBox.x - root->pointerOffset.x, currentElementBoundingBox.y - root->pointerOffset.y, currentElementBoundingBox.width, currentElementBoundingBox.height },
+                    .layoutElementIndex = (int32_t)(currentElement - context->layoutElements.internalArray),
+                    .rootIndex = rootIndex,
+                });
                 Clay_LayoutElementHashMapItem *hashMapItem = Clay__GetHashMapItem(currentElement->id);
+                if (pointerTestCount < context->pointerTests.capacity) {
+                    Clay__PointerTest pointerTest = { pointerGridEntry->boundingBox, currentElement->id, hashMapItem == &Clay_LayoutElementHashMapItem_DEFAULT ? 0 : hashMapItem->idAlias + 1, rootIndex, rootCaptureMode };
+                    Clay__PointerTest *lastPointerTest = &context->pointerTests.internalArray[pointerTestCount];
+                    if (pointerTestCount >= context->pointerTests.length || lastPointerTest->boundingBox.x != pointerTest.boundingBox.x || lastPointerTest->boundingBox.y != pointerTest.boundingBox.y
+                        || lastPointerTest->boundingBox.width != pointerTest.boundingBox.width || lastPointerTest->boundingBox.height != pointerTest.boundingBox.height || lastPointerTest->id != pointerTest.id
+                        || lastPointerTest->idAlias != pointerTest.idAlias || lastPointerTest->rootIndex != pointerTest.rootIndex || lastPointerTest->rootCaptureMode != pointerTest.rootCaptureMode) {
+                        pointerTestsChanged = true;
+                    }
+                    *lastPointerTest = pointerTest;
+                    pointerTestCount++;
+                } else {
+                    pointerTestsChanged = true;
+                }
                 if (hashMapItem) {
                     hashMapItem->boundingBox = currentElementBoundingBox;
+                    if (hashMapItem->layoutElement == currentElement) {
+                        hashMapItem->layoutFingerprint = currentElement->fingerprint;
+                    }
                     if (hashMapItem->idAlias) {
                         Clay_LayoutElementHashMapItem *hashMapItemAlias = Clay__GetHashMapItem(hashMapItem->idAlias);
                         if (hashMapItemAlias) {
@@ -2534,23 +4017,17 @@ void Clay__CalculateFinalLayout(void) {
                     }
                 }
 
+                // Scroll goes first so that its scissor covers the element's other commands, and border last so it draws on top.
+                // An element has a handful of configs, so a stable insertion sort on that rank is enough
                 int32_t sortedConfigIndexes[20];
                 for (int32_t elementConfigIndex = 0; elementConfigIndex < currentElement->elementConfigs.length; ++elementConfigIndex) {
-                    sortedConfigIndexes[elementConfigIndex] = elementConfigIndex;
-                }
-                sortMax = currentElement->elementConfigs.length - 1;
-                while (sortMax > 0) { // todo dumb bubble sort
-                    for (int32_t i = 0; i < sortMax; ++i) {
-                        int32_t current = sortedConfigIndexes[i];
-                        int32_t next = sortedConfigIndexes[i + 1];
-                        Clay__ElementConfigType currentType = Clay__ElementConfigArraySlice_Get(&currentElement->elementConfigs, current)->type;
-                        Clay__ElementConfigType nextType = Clay__ElementConfigArraySlice_Get(&currentElement->elementConfigs, next)->type;
-                        if (nextType == CLAY__ELEMENT_CONFIG_TYPE_SCROLL || currentType == CLAY__ELEMENT_CONFIG_TYPE_BORDER) {
-                            sortedConfigIndexes[i] = next;
-                            sortedConfigIndexes[i + 1] = current;
-                        }
+                    int32_t rank = Clay__ElementConfigRenderRank(Clay__ElementConfigArraySlice_Get(&currentElement->elementConfigs, elementConfigIndex)->type);
+                    int32_t insertIndex = elementConfigIndex;
+                    while (insertIndex > 0 && Clay__ElementConfigRenderRank(Clay__ElementConfigArraySlice_Get(&currentElement->elementConfigs, sortedConfigIndexes[insertIndex - 1])->type) > rank) {
+                        sortedConfigIndexes[insertIndex] = sortedConfigIndexes[insertIndex - 1];
+                        insertIndex--;
                     }
-                    sortMax--;
+                    sortedConfigIndexes[insertIndex] = elementConfigIndex;
                 }
 
                 bool emitRectangle = false;
@@ -2605,6 +4082,22 @@ void Clay__CalculateFinalLayout(void) {
                             break;
                         }
                         case CLAY__ELEMENT_CONFIG_TYPE_TEXT: {
+                            if (context->lazyTextWrappingEnabled) {
+                                bool visible = !offscreen && !Clay__ElementIsClippedAway(currentElement, &currentElementBoundingBox);
+                                if (hashMapItem && hashMapItem->layoutElement == currentElement) {
+                                    hashMapItem->wrapVisible = visible;
+                                }
+                                if (!visible) {
+                                    shouldRender = false;
+                                    break;
+                                }
+                                Clay__TextElementData *textElementData = currentElement->childrenOrTextContent.textElementData;
+                                if (textElementData->wrapDeferred) {
+                                    // Same text and width as when it was last wrapped, so the height it was given still matches
+                                    textElementData->wrapDeferred = false;
+                                    Clay__WrapTextElement(textElementData);
+                                }
+                            }
                             if (!shouldRender) {
                                 break;
                             }
@@ -2869,6 +4362,11 @@ void Clay__CalculateFinalLayout(void) {
             Clay__AddRenderCommand(CLAY__INIT(Clay_RenderCommand) { .id = Clay__HashNumber(rootElement->id, rootElement->childrenOrTextContent.children.length + 11).id, .commandType = CLAY_RENDER_COMMAND_TYPE_SCISSOR_END });
         }
     }
+
+    if (pointerTestsChanged || pointerTestCount != context->pointerTests.length) {
+        context->layoutGeneration++;
+    }
+    context->pointerTests.length = pointerTestCount;
 }
 
 #pragma region DebugTools
@@ -2881,7 +4379,7 @@ const int32_t CLAY__DEBUGVIEW_ROW_HEIGHT = 30;
 const int32_t CLAY__DEBUGVIEW_OUTER_PADDING = 10;
 const int32_t CLAY__DEBUGVIEW_INDENT_WIDTH = 16;
 Clay_TextElementConfig Clay__DebugView_TextNameConfig = {.textColor = {238, 226, 231, 255}, .fontSize = 16, .wrapMode = CLAY_TEXT_WRAP_NONE };
-Clay_LayoutConfig Clay__DebugView_ScrollViewItemLayoutConfig = CLAY__DEFAULT_STRUCT;
+CLAY__THREAD_LOCAL Clay_LayoutConfig Clay__DebugView_ScrollViewItemLayoutConfig = CLAY__DEFAULT_STRUCT;
 
 typedef struct {
     Clay_String label;
@@ -3591,11 +5089,21 @@ void Clay_SetMeasureTextFunction(Clay_Dimensions (*measureTextFunction)(Clay_Str
     Clay__MeasureText = measureTextFunction;
     context->measureTextUserData = userData;
 }
+void Clay_SetMeasureTextBatchFunction(void (*measureTextBatchFunction)(Clay_StringSlice *words, Clay_Dimensions *dimensions, int32_t wordCount, Clay_TextElementConfig *config, void *userData), void *userData) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay__MeasureTextBatch = measureTextBatchFunction;
+    context->measureTextBatchUserData = userData;
+}
 void Clay_SetQueryScrollOffsetFunction(Clay_Vector2 (*queryScrollOffsetFunction)(uint32_t elementId, void *userData), void *userData) {
     Clay_Context* context = Clay_GetCurrentContext();
     Clay__QueryScrollOffset = queryScrollOffsetFunction;
     context->queryScrollOffsetUserData = userData;
 }
+void Clay_SetParallelForFunction(void (*parallelForFunction)(void (*task)(int32_t index, void *taskData), int32_t count, void *taskData, void *userData), void *userData) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    context->parallelForFunction = parallelForFunction;
+    context->parallelForUserData = userData;
+}
 #endif
 
 CLAY_WASM_EXPORT("Clay_SetLayoutDimensions")
@@ -3603,6 +5111,75 @@ void Clay_SetLayoutDimensions(Clay_Dimensions dimensions) {
     Clay_GetCurrentContext()->layoutDimensions = dimensions;
 }
 
+// Returns the grid cell along one axis that position falls in, clamped to the grid so that anything outside it lands in an edge cell
+int32_t Clay__PointerGridCell(float position, float inverseCellSize, int32_t cellCount) {
+    float cell = position * inverseCellSize;
+    if (!(cell >= 0)) { // Also catches NaN
+        return 0;
+    }
+    if (cell >= (float)(cellCount - 1)) {
+        return cellCount - 1;
+    }
+    return (int32_t)cell;
+}
+
+// Callers make sure pointerGridCellEntries has room
+void Clay__AppendPointerGridCellEntry(Clay_Context *context, int32_t cell, int32_t entryIndex) {
+    int32_t *tail = &context->pointerGridCellTails.internalArray[cell];
+    int32_t cellEntryIndex = context->pointerGridCellEntries.length++;
+    context->pointerGridCellEntries.internalArray[cellEntryIndex] = CLAY__INIT(Clay__PointerGridCellEntry) { .entryIndex = entryIndex, .next = -1 };
+    if (*tail == -1) {
+        context->pointerGridCellHeads.internalArray[cell] = cellEntryIndex;
+    } else {
+        context->pointerGridCellEntries.internalArray[*tail].next = cellEntryIndex;
+    }
+    *tail = cellEntryIndex;
+}
+
+// Buckets the entries recorded by Clay__CalculateFinalLayout() into a uniform grid over the layout dimensions, so that a query only
+// tests the elements listed in the pointer's cell, plus those too large to list per cell. Each list is kept in the order elements
+// are tested in: roots from the top down, each in depth first order. Built by the first Clay_SetPointerState() after a layout.
+void Clay__BuildPointerGrid(Clay_Context *context) {
+    Clay__PointerGrid *grid = &context->pointerGrid;
+    float cellWidth = CLAY__MAX(context->layoutDimensions.width / CLAY__POINTER_GRID_MAX_COLUMNS, CLAY__POINTER_GRID_CELL_SIZE);
+    float cellHeight = CLAY__MAX(context->layoutDimensions.height / CLAY__POINTER_GRID_MAX_COLUMNS, CLAY__POINTER_GRID_CELL_SIZE);
+    grid->inverseCellWidth = 1 / cellWidth;
+    grid->inverseCellHeight = 1 / cellHeight;
+    grid->columns = CLAY__MIN((int32_t)(CLAY__MAX(context->layoutDimensions.width, 0) / cellWidth) + 1, CLAY__POINTER_GRID_MAX_COLUMNS);
+    grid->rows = CLAY__MIN((int32_t)(CLAY__MAX(context->layoutDimensions.height, 0) / cellHeight) + 1, CLAY__POINTER_GRID_MAX_COLUMNS);
+
+    int32_t largeCell = grid->columns * grid->rows;
+    context->pointerGridCellHeads.length = largeCell + 1;
+    context->pointerGridCellTails.length = largeCell + 1;
+    for (int32_t i = 0; i <= largeCell; ++i) {
+        context->pointerGridCellHeads.internalArray[i] = -1;
+        context->pointerGridCellTails.internalArray[i] = -1;
+    }
+    context->pointerGridCellEntries.length = 0;
+    int32_t cellEntryLimit = context->maxElementCount * CLAY__POINTER_GRID_CELL_ENTRIES_PER_ELEMENT;
+    for (int32_t rootIndex = context->pointerGridRootStarts.length - 1; rootIndex >= 0; --rootIndex) {
+        int32_t rootEnd = rootIndex == context->pointerGridRootStarts.length - 1 ? context->pointerGridEntries.length : context->pointerGridRootStarts.internalArray[rootIndex + 1];
+        for (int32_t entryIndex = context->pointerGridRootStarts.internalArray[rootIndex]; entryIndex < rootEnd; ++entryIndex) {
+            Clay_BoundingBox box = context->pointerGridEntries.internalArray[entryIndex].boundingBox;
+            int32_t left = Clay__PointerGridCell(box.x, grid->inverseCellWidth, grid->columns);
+            int32_t right = Clay__PointerGridCell(box.x + box.width, grid->inverseCellWidth, grid->columns);
+            int32_t top = Clay__PointerGridCell(box.y, grid->inverseCellHeight, grid->rows);
+            int32_t bottom = Clay__PointerGridCell(box.y + box.height, grid->inverseCellHeight, grid->rows);
+            int32_t coveredCells = CLAY__MAX(right - left + 1, 0) * CLAY__MAX(bottom - top + 1, 0);
+            if (coveredCells > CLAY__POINTER_GRID_MAX_ELEMENT_CELLS || context->pointerGridCellEntries.length + coveredCells > cellEntryLimit) {
+                Clay__AppendPointerGridCellEntry(context, largeCell, entryIndex);
+                continue;
+            }
+            for (int32_t row = top; row <= bottom; ++row) {
+                for (int32_t column = left; column <= right; ++column) {
+                    Clay__AppendPointerGridCellEntry(context, row * grid->columns + column, entryIndex);
+                }
+            }
+        }
+    }
+    grid->built = true;
+}
+
 CLAY_WASM_EXPORT("Clay_SetPointerState")
 void Clay_SetPointerState(Clay_Vector2 position, bool isPointerDown) {
     Clay_Context* context = Clay_GetCurrentContext();
@@ -3610,55 +5187,79 @@ void Clay_SetPointerState(Clay_Vector2 position, bool isPointerDown) {
         return;
     }
     context->pointerInfo.position = position;
-    context->pointerOverIds.length = 0;
-    Clay__int32_tArray dfsBuffer = context->layoutElementChildrenBuffer;
-    for (int32_t rootIndex = context->layoutElementTreeRoots.length - 1; rootIndex >= 0; --rootIndex) {
-        dfsBuffer.length = 0;
-        Clay__LayoutElementTreeRoot *root = Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, rootIndex);
-        Clay__int32_tArray_Add(&dfsBuffer, (int32_t)root->layoutElementIndex);
-        context->treeNodeVisited.internalArray[0] = false;
+    if (context->pointerOverValid && context->pointerOverLayoutGeneration == context->layoutGeneration && position.x == context->pointerOverPosition.x && position.y == context->pointerOverPosition.y) {
+        // Nothing the result depends on has changed, so pointerOverIds stands and only the hover callbacks run again
+        for (int32_t i = 0; i < context->pointerOverItems.length; ++i) {
+            Clay_LayoutElementHashMapItem *mapItem = Clay__LayoutElementHashMapItemArray_Get(&context->layoutElementsHashMapInternal, context->pointerOverItems.internalArray[i]);
+            if (mapItem->onHoverFunction) {
+                mapItem->onHoverFunction(mapItem->elementId, context->pointerInfo, mapItem->hoverFunctionUserData);
+            }
+        }
+    } else {
+        context->pointerOverIds.length = 0;
+        context->pointerOverItems.length = 0;
+        Clay__PointerGrid *grid = &context->pointerGrid;
+        if (!grid->built) {
+            Clay__BuildPointerGrid(context);
+        }
+        // Walk the pointer's cell and the large elements together, merging them back into test order
+        Clay__PointerGridCellEntry *cellEntries = context->pointerGridCellEntries.internalArray;
+        Clay__PointerGridEntry *entries = context->pointerGridEntries.internalArray;
+        int32_t cell = Clay__PointerGridCell(position.y, grid->inverseCellHeight, grid->rows) * grid->columns + Clay__PointerGridCell(position.x, grid->inverseCellWidth, grid->columns);
+        int32_t nextCellEntry = context->pointerGridCellHeads.internalArray[cell];
+        int32_t nextLargeEntry = context->pointerGridCellHeads.internalArray[grid->columns * grid->rows];
+        int32_t currentRootIndex = -1;
         bool found = false;
-        while (dfsBuffer.length > 0) {
-            if (context->treeNodeVisited.internalArray[dfsBuffer.length - 1]) {
-                dfsBuffer.length--;
-                continue;
+        while (nextCellEntry != -1 || nextLargeEntry != -1) {
+            Clay__PointerGridEntry *entry;
+            if (nextLargeEntry == -1) {
+                entry = &entries[cellEntries[nextCellEntry].entryIndex];
+                nextCellEntry = cellEntries[nextCellEntry].next;
+            } else if (nextCellEntry == -1) {
+                entry = &entries[cellEntries[nextLargeEntry].entryIndex];
+                nextLargeEntry = cellEntries[nextLargeEntry].next;
+            } else {
+                Clay__PointerGridEntry *cellEntry = &entries[cellEntries[nextCellEntry].entryIndex];
+                Clay__PointerGridEntry *largeEntry = &entries[cellEntries[nextLargeEntry].entryIndex];
+                if (cellEntry->rootIndex > largeEntry->rootIndex || (cellEntry->rootIndex == largeEntry->rootIndex && cellEntry < largeEntry)) {
+                    entry = cellEntry;
+                    nextCellEntry = cellEntries[nextCellEntry].next;
+                } else {
+                    entry = largeEntry;
+                    nextLargeEntry = cellEntries[nextLargeEntry].next;
+                }
             }
-            context->treeNodeVisited.internalArray[dfsBuffer.length - 1] = true;
-            Clay_LayoutElement *currentElement = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__int32_tArray_GetValue(&dfsBuffer, (int)dfsBuffer.length - 1));
-            Clay_LayoutElementHashMapItem *mapItem = Clay__GetHashMapItem(currentElement->id); // TODO think of a way around this, maybe the fact that it's essentially a binary tree limits the cost, but the worst case is not great
-            Clay_BoundingBox elementBox = mapItem->boundingBox;
-            elementBox.x -= root->pointerOffset.x;
-            elementBox.y -= root->pointerOffset.y;
-            if (mapItem) {
-                if ((Clay__PointIsInsideRect(position, elementBox))) {
-                    if (mapItem->onHoverFunction) {
-                        mapItem->onHoverFunction(mapItem->elementId, context->pointerInfo, mapItem->hoverFunctionUserData);
-                    }
-                    Clay__ElementIdArray_Add(&context->pointerOverIds, mapItem->elementId);
-                    found = true;
-
-                    if (mapItem->idAlias != 0) {
-                        Clay__ElementIdArray_Add(&context->pointerOverIds, CLAY__INIT(Clay_ElementId) { .id = mapItem->idAlias });
+            if (entry->rootIndex != currentRootIndex) {
+                if (found) {
+                    Clay_LayoutElement *rootElement = Clay_LayoutElementArray_Get(&context->layoutElements, Clay__LayoutElementTreeRootArray_Get(&context->layoutElementTreeRoots, currentRootIndex)->layoutElementIndex);
+                    if (Clay__ElementHasConfig(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING) &&
+                            Clay__FindElementConfigWithType(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig->pointerCaptureMode == CLAY_POINTER_CAPTURE_MODE_CAPTURE) {
+                        break;
                     }
                 }
-                if (Clay__ElementHasConfig(currentElement, CLAY__ELEMENT_CONFIG_TYPE_TEXT)) {
-                    dfsBuffer.length--;
+                currentRootIndex = entry->rootIndex;
+                found = false;
+            }
+            if (Clay__PointIsInsideRect(position, entry->boundingBox)) {
+                Clay_LayoutElementHashMapItem *mapItem = Clay__GetHashMapItem(Clay_LayoutElementArray_Get(&context->layoutElements, entry->layoutElementIndex)->id);
+                if (mapItem == &Clay_LayoutElementHashMapItem_DEFAULT) { // The hash map was full when the element was declared
                     continue;
                 }
-                for (int32_t i = currentElement->childrenOrTextContent.children.length - 1; i >= 0; --i) {
-                    Clay__int32_tArray_Add(&dfsBuffer, currentElement->childrenOrTextContent.children.elements[i]);
-                    context->treeNodeVisited.internalArray[dfsBuffer.length - 1] = false; // TODO needs to be ranged checked
+                if (mapItem->onHoverFunction) {
+                    mapItem->onHoverFunction(mapItem->elementId, context->pointerInfo, mapItem->hoverFunctionUserData);
                 }
-            } else {
-                dfsBuffer.length--;
-            }
-        }
+                Clay__ElementIdArray_Add(&context->pointerOverIds, mapItem->elementId);
+                Clay__int32_tArray_Add(&context->pointerOverItems, (int32_t)(mapItem - context->layoutElementsHashMapInternal.internalArray));
+                found = true;
 
-        Clay_LayoutElement *rootElement = Clay_LayoutElementArray_Get(&context->layoutElements, root->layoutElementIndex);
-        if (found && Clay__ElementHasConfig(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING) &&
-                Clay__FindElementConfigWithType(rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING).floatingElementConfig->pointerCaptureMode == CLAY_POINTER_CAPTURE_MODE_CAPTURE) {
-            break;
+                if (mapItem->idAlias != 0) {
+                    Clay__ElementIdArray_Add(&context->pointerOverIds, CLAY__INIT(Clay_ElementId) { .id = mapItem->idAlias });
+                }
+            }
         }
+        context->pointerOverPosition = position;
+        context->pointerOverLayoutGeneration = context->layoutGeneration;
+        context->pointerOverValid = true;
     }
 
     if (isPointerDown) {
@@ -3692,13 +5293,17 @@ Clay_Context* Clay_Initialize(Clay_Arena arena, Clay_Dimensions layoutDimensions
     Clay_SetCurrentContext(context);
     Clay__InitializePersistentMemory(context);
     Clay__InitializeEphemeralMemory(context);
-    for (int32_t i = 0; i < context->layoutElementsHashMap.capacity; ++i) {
-        context->layoutElementsHashMap.internalArray[i] = -1;
+    for (int32_t i = 0; i < context->layoutElementsHashMapGroups.capacity; ++i) {
+        for (int32_t slot = 0; slot < 16; ++slot) {
+            context->layoutElementsHashMapGroups.internalArray[i].control[slot] = slot < CLAY__HASH_MAP_GROUP_WIDTH ? CLAY__HASH_MAP_EMPTY : CLAY__HASH_MAP_PADDING;
+        }
     }
     for (int32_t i = 0; i < context->measureTextHashMap.capacity; ++i) {
         context->measureTextHashMap.internalArray[i] = 0;
     }
     context->measureTextHashMapInternal.length = 1; // Reserve the 0 value to mean "no next element"
+    Clay__ResetWrapCache(context);
+    Clay__ResetMemos(context);
     context->layoutDimensions = layoutDimensions;
     return context;
 }
@@ -3833,6 +5438,12 @@ void Clay_BeginLayout(void) {
     Clay__InitializeEphemeralMemory(context);
     context->generation++;
     context->dynamicElementIndex = 0;
+    context->layoutStats = CLAY__INIT(Clay_LayoutStats) CLAY__DEFAULT_STRUCT;
+    context->memoFrame++;
+    context->memoOps[context->memoFrame & 1].length = 0;
+    context->memoItemCount = 0;
+    context->memoOpsExceeded = false;
+    context->untrackedMemoDepth = 0;
     // Set up the root container that covers the entire window
     Clay_Dimensions rootDimensions = {context->layoutDimensions.width, context->layoutDimensions.height};
     if (context->debugModeEnabled) {
@@ -3845,7 +5456,7 @@ void Clay_BeginLayout(void) {
             .layout = { .sizing = {CLAY_SIZING_FIXED((rootDimensions.width)), CLAY_SIZING_FIXED(rootDimensions.height)} }
     });
     Clay__int32_tArray_Add(&context->openLayoutElementStack, 0);
-    Clay__LayoutElementTreeRootArray_Add(&context->layoutElementTreeRoots, CLAY__INIT(Clay__LayoutElementTreeRoot) { .layoutElementIndex = 0 });
+    Clay__LayoutElementTreeRootArray_Add(&context->layoutElementTreeRoots, CLAY__INIT(Clay__LayoutElementTreeRoot) { .layoutElementIndex = 0, .elementCount = 1 });
 }
 
 CLAY_WASM_EXPORT("Clay_EndLayout")
@@ -3906,6 +5517,11 @@ bool Clay_Hovered(void) {
 
 void Clay_OnHover(void (*onHoverFunction)(Clay_ElementId elementId, Clay_PointerData pointerInfo, intptr_t userData), intptr_t userData) {
     Clay_Context* context = Clay_GetCurrentContext();
+    Clay__MemoOp *memoOp = Clay__AddMemoOp(CLAY__MEMO_OP_HOVER);
+    if (memoOp) {
+        memoOp->data.hover.function = onHoverFunction;
+        memoOp->data.hover.userData = userData;
+    }
     if (context->booleanWarnings.maxElementsExceeded) {
         return;
     }
@@ -3978,12 +5594,39 @@ void Clay_SetCullingEnabled(bool enabled) {
     context->disableCulling = !enabled;
 }
 
+CLAY_WASM_EXPORT("Clay_SetLazyTextWrappingEnabled")
+void Clay_SetLazyTextWrappingEnabled(bool enabled) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    context->lazyTextWrappingEnabled = enabled;
+}
+
+CLAY_WASM_EXPORT("Clay_SetIncrementalLayoutEnabled")
+void Clay_SetIncrementalLayoutEnabled(bool enabled) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    context->incrementalLayoutEnabled = enabled;
+}
+
 CLAY_WASM_EXPORT("Clay_SetExternalScrollHandlingEnabled")
 void Clay_SetExternalScrollHandlingEnabled(bool enabled) {
     Clay_Context* context = Clay_GetCurrentContext();
     context->externalScrollHandlingEnabled = enabled;
 }
 
+CLAY_WASM_EXPORT("Clay_GetLayoutStats")
+Clay_LayoutStats Clay_GetLayoutStats(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    return context->layoutStats;
+}
+
+CLAY_WASM_EXPORT("Clay_GetElementHashMapStats")
+Clay_ElementHashMapStats Clay_GetElementHashMapStats(void) {
+    Clay_Context* context = Clay_GetCurrentContext();
+    Clay_ElementHashMapStats stats = context->layoutElementsHashMapStats;
+    stats.capacity = context->layoutElementsHashMapGroups.capacity * CLAY__HASH_MAP_GROUP_WIDTH;
+    stats.count = context->layoutElementsHashMapInternal.length;
+    return stats;
+}
+
 CLAY_WASM_EXPORT("Clay_GetMaxElementCount")
 int32_t Clay_GetMaxElementCount(void) {
     Clay_Context* context = Clay_GetCurrentContext();
@@ -4030,6 +5673,12 @@ void Clay_ResetMeasureTextCache(void) {
         context->measureTextHashMap.internalArray[i] = 0;
     }
     context->measureTextHashMapInternal.length = 1; // Reserve the 0 value to mean "no next element"
+    // Line breaks, deferred heights and reusable sizes were made from the old measurements
+    Clay__ResetWrapCache(context);
+    for (int32_t i = 0; i < context->layoutElementsHashMapInternal.length; ++i) {
+        context->layoutElementsHashMapInternal.internalArray[i].wrapTextId = 0;
+        context->layoutElementsHashMapInternal.internalArray[i].layoutFingerprint = 0;
+    }
 }
 
 #endif // CLAY_IMPLEMENTATION
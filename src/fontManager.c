@@ -1,40 +1,1371 @@
+// mmap and clock_gettime for the glyph cache
+#define _POSIX_C_SOURCE 200809L
+
 #include "fontManager.h"
+#include "glyphAtlas.h"
+#include <fcntl.h>
+#include <pthread.h>
 #include <raylib.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if !defined(FONTMANAGER_DISABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64))
+#include <emmintrin.h>
+#elif !defined(FONTMANAGER_DISABLE_SIMD) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#define FONTMANAGER_INITIAL_CAPACITY 8
+#define FONTMANAGER_NO_FREE_SLOT UINT16_MAX
+
+// A FontHandle is the slot index in the low bits and the slot generation in
+// the high bits, so it fits Clay's 16 bit fontId. The default font sits in
+// slot 0 with generation 0, which makes it fontId 0.
+#define FONTMANAGER_INDEX_BITS 10
+#define FONTMANAGER_INDEX_MASK ((1 << FONTMANAGER_INDEX_BITS) - 1)
+#define FONTMANAGER_GENERATION_MASK ((1 << (16 - FONTMANAGER_INDEX_BITS)) - 1)
+
+#define FONTMANAGER_EMPTY_SLOT -1
+#define FONTMANAGER_SPARSE_INITIAL_CAPACITY 64
+
+// Size distance field fonts are rasterized at. One glyph bitmap serves every
+// size from there, smaller sizes look best as the field gets sharper.
+#define FONTMANAGER_SDF_BASE_SIZE 48
+
+// Size variants a family can have, and how many glyphs are rasterized ahead
+// in the background when a new variant is generated.
+#define FONTMANAGER_MAX_VARIANTS 16
+#define FONTMANAGER_MAX_WARMUP_CODEPOINTS 512
+
+// Glyphs rasterized together when text needs new ones.
+#define FONTMANAGER_MAX_BATCH_CODEPOINTS 64
+
+// Glyphs every font gets up front, and where their bitmaps are cached between
+// runs.
+#define FONTMANAGER_WARMUP_FIRST 32
+#define FONTMANAGER_WARMUP_LAST 126
+#define FONTMANAGER_CACHE_NAME "c-ui-library"
+#define FONTMANAGER_CACHE_DIR_SIZE 512
+#define FONTMANAGER_CACHE_MAGIC 0x43594c47
+#define FONTMANAGER_CACHE_VERSION 1
+
+// Transparent border kept around every glyph bitmap in the atlas, so filtering
+// never picks up a neighbour.
+#define FONTMANAGER_GLYPH_PADDING 1
+
+// A glyph is rasterized the first time it is measured or drawn. Its metrics
+// stay here for the life of the font, its bitmap only as long as the atlas
+// keeps its slot; a glyph with no visible pixels has no region at all.
+struct CachedGlyph {
+    bool loaded;
+    bool hasBitmap;
+    float advance;
+    float offsetX;
+    float offsetY;
+    struct AtlasRegion region;
+};
+
+struct GlyphSlot {
+    int codepoint;
+    struct CachedGlyph glyph;
+};
+
+struct FontData {
+    // The font file stays in memory so glyphs can be rasterized on demand.
+    unsigned char* fileData;
+    int fileSize;
+    char* filePath;
+    uint8_t fontSize;
+    // FONT_DEFAULT, or FONT_SDF for fonts drawn at any size from one set of
+    // distance field glyphs
+    int glyphType;
+
+    // Filled on demand so no glyph is ever searched for: codepoints below 256
+    // index latin1 directly, the rest go through an open addressing table of
+    // sparseMask + 1 slots, grown when half full.
+    struct CachedGlyph latin1[256];
+    struct GlyphSlot* sparse;
+    uint32_t sparseMask;
+    uint32_t sparseCount;
+
+    // A family owns the file data and holds one internal variant per size;
+    // variants point back at their family and are only used once ready.
+    // Anything that is not a variant has family set to
+    // FONTMANAGER_NO_FREE_SLOT.
+    bool isFamily;
+    uint16_t family;
+    bool ready;
+    uint16_t variants[FONTMANAGER_MAX_VARIANTS];
+    uint8_t variantCount;
+    // one bit per size a variant could not be added for, so a family out of
+    // variants or slots does not try again every time it is measured
+    uint32_t failedSizes[256 / 32];
+    uint16_t pendingJobs;
+    // unloaded while background jobs were using its file data, released when
+    // the last one is collected
+    bool releasePending;
+
+    // A slot is free when refCount is 0, and its generation is bumped on
+    // release so handles to the old font stop matching.
+    uint16_t generation;
+    uint32_t refCount;
+    uint16_t nextFree;
+};
+
+// Grows by doubling. Released slots are chained through nextFree and reused
+// before the pool grows, so slot indices never move.
+struct FontPool {
+    struct FontData* fonts;
+    uint16_t capacity;
+    uint16_t used;
+    uint16_t freeHead;
+};
+
+struct FontPool fontPool;
+
+static FontHandle _Make_Handle(uint16_t index) {
+    return fontPool.fonts[index].generation << FONTMANAGER_INDEX_BITS | index;
+}
+
+static struct FontData* _Get_Font(FontHandle handle) {
+    uint16_t index = handle & FONTMANAGER_INDEX_MASK;
+    uint16_t generation = handle >> FONTMANAGER_INDEX_BITS;
+
+    if (index >= fontPool.used || fontPool.fonts[index].generation != generation || fontPool.fonts[index].refCount == 0) {
+        return NULL;
+    }
+
+    return &fontPool.fonts[index];
+}
+
+// Puts a slot back on the free list. Handles only have room for 64
+// generations, and wrapping around would let a handle kept from long ago
+// match again, so a slot whose generation ran out is retired instead. That
+// takes dozens of loads of the same slot, and the pool simply grows past it.
+static void _Free_Slot(uint16_t index) {
+    if (fontPool.fonts[index].generation == FONTMANAGER_GENERATION_MASK) {
+        return;
+    }
+
+    fontPool.fonts[index].nextFree = fontPool.freeHead;
+    fontPool.freeHead = index;
+}
+
+static uint16_t _Allocate_Slot(void) {
+    if (fontPool.freeHead != FONTMANAGER_NO_FREE_SLOT) {
+        uint16_t index = fontPool.freeHead;
+        fontPool.freeHead = fontPool.fonts[index].nextFree;
+        return index;
+    }
+
+    if (fontPool.used == fontPool.capacity) {
+        uint32_t capacity = fontPool.capacity == 0 ? FONTMANAGER_INITIAL_CAPACITY : fontPool.capacity * 2;
+
+        // the last index is left out, so the invalid handle never matches
+        if (capacity > FONTMANAGER_INDEX_MASK) {
+            capacity = FONTMANAGER_INDEX_MASK;
+        }
+
+        if (capacity == fontPool.used) {
+            return FONTMANAGER_NO_FREE_SLOT;
+        }
+
+        struct FontData* fonts = realloc(fontPool.fonts, capacity * sizeof(struct FontData));
+
+        if (fonts == NULL) {
+            return FONTMANAGER_NO_FREE_SLOT;
+        }
+
+        fontPool.fonts = fonts;
+        fontPool.capacity = capacity;
+    }
+
+    fontPool.fonts[fontPool.used].generation = 0;
+
+    return fontPool.used++;
+}
+
+//---------------------------------------------------------
+// GLYPH CACHE
+//---------------------------------------------------------
+
+// Uploads a GRAYSCALE glyph bitmap as white GRAY_ALPHA, surrounded by
+// FONTMANAGER_GLYPH_PADDING transparent pixels. Distance fields go in the
+// alpha channel the same way, 0 there is simply far outside the glyph.
+static bool _Is_Visible(Image bitmap) {
+    const unsigned char* pixels = bitmap.data;
+    int pixelCount = bitmap.width * bitmap.height;
+
+    for (int i = 0; i < pixelCount; i++) {
+        if (pixels[i] != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Turns a coverage bitmap into the padded white GRAY_ALPHA the atlas takes.
+static unsigned char* _Pad_Glyph(Image bitmap, int* width, int* height) {
+    *width = bitmap.width + 2 * FONTMANAGER_GLYPH_PADDING;
+    *height = bitmap.height + 2 * FONTMANAGER_GLYPH_PADDING;
+    unsigned char* grayAlpha = calloc(*width * *height, 2);
+
+    if (grayAlpha == NULL) {
+        return NULL;
+    }
+
+    const unsigned char* pixels = bitmap.data;
+
+    for (int y = 0; y < bitmap.height; y++) {
+        unsigned char* row = grayAlpha + ((y + FONTMANAGER_GLYPH_PADDING) * *width + FONTMANAGER_GLYPH_PADDING) * 2;
+
+        for (int x = 0; x < bitmap.width; x++) {
+            row[x * 2] = 255;
+            row[x * 2 + 1] = pixels[y * bitmap.width + x];
+        }
+    }
+
+    return grayAlpha;
+}
+
+static void _Upload_Glyph(Image bitmap, bool distanceField, struct CachedGlyph* glyph) {
+    glyph->hasBitmap = _Is_Visible(bitmap);
+
+    if (!glyph->hasBitmap) {
+        return;
+    }
+
+    int width, height;
+    unsigned char* grayAlpha = _Pad_Glyph(bitmap, &width, &height);
+
+    if (grayAlpha == NULL) {
+        return;
+    }
+
+    // on failure the region stays stale and the next draw tries again
+    GlyphAtlas_Insert(width, height, grayAlpha, distanceField, &glyph->region);
+
+    free(grayAlpha);
+}
+
+// Fills in a glyph from what LoadFontData gave for it, uploading the bitmap
+// to the atlas.
+static void _Store_Glyph(struct FontData* fontData, GlyphInfo* info, struct CachedGlyph* glyph) {
+    // same advance MeasureTextEx uses: advanceX, or the glyph width when the
+    // font does not provide one
+    glyph->loaded = true;
+    glyph->advance = info->advanceX != 0 ? info->advanceX : info->image.width + info->offsetX;
+    glyph->offsetX = info->offsetX - FONTMANAGER_GLYPH_PADDING;
+    glyph->offsetY = info->offsetY - FONTMANAGER_GLYPH_PADDING;
+
+    if (info->image.data != NULL) {
+        _Upload_Glyph(info->image, fontData->glyphType == FONT_SDF, glyph);
+    }
+}
+
+// Rasterizes one codepoint on the spot. Returns false if the font file cannot
+// be parsed.
+static bool _Rasterize_Glyph(struct FontData* fontData, int codepoint, struct CachedGlyph* glyph) {
+    GlyphInfo* info = LoadFontData(fontData->fileData, fontData->fileSize, fontData->fontSize, &codepoint, 1, fontData->glyphType);
+
+    if (info == NULL) {
+        return false;
+    }
+
+    _Store_Glyph(fontData, info, glyph);
+    UnloadFontData(info, 1);
+
+    return true;
+}
+
+// Fibonacci hashing, codepoints are mostly clustered in a few blocks.
+static uint32_t _Hash_Codepoint(int codepoint, uint32_t mask) {
+    return ((uint32_t)codepoint * 2654435769u) >> 7 & mask;
+}
+
+static struct GlyphSlot* _Find_Slot(struct GlyphSlot* slots, uint32_t mask, int codepoint) {
+    uint32_t slot = _Hash_Codepoint(codepoint, mask);
+
+    while (slots[slot].codepoint != FONTMANAGER_EMPTY_SLOT && slots[slot].codepoint != codepoint) {
+        slot = (slot + 1) & mask;
+    }
+
+    return &slots[slot];
+}
+
+static bool _Grow_Sparse(struct FontData* fontData) {
+    uint32_t capacity = fontData->sparse == NULL ? FONTMANAGER_SPARSE_INITIAL_CAPACITY : (fontData->sparseMask + 1) * 2;
+    struct GlyphSlot* slots = malloc(capacity * sizeof(struct GlyphSlot));
+
+    if (slots == NULL) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        slots[i].codepoint = FONTMANAGER_EMPTY_SLOT;
+    }
+
+    if (fontData->sparse != NULL) {
+        for (uint32_t i = 0; i <= fontData->sparseMask; i++) {
+            if (fontData->sparse[i].codepoint != FONTMANAGER_EMPTY_SLOT) {
+                *_Find_Slot(slots, capacity - 1, fontData->sparse[i].codepoint) = fontData->sparse[i];
+            }
+        }
+    }
+
+    free(fontData->sparse);
+    fontData->sparse = slots;
+    fontData->sparseMask = capacity - 1;
+
+    return true;
+}
+
+// Returns the table entry for codepoint, adding it if needed, or NULL when
+// out of memory. Pointers into the sparse table only hold until the next
+// lookup.
+static struct CachedGlyph* _Get_Entry(struct FontData* fontData, int codepoint) {
+    struct CachedGlyph* glyph;
+
+    if (codepoint >= 0 && codepoint < 256) {
+        glyph = &fontData->latin1[codepoint];
+    } else {
+        // kept at most half full so probe chains stay short
+        if ((fontData->sparseCount + 1) * 2 > (fontData->sparse == NULL ? 0 : fontData->sparseMask + 1) && !_Grow_Sparse(fontData)) {
+            return NULL;
+        }
+
+        struct GlyphSlot* slot = _Find_Slot(fontData->sparse, fontData->sparseMask, codepoint);
+
+        if (slot->codepoint == FONTMANAGER_EMPTY_SLOT) {
+            *slot = (struct GlyphSlot){.codepoint = codepoint};
+            fontData->sparseCount++;
+        }
+
+        glyph = &slot->glyph;
+    }
 
-#define FONTMANAGER_MAX_LOADED_FONTS 32
+    return glyph;
+}
+
+// Returns the glyph for codepoint with its metrics loaded, or NULL if it
+// could not be loaded.
+static struct CachedGlyph* _Lookup_Glyph(struct FontData* fontData, int codepoint) {
+    struct CachedGlyph* glyph = _Get_Entry(fontData, codepoint);
+
+    if (glyph != NULL && !glyph->loaded && !_Rasterize_Glyph(fontData, codepoint, glyph)) {
+        return NULL;
+    }
+
+    return glyph;
+}
+
+//---------------------------------------------------------
+// GLYPH CACHE
+//---------------------------------------------------------
 
-struct FontArray {
-    Font fonts[FONTMANAGER_MAX_LOADED_FONTS];
-    size_t loadedFontsCount;
+/*
+    Every font gets printable ASCII up front, the glyphs nearly all text is
+    made of. Rasterizing them is most of what loading a font costs, so the
+    result is kept on disk: one file per font file, size and glyph type, with
+    the metrics and the padded GRAY_ALPHA bitmaps exactly as the atlas takes
+    them. The next run maps the file and uploads straight from it.
+
+    The file is named after a hash of the font file contents, so editing or
+    replacing a font never picks up stale glyphs, and the header repeats the
+    key in case two fonts ever share a name. A cache that does not match is
+    simply rebuilt. It is not meant to be moved between machines, as it is
+    written in native byte order.
+*/
+
+struct GlyphCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t fileHash;
+    uint32_t fontSize;
+    int32_t glyphType;
+    int32_t firstCodepoint;
+    int32_t lastCodepoint;
+    uint32_t pixelBytes;
+};
+
+// A glyph with no visible pixels has width and height 0.
+struct GlyphCacheEntry {
+    float advance;
+    float offsetX;
+    float offsetY;
+    uint16_t width;
+    uint16_t height;
+    uint32_t pixelOffset;
 };
 
-struct FontArray fontArray;
+#define FONTMANAGER_WARMUP_COUNT (FONTMANAGER_WARMUP_LAST - FONTMANAGER_WARMUP_FIRST + 1)
+
+// FNV-1a
+static uint64_t _Hash_File(const unsigned char* data, int size) {
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (int i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+#ifdef DEBUG
+static double _Now_Ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+#endif
+
+/*
+    The cache goes where the user's caches go, $XDG_CACHE_HOME or
+    ~/.cache, under FONTMANAGER_CACHE_NAME. Without a home directory it goes
+    next to the executable. Never the working directory, which may be
+    anywhere and not writable. Left empty, which turns the cache off, when
+    the path does not fit.
+*/
+static char cacheDir[FONTMANAGER_CACHE_DIR_SIZE];
+
+static void _Resolve_Cache_Dir(void) {
+    const char* xdgCacheHome = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    int length;
+
+    if (xdgCacheHome != NULL && xdgCacheHome[0] == '/') {
+        length = snprintf(cacheDir, sizeof(cacheDir), "%s/" FONTMANAGER_CACHE_NAME, xdgCacheHome);
+    } else if (home != NULL && home[0] == '/') {
+        length = snprintf(cacheDir, sizeof(cacheDir), "%s/.cache/" FONTMANAGER_CACHE_NAME, home);
+    } else {
+        // ends with a separator already
+        length = snprintf(cacheDir, sizeof(cacheDir), "%scache", GetApplicationDirectory());
+    }
+
+    if (length < 0 || length >= (int)sizeof(cacheDir)) {
+        cacheDir[0] = '\0';
+    }
+}
+
+// mkdir -p, failing harmlessly on directories that already exist.
+static void _Make_Cache_Dir(void) {
+    char path[FONTMANAGER_CACHE_DIR_SIZE];
+    strcpy(path, cacheDir);
+
+    for (char* c = path + 1; *c != '\0'; c++) {
+        if (*c == '/') {
+            *c = '\0';
+            mkdir(path, 0755);
+            *c = '/';
+        }
+    }
+
+    mkdir(path, 0755);
+}
+
+// Fills the warm-up glyphs from the cache at path. Returns false when there is
+// no usable cache.
+static bool _Load_Glyph_Cache(struct FontData* fontData, const char* path, uint64_t fileHash) {
+    int file = open(path, O_RDONLY);
+
+    if (file < 0) {
+        return false;
+    }
+
+    struct stat info;
+    void* mapping = MAP_FAILED;
+
+    if (fstat(file, &info) == 0 && (size_t)info.st_size >= sizeof(struct GlyphCacheHeader)) {
+        mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+
+    close(file);
+
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    const struct GlyphCacheHeader* header = mapping;
+    const struct GlyphCacheEntry* entries = (const struct GlyphCacheEntry*)(header + 1);
+    const unsigned char* pixels = (const unsigned char*)(entries + FONTMANAGER_WARMUP_COUNT);
+    size_t expectedSize = sizeof(struct GlyphCacheHeader) + FONTMANAGER_WARMUP_COUNT * sizeof(struct GlyphCacheEntry) + header->pixelBytes;
+
+    bool valid = header->magic == FONTMANAGER_CACHE_MAGIC && header->version == FONTMANAGER_CACHE_VERSION && header->fileHash == fileHash && header->fontSize == fontData->fontSize && header->glyphType == fontData->glyphType && header->firstCodepoint == FONTMANAGER_WARMUP_FIRST && header->lastCodepoint == FONTMANAGER_WARMUP_LAST && (size_t)info.st_size == expectedSize;
+
+    for (int i = 0; valid && i < FONTMANAGER_WARMUP_COUNT; i++) {
+        valid = (uint64_t)entries[i].pixelOffset + entries[i].width * entries[i].height * 2 <= header->pixelBytes;
+    }
+
+    for (int i = 0; valid && i < FONTMANAGER_WARMUP_COUNT; i++) {
+        struct CachedGlyph* glyph = &fontData->latin1[FONTMANAGER_WARMUP_FIRST + i];
+
+        glyph->loaded = true;
+        glyph->hasBitmap = entries[i].width > 0;
+        glyph->advance = entries[i].advance;
+        glyph->offsetX = entries[i].offsetX;
+        glyph->offsetY = entries[i].offsetY;
+
+        if (glyph->hasBitmap) {
+            GlyphAtlas_Insert(entries[i].width, entries[i].height, pixels + entries[i].pixelOffset, fontData->glyphType == FONT_SDF, &glyph->region);
+        }
+    }
+
+    munmap(mapping, info.st_size);
+
+    return valid;
+}
+
+static void _Write_Glyph_Cache(struct FontData* fontData, const char* path, uint64_t fileHash, GlyphInfo* glyphs) {
+    struct GlyphCacheHeader header = {.magic = FONTMANAGER_CACHE_MAGIC,
+                                      .version = FONTMANAGER_CACHE_VERSION,
+                                      .fileHash = fileHash,
+                                      .fontSize = fontData->fontSize,
+                                      .glyphType = fontData->glyphType,
+                                      .firstCodepoint = FONTMANAGER_WARMUP_FIRST,
+                                      .lastCodepoint = FONTMANAGER_WARMUP_LAST};
+    struct GlyphCacheEntry entries[FONTMANAGER_WARMUP_COUNT];
+
+    for (int i = 0; i < FONTMANAGER_WARMUP_COUNT; i++) {
+        struct CachedGlyph* glyph = &fontData->latin1[FONTMANAGER_WARMUP_FIRST + i];
+        entries[i] = (struct GlyphCacheEntry){.advance = glyph->advance, .offsetX = glyph->offsetX, .offsetY = glyph->offsetY, .pixelOffset = header.pixelBytes};
+
+        if (glyph->hasBitmap) {
+            entries[i].width = glyphs[i].image.width + 2 * FONTMANAGER_GLYPH_PADDING;
+            entries[i].height = glyphs[i].image.height + 2 * FONTMANAGER_GLYPH_PADDING;
+            header.pixelBytes += entries[i].width * entries[i].height * 2;
+        }
+    }
+
+    size_t size = sizeof(header) + sizeof(entries) + header.pixelBytes;
+    unsigned char* buffer = malloc(size);
+
+    if (buffer == NULL) {
+        return;
+    }
+
+    memcpy(buffer, &header, sizeof(header));
+    memcpy(buffer + sizeof(header), entries, sizeof(entries));
+
+    for (int i = 0; i < FONTMANAGER_WARMUP_COUNT; i++) {
+        if (entries[i].width == 0) {
+            continue;
+        }
+
+        int width, height;
+        unsigned char* grayAlpha = _Pad_Glyph(glyphs[i].image, &width, &height);
+
+        if (grayAlpha == NULL) {
+            free(buffer);
+            return;
+        }
+
+        memcpy(buffer + sizeof(header) + sizeof(entries) + entries[i].pixelOffset, grayAlpha, width * height * 2);
+        free(grayAlpha);
+    }
+
+    _Make_Cache_Dir();
+
+    if (!SaveFileData(path, buffer, (int)size)) {
+        fprintf(stderr, "FONT: Cannot write glyph cache %s.\n", path);
+    }
+
+    free(buffer);
+}
+
+// Rasterizes the warm-up glyphs and caches them for the next run. Returns
+// false if the font file cannot be parsed.
+static bool _Build_Glyph_Cache(struct FontData* fontData, const char* path, uint64_t fileHash) {
+    int codepoints[FONTMANAGER_WARMUP_COUNT];
+
+    for (int i = 0; i < FONTMANAGER_WARMUP_COUNT; i++) {
+        codepoints[i] = FONTMANAGER_WARMUP_FIRST + i;
+    }
+
+    GlyphInfo* glyphs = LoadFontData(fontData->fileData, fontData->fileSize, fontData->fontSize, codepoints, FONTMANAGER_WARMUP_COUNT, fontData->glyphType);
+
+    if (glyphs == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < FONTMANAGER_WARMUP_COUNT; i++) {
+        _Store_Glyph(fontData, &glyphs[i], &fontData->latin1[codepoints[i]]);
+    }
+
+    if (path[0] != '\0') {
+        _Write_Glyph_Cache(fontData, path, fileHash, glyphs);
+    }
+    UnloadFontData(glyphs, FONTMANAGER_WARMUP_COUNT);
+
+    return true;
+}
+
+// Loads the warm-up glyphs, from the cache when there is one. Returns false
+// if the font file cannot be parsed.
+static bool _Warm_Up(struct FontData* fontData) {
+#ifdef DEBUG
+    double start = _Now_Ms();
+#endif
+    uint64_t fileHash = _Hash_File(fontData->fileData, fontData->fileSize);
+    char path[FONTMANAGER_CACHE_DIR_SIZE + 64] = "";
+
+    if (cacheDir[0] != '\0') {
+        snprintf(path, sizeof(path), "%s/glyphs-%016llx-%u-%d.bin", cacheDir, (unsigned long long)fileHash, fontData->fontSize, fontData->glyphType);
+    }
+
+    bool cached = path[0] != '\0' && _Load_Glyph_Cache(fontData, path, fileHash);
+
+    if (!cached && !_Build_Glyph_Cache(fontData, path, fileHash)) {
+        return false;
+    }
+
+#ifdef DEBUG
+    fprintf(stderr, "FONT: Loaded %s at %u %s in %.2f ms.\n", fontData->filePath, fontData->fontSize, cached ? "from the glyph cache" : "without a glyph cache", _Now_Ms() - start);
+#endif
+
+    return true;
+}
+
+//---------------------------------------------------------
+// FONT FAMILIES
+//---------------------------------------------------------
+
+/*
+    A family is one parsed font file that can be drawn at any pixel size. Each
+    size in use gets its own variant, so text is rasterized at the size it is
+    drawn at instead of being scaled.
+
+    Asking for a size the family does not have yet gives the nearest ready
+    variant, and queues the new size on a background thread, which rasterizes
+    the glyphs the nearest variant has needed so far. Uploading them to the
+    atlas has to happen on the main thread, in FontManager_Update, after which
+    the variant is ready and text measured with its neighbour must be measured
+    again.
+*/
+
+struct VariantJob {
+    uint16_t family;
+    uint16_t variant;
+    const unsigned char* fileData;
+    int fileSize;
+    uint8_t fontSize;
+    int codepoints[FONTMANAGER_MAX_WARMUP_CODEPOINTS];
+    int codepointCount;
+    GlyphInfo* glyphs;
+    struct VariantJob* next;
+};
+
+struct VariantWorker {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t wake;
+    bool started;
+    bool stopping;
+    struct VariantJob* queued;
+    struct VariantJob* finished;
+};
+
+struct VariantWorker variantWorker = {.mutex = PTHREAD_MUTEX_INITIALIZER, .wake = PTHREAD_COND_INITIALIZER};
+
+static void* _Variant_Worker(void* unused) {
+    pthread_mutex_lock(&variantWorker.mutex);
+
+    while (true) {
+        while (variantWorker.queued == NULL && !variantWorker.stopping) {
+            pthread_cond_wait(&variantWorker.wake, &variantWorker.mutex);
+        }
+
+        // jobs still queued are dropped by FontManager_Shutdown
+        if (variantWorker.stopping) {
+            break;
+        }
+
+        struct VariantJob* job = variantWorker.queued;
+        variantWorker.queued = job->next;
+
+        // only reads the file data, which stays alive while the job is pending
+        pthread_mutex_unlock(&variantWorker.mutex);
+        job->glyphs = LoadFontData(job->fileData, job->fileSize, job->fontSize, job->codepoints, job->codepointCount, FONT_DEFAULT);
+        pthread_mutex_lock(&variantWorker.mutex);
+
+        job->next = variantWorker.finished;
+        variantWorker.finished = job;
+    }
+
+    pthread_mutex_unlock(&variantWorker.mutex);
+
+    return NULL;
+}
+
+static bool _Queue_Variant_Job(struct VariantJob* job) {
+    pthread_mutex_lock(&variantWorker.mutex);
+
+    if (!variantWorker.started) {
+        if (pthread_create(&variantWorker.thread, NULL, _Variant_Worker, NULL) != 0) {
+            pthread_mutex_unlock(&variantWorker.mutex);
+            return false;
+        }
+
+        variantWorker.started = true;
+    }
+
+    job->next = variantWorker.queued;
+    variantWorker.queued = job;
+
+    pthread_cond_signal(&variantWorker.wake);
+    pthread_mutex_unlock(&variantWorker.mutex);
+
+    return true;
+}
+
+// Every codepoint the variant has needed so far, ASCII first.
+static int _Collect_Warmup_Codepoints(struct FontData* fontData, int* codepoints) {
+    int count = 0;
+
+    for (int c = 32; c < 127; c++) {
+        codepoints[count++] = c;
+    }
+
+    for (int c = 127; c < 256 && count < FONTMANAGER_MAX_WARMUP_CODEPOINTS; c++) {
+        if (fontData->latin1[c].loaded) {
+            codepoints[count++] = c;
+        }
+    }
+
+    for (uint32_t i = 0; fontData->sparse != NULL && i <= fontData->sparseMask && count < FONTMANAGER_MAX_WARMUP_CODEPOINTS; i++) {
+        if (fontData->sparse[i].codepoint != FONTMANAGER_EMPTY_SLOT && fontData->sparse[i].glyph.loaded) {
+            codepoints[count++] = fontData->sparse[i].codepoint;
+        }
+    }
+
+    return count;
+}
+
+static uint16_t _Allocate_Slot(void);
+
+// Adds a variant for fontSize, ready right away if nothing is loaded yet to
+// stand in for it. Returns its slot index or FONTMANAGER_NO_FREE_SLOT.
+static uint16_t _Add_Variant(uint16_t familyIndex, uint8_t fontSize, int16_t nearestIndex) {
+    if (fontPool.fonts[familyIndex].variantCount == FONTMANAGER_MAX_VARIANTS) {
+        return FONTMANAGER_NO_FREE_SLOT;
+    }
+
+    struct VariantJob* job = NULL;
+
+    if (nearestIndex >= 0) {
+        job = malloc(sizeof(struct VariantJob));
+
+        if (job == NULL) {
+            return FONTMANAGER_NO_FREE_SLOT;
+        }
+    }
+
+    uint16_t index = _Allocate_Slot();
+
+    if (index == FONTMANAGER_NO_FREE_SLOT) {
+        free(job);
+        return FONTMANAGER_NO_FREE_SLOT;
+    }
+
+    // the pool may have moved
+    struct FontData* family = &fontPool.fonts[familyIndex];
+    struct FontData* variant = &fontPool.fonts[index];
+    uint16_t generation = variant->generation;
+
+    *variant = (struct FontData){.fileData = family->fileData,
+                                 .fileSize = family->fileSize,
+                                 .fontSize = fontSize,
+                                 .glyphType = family->glyphType,
+                                 .family = familyIndex,
+                                 .ready = job == NULL,
+                                 .generation = generation,
+                                 .refCount = 1};
+
+    family->variants[family->variantCount++] = index;
+
+    if (job == NULL) {
+        return index;
+    }
+
+    *job = (struct VariantJob){.family = familyIndex, .variant = index, .fileData = family->fileData, .fileSize = family->fileSize, .fontSize = fontSize};
+    job->codepointCount = _Collect_Warmup_Codepoints(&fontPool.fonts[nearestIndex], job->codepoints);
+
+    if (_Queue_Variant_Job(job)) {
+        family->pendingJobs++;
+    } else {
+        // no thread, the glyphs will be rasterized on demand instead
+        free(job);
+        variant->ready = true;
+    }
+
+    return index;
+}
+
+// Picks the variant to draw fontSize with: the exact one when ready, else the
+// nearest ready one, queuing the exact size if it does not exist yet.
+static struct FontData* _Resolve_Variant(struct FontData* fontData, float fontSize) {
+    if (!fontData->isFamily) {
+        return fontData;
+    }
+
+    uint16_t familyIndex = fontData - fontPool.fonts;
+    uint8_t wanted = fontSize < 1 ? 1 : fontSize > 255 ? 255 : (uint8_t)(fontSize + 0.5f);
+    int16_t nearest = -1;
+    int nearestDistance = 256;
+    bool exists = false;
+
+    for (uint8_t i = 0; i < fontData->variantCount; i++) {
+        struct FontData* variant = &fontPool.fonts[fontData->variants[i]];
+        int distance = abs(variant->fontSize - wanted);
+
+        if (distance == 0) {
+            exists = true;
+        }
+
+        // ties go to the bigger size, downscaling looks better
+        if (variant->ready && (distance < nearestDistance || (distance == nearestDistance && variant->fontSize > wanted))) {
+            nearest = fontData->variants[i];
+            nearestDistance = distance;
+        }
+    }
+
+    uint32_t failedBit = 1u << (wanted % 32);
+
+    if (!exists && (fontData->failedSizes[wanted / 32] & failedBit) == 0) {
+        uint16_t index = _Add_Variant(familyIndex, wanted, nearest);
+
+        if (index == FONTMANAGER_NO_FREE_SLOT) {
+            // the pool may have moved
+            fontPool.fonts[familyIndex].failedSizes[wanted / 32] |= failedBit;
+        } else if (fontPool.fonts[index].ready) {
+            nearest = index;
+        }
+    }
+
+    return nearest < 0 ? &fontPool.fonts[FONTMANAGER_DEFAULT_FONT] : &fontPool.fonts[nearest];
+}
+
+static void _Release_Font(uint16_t index);
+
+// Uploads what the background thread rasterized. Returns true when a variant
+// became ready.
+static bool _Collect_Variant_Jobs(void) {
+    pthread_mutex_lock(&variantWorker.mutex);
+    struct VariantJob* job = variantWorker.finished;
+    variantWorker.finished = NULL;
+    pthread_mutex_unlock(&variantWorker.mutex);
+
+    bool anyReady = false;
+
+    while (job != NULL) {
+        struct VariantJob* next = job->next;
+        struct FontData* family = &fontPool.fonts[job->family];
+        struct FontData* variant = &fontPool.fonts[job->variant];
+
+        family->pendingJobs--;
+
+        if (!family->releasePending && job->glyphs != NULL) {
+            for (int i = 0; i < job->codepointCount; i++) {
+                struct CachedGlyph* glyph = _Get_Entry(variant, job->glyphs[i].value);
+
+                if (glyph != NULL && !glyph->loaded) {
+                    _Store_Glyph(variant, &job->glyphs[i], glyph);
+                }
+            }
+        }
+
+        if (job->glyphs != NULL) {
+            UnloadFontData(job->glyphs, job->codepointCount);
+        }
+
+        variant->ready = true;
+        anyReady = anyReady || !family->releasePending;
+
+        if (family->releasePending && family->pendingJobs == 0) {
+            family->releasePending = false;
+            _Release_Font(job->family);
+        }
+
+        free(job);
+        job = next;
+    }
+
+    return anyReady;
+}
+
+//---------------------------------------------------------
+// TEXT MEASUREMENT
+//---------------------------------------------------------
+
+static bool _Is_Ascii(const char* text, int32_t length) {
+    int32_t i = 0;
+
+#if !defined(FONTMANAGER_DISABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(_M_AMD64))
+    for (; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(text + i));
+        if (_mm_movemask_epi8(bytes) != 0) {
+            return false;
+        }
+    }
+#elif !defined(FONTMANAGER_DISABLE_SIMD) && defined(__aarch64__)
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t bytes = vld1q_u8((const uint8_t*)(text + i));
+        if (vmaxvq_u8(bytes) >= 0x80) {
+            return false;
+        }
+    }
+#endif
+
+    for (; i < length; i++) {
+        if ((unsigned char)text[i] >= 0x80) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Bounded UTF-8 decoding, as the text is a slice of a larger string and has
+// no terminator. Invalid sequences decode as '?' one byte at a time, like
+// raylib does.
+static int _Decode_Codepoint(const unsigned char* text, int32_t length, int* size) {
+    *size = 1;
+
+    if (text[0] < 0x80) {
+        return text[0];
+    }
+
+    int extra = 0;
+    int codepoint = 0;
+
+    if ((text[0] & 0xe0) == 0xc0) {
+        extra = 1;
+        codepoint = text[0] & 0x1f;
+    } else if ((text[0] & 0xf0) == 0xe0) {
+        extra = 2;
+        codepoint = text[0] & 0x0f;
+    } else if ((text[0] & 0xf8) == 0xf0) {
+        extra = 3;
+        codepoint = text[0] & 0x07;
+    } else {
+        return '?';
+    }
+
+    if (extra >= length) {
+        return '?';
+    }
+
+    for (int i = 1; i <= extra; i++) {
+        if ((text[i] & 0xc0) != 0x80) {
+            return '?';
+        }
+        codepoint = (codepoint << 6) | (text[i] & 0x3f);
+    }
+
+    *size = extra + 1;
+    return codepoint;
+}
+
+static bool _Needs_Rasterizing(struct CachedGlyph* glyph, bool forDrawing) {
+    return glyph != NULL && (!glyph->loaded || (forDrawing && glyph->hasBitmap && !GlyphAtlas_IsResident(glyph->region)));
+}
+
+/*
+    LoadFontData parses the font file on every call, so glyphs are not
+    rasterized one at a time when it can be helped: the first glyph of a text
+    run that is missing, or evicted from the atlas when drawing, brings the
+    rest of the run's missing glyphs with it, up to
+    FONTMANAGER_MAX_BATCH_CODEPOINTS, in a single call. A paragraph of new
+    script then costs one parse instead of one per glyph.
+*/
+static void _Rasterize_Text(struct FontData* fontData, const char* text, int32_t length, bool forDrawing) {
+    int codepoints[FONTMANAGER_MAX_BATCH_CODEPOINTS];
+    int count = 0;
+
+    for (int32_t i = 0; i < length && count < FONTMANAGER_MAX_BATCH_CODEPOINTS;) {
+        int size;
+        int codepoint = _Decode_Codepoint((const unsigned char*)text + i, length - i, &size);
+        bool queued = false;
+
+        i += size;
+
+        for (int c = 0; c < count && !queued; c++) {
+            queued = codepoints[c] == codepoint;
+        }
+
+        if (!queued && _Needs_Rasterizing(_Get_Entry(fontData, codepoint), forDrawing)) {
+            codepoints[count++] = codepoint;
+        }
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    GlyphInfo* glyphs = LoadFontData(fontData->fileData, fontData->fileSize, fontData->fontSize, codepoints, count, fontData->glyphType);
+
+    if (glyphs == NULL) {
+        return;
+    }
+
+    for (int c = 0; c < count; c++) {
+        struct CachedGlyph* glyph = _Get_Entry(fontData, codepoints[c]);
 
-void FontManager_LoadFont(const char* fontFilePath, uint8_t fontSize) {
-    if (fontArray.loadedFontsCount == FONTMANAGER_MAX_LOADED_FONTS) {
+        if (glyph != NULL) {
+            _Store_Glyph(fontData, &glyphs[c], glyph);
+        }
+    }
+
+    UnloadFontData(glyphs, count);
+}
+
+/*
+    Measures text without copying or terminating it, matching MeasureTextEx
+    for single-line text: width is the sum of advances scaled to fontSize plus
+    spacing between every character, height is fontSize. Clay breaks lines
+    itself, so newlines are measured as ordinary glyphs.
+
+    Pure ASCII text, which is most of it, skips UTF-8 decoding and only sums
+    advances out of the Latin-1 table. Measuring a glyph for the first time
+    rasterizes it, as it is about to be drawn anyway.
+*/
+Vector2 FontManager_MeasureText(FontHandle id, const char* text, int32_t length, float fontSize, float spacing) {
+    struct FontData* fontData = _Get_Font(id);
+
+    if (fontData == NULL) {
+        fontData = &fontPool.fonts[FONTMANAGER_DEFAULT_FONT];
+    }
+
+    fontData = _Resolve_Variant(fontData, fontSize);
+
+    if (length <= 0) {
+        return (Vector2){0, 0};
+    }
+
+    float width = 0;
+    int32_t codepointCount = 0;
+
+    if (_Is_Ascii(text, length)) {
+        for (int32_t i = 0; i < length; i++) {
+            struct CachedGlyph* glyph = &fontData->latin1[(unsigned char)text[i]];
+
+            if (!glyph->loaded) {
+                _Rasterize_Text(fontData, text + i, length - i, false);
+                glyph = _Lookup_Glyph(fontData, (unsigned char)text[i]);
+            }
+
+            width += glyph == NULL ? 0 : glyph->advance;
+        }
+        codepointCount = length;
+    } else {
+        const unsigned char* bytes = (const unsigned char*)text;
+
+        for (int32_t i = 0; i < length; codepointCount++) {
+            int size;
+            int codepoint = _Decode_Codepoint(bytes + i, length - i, &size);
+            struct CachedGlyph* glyph = _Get_Entry(fontData, codepoint);
+
+            if (glyph != NULL && !glyph->loaded) {
+                _Rasterize_Text(fontData, text + i, length - i, false);
+                glyph = _Lookup_Glyph(fontData, codepoint);
+            }
+
+            width += glyph == NULL ? 0 : glyph->advance;
+            i += size;
+        }
+    }
+
+    float scaleFactor = fontSize / fontData->fontSize;
+
+    return (Vector2){width * scaleFactor + (codepointCount - 1) * spacing, fontSize};
+}
+
+// Decodes the codepoint at the start of text and returns its glyph, size is
+// set to the number of bytes it took. Glyphs evicted from the atlas are
+// rasterized again, glyphs with nothing to draw have a texture id of 0.
+struct Glyph FontManager_NextGlyph(FontHandle id, const char* text, int32_t length, int* size) {
+    struct FontData* fontData = _Get_Font(id);
+
+    if (fontData == NULL) {
+        fontData = &fontPool.fonts[FONTMANAGER_DEFAULT_FONT];
+    }
+
+    int codepoint = _Decode_Codepoint((const unsigned char*)text, length, size);
+
+    if (_Needs_Rasterizing(_Get_Entry(fontData, codepoint), true)) {
+        _Rasterize_Text(fontData, text, length, true);
+    }
+
+    struct CachedGlyph* cached = _Lookup_Glyph(fontData, codepoint);
+
+    if (cached == NULL) {
+        return (struct Glyph){0};
+    }
+
+    struct Glyph glyph = {.advance = cached->advance, .offsetX = cached->offsetX, .offsetY = cached->offsetY};
+
+    if (!cached->hasBitmap) {
+        return glyph;
+    }
+
+    if (!GlyphAtlas_IsResident(cached->region)) {
+        cached->loaded = false;
+
+        if (!_Rasterize_Glyph(fontData, codepoint, cached) || !GlyphAtlas_IsResident(cached->region)) {
+            return glyph;
+        }
+    }
+
+    glyph.rect = cached->region.rect;
+    glyph.texture = GlyphAtlas_GetTexture(cached->region);
+    glyph.distanceField = GlyphAtlas_IsDistanceField(cached->region);
+
+    return glyph;
+}
+
+// Returns the font text of fontSize should be measured and drawn with: id
+// itself for plain fonts, the best ready size variant for families.
+FontHandle FontManager_Resolve(FontHandle id, float fontSize) {
+    struct FontData* fontData = _Get_Font(id);
+
+    if (fontData == NULL) {
+        return FONTMANAGER_DEFAULT_FONT;
+    }
+
+    fontData = _Resolve_Variant(fontData, fontSize);
+
+    return _Make_Handle(fontData - fontPool.fonts);
+}
+
+uint8_t FontManager_GetBaseSize(FontHandle id) {
+    struct FontData* fontData = _Get_Font(id);
+
+    if (fontData == NULL) {
+        fontData = &fontPool.fonts[FONTMANAGER_DEFAULT_FONT];
+    }
+
+    return fontData->fontSize;
+}
+
+static FontHandle _Load_Font(const char* fontFilePath, uint8_t fontSize, int glyphType, bool isFamily) {
+    for (uint16_t i = 0; i < fontPool.used; i++) {
+        struct FontData* fontData = &fontPool.fonts[i];
+
+        // variants have no path and never match
+        if (fontData->refCount > 0 && fontData->filePath != NULL && fontData->isFamily == isFamily && fontData->fontSize == fontSize && fontData->glyphType == glyphType && strcmp(fontData->filePath, fontFilePath) == 0) {
+            fontData->refCount++;
+            return _Make_Handle(i);
+        }
+    }
+
+    int fileSize = 0;
+    unsigned char* fileData = LoadFileData(fontFilePath, &fileSize);
+
+    if (fileData == NULL) {
+        fprintf(stderr, "FONT: Cannot load font - Does the font file exists?\n");
+        return FONTMANAGER_INVALID_HANDLE;
+    }
+
+    uint16_t index = _Allocate_Slot();
+    char* filePath = malloc(strlen(fontFilePath) + 1);
+
+    if (index == FONTMANAGER_NO_FREE_SLOT || filePath == NULL) {
         fprintf(stderr, "FONT: Cannot load font - exceeded capacity limit.\n");
+        UnloadFileData(fileData);
+        free(filePath);
+        return FONTMANAGER_INVALID_HANDLE;
+    }
+
+    strcpy(filePath, fontFilePath);
+
+    struct FontData* fontData = &fontPool.fonts[index];
+    uint16_t generation = fontData->generation;
+
+    *fontData = (struct FontData){.fileData = fileData,
+                                  .fileSize = fileSize,
+                                  .filePath = filePath,
+                                  .fontSize = fontSize,
+                                  .glyphType = glyphType,
+                                  .family = FONTMANAGER_NO_FREE_SLOT,
+                                  .ready = true,
+                                  .generation = generation,
+                                  .refCount = 1};
+
+    // anything past the warm-up glyphs is rasterized on demand
+    if (!_Warm_Up(fontData)) {
+        fprintf(stderr, "FONT: Cannot load font - %s is not a valid font file.\n", fontFilePath);
+        UnloadFileData(fileData);
+        free(filePath);
+        // back on the free list, generation unchanged as no handle was given
+        fontData->refCount = 0;
+        _Free_Slot(index);
+        return FONTMANAGER_INVALID_HANDLE;
+    }
+
+    // the family itself is the first variant, at the size it was loaded with
+    if (isFamily) {
+        fontData->isFamily = true;
+        fontData->variants[0] = index;
+        fontData->variantCount = 1;
+    }
+
+    return _Make_Handle(index);
+}
+
+// Loading the same file at the same size again returns the same handle and
+// adds a reference to it, every load must be matched by a FontManager_UnloadFont.
+FontHandle FontManager_LoadFont(const char* fontFilePath, uint8_t fontSize) {
+    return _Load_Font(fontFilePath, fontSize, FONT_DEFAULT, false);
+}
+
+// A family parses the file once and serves text at whatever fontSize it asks
+// for, generating size variants as they are needed. fontSize is the first
+// variant, ready right away.
+FontHandle FontManager_LoadFamily(const char* fontFilePath, uint8_t fontSize) {
+    return _Load_Font(fontFilePath, fontSize, FONT_DEFAULT, true);
+}
+
+// A distance field font is rasterized once and drawn at any fontSize through
+// a shader, instead of needing a font per size. Measurement scales linearly
+// from its one set of metrics.
+FontHandle FontManager_LoadFontSDF(const char* fontFilePath) {
+    return _Load_Font(fontFilePath, FONTMANAGER_SDF_BASE_SIZE, FONT_SDF, false);
+}
+
+// Drops one reference. The last one frees the font and makes every copy of
+// the handle stale. The default font is never freed. Its glyphs are left in
+// the atlas, where they go cold and are evicted as space is needed.
+void FontManager_UnloadFont(FontHandle handle) {
+    struct FontData* fontData = _Get_Font(handle);
+
+    if (fontData == NULL) {
+        fprintf(stderr, "FONT: Cannot unload font - handle %u is not loaded.\n", handle);
+        return;
+    }
+
+    if (handle == FONTMANAGER_DEFAULT_FONT) {
+        fprintf(stderr, "FONT: Cannot unload the default font.\n");
         return;
     }
 
-    Font loadedFont = LoadFontEx(fontFilePath, fontSize, NULL, 0);
+    if (--fontData->refCount > 0) {
+        return;
+    }
 
-    if (loadedFont.baseSize != fontSize) {
-        fprintf(stderr, "FONT: Cannot load font - Base size mismatch. Does the font file exists?\n");
+    // stale from here on, even if the memory has to wait for the background
+    // thread
+    fontData->generation++;
+
+    if (fontData->pendingJobs > 0) {
+        fontData->releasePending = true;
         return;
     }
 
-    fontArray.fonts[fontArray.loadedFontsCount++] = loadedFont;
+    _Release_Font(handle & FONTMANAGER_INDEX_MASK);
+}
+
+// Frees a font, or a family with all its variants, and puts the slots back on
+// the free list.
+static void _Release_Font(uint16_t index) {
+    struct FontData* fontData = &fontPool.fonts[index];
+
+    if (fontData->isFamily) {
+        // the family is its own first variant
+        for (uint8_t i = 1; i < fontData->variantCount; i++) {
+            struct FontData* variant = &fontPool.fonts[fontData->variants[i]];
+
+            free(variant->sparse);
+            variant->sparse = NULL;
+            variant->refCount = 0;
+            variant->generation++;
+            _Free_Slot(fontData->variants[i]);
+        }
+    }
+
+    UnloadFileData(fontData->fileData);
+    free(fontData->sparse);
+    free(fontData->filePath);
+    fontData->sparse = NULL;
+    fontData->filePath = NULL;
+    fontData->refCount = 0;
+    fontData->isFamily = false;
+
+    _Free_Slot(index);
 }
 
 void FontManager_Init(void) {
-    fontArray.loadedFontsCount = 0;
+    fontPool = (struct FontPool){.freeHead = FONTMANAGER_NO_FREE_SLOT};
+    _Resolve_Cache_Dir();
 
     FontManager_LoadFont("fonts/OpenSans-Regular.ttf", 16);
 }
 
-Font FontManager_GetFontByID(uint8_t id) {
-    return fontArray.fonts[id];
+// Called once per frame, before layout. Returns true when a font size variant
+// became ready, as text measured with a stand-in size is then out of date.
+bool FontManager_Update(void) {
+    GlyphAtlas_NextFrame();
+
+    return _Collect_Variant_Jobs();
+}
+
+// Drops background jobs that will never be collected, releasing fonts that
+// were only waiting on them.
+static void _Drop_Variant_Jobs(struct VariantJob* job) {
+    while (job != NULL) {
+        struct VariantJob* next = job->next;
+        struct FontData* family = &fontPool.fonts[job->family];
+
+        if (job->glyphs != NULL) {
+            UnloadFontData(job->glyphs, job->codepointCount);
+        }
+
+        if (--family->pendingJobs == 0 && family->releasePending) {
+            family->releasePending = false;
+            _Release_Font(job->family);
+        }
+
+        free(job);
+        job = next;
+    }
+}
+
+// Stops and joins the background thread, then frees every font, including
+// the default one. Nothing may be measured or drawn afterwards until
+// FontManager_Init is called again. Glyph bitmaps stay in the atlas pages,
+// which go with the window.
+void FontManager_Shutdown(void) {
+    pthread_mutex_lock(&variantWorker.mutex);
+    variantWorker.stopping = true;
+    pthread_cond_broadcast(&variantWorker.wake);
+    pthread_mutex_unlock(&variantWorker.mutex);
+
+    if (variantWorker.started) {
+        pthread_join(variantWorker.thread, NULL);
+    }
+
+    _Drop_Variant_Jobs(variantWorker.queued);
+    _Drop_Variant_Jobs(variantWorker.finished);
+
+    variantWorker.queued = NULL;
+    variantWorker.finished = NULL;
+    variantWorker.started = false;
+    variantWorker.stopping = false;
+
+    // variants go with their family
+    for (uint16_t i = 0; i < fontPool.used; i++) {
+        if (fontPool.fonts[i].refCount > 0 && fontPool.fonts[i].family == FONTMANAGER_NO_FREE_SLOT) {
+            _Release_Font(i);
+        }
+    }
+
+    free(fontPool.fonts);
+    fontPool = (struct FontPool){.freeHead = FONTMANAGER_NO_FREE_SLOT};
 }
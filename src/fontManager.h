@@ -1,11 +1,37 @@
 #ifndef __FONT_MANAGER_H__
 #define __FONT_MANAGER_H__
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <raylib.h>
 
+// Used directly as Clay's fontId. The default font is always handle 0.
+typedef uint16_t FontHandle;
+
+#define FONTMANAGER_DEFAULT_FONT 0
+#define FONTMANAGER_INVALID_HANDLE UINT16_MAX
+
+// A glyph ready to be drawn, metrics are at the font's base size. rect is the
+// glyph's area in texture, offsets place that area relative to the pen.
+struct Glyph {
+    float advance;
+    float offsetX;
+    float offsetY;
+    Rectangle rect;
+    Texture2D texture;
+    bool distanceField;
+};
+
 void FontManager_Init(void);
-Font FontManager_GetFontByID(uint8_t id);
-void FontManager_LoadFont(const char* fontFilePath, uint8_t fontSize);
+bool FontManager_Update(void);
+void FontManager_Shutdown(void);
+uint8_t FontManager_GetBaseSize(FontHandle id);
+FontHandle FontManager_LoadFont(const char* fontFilePath, uint8_t fontSize);
+FontHandle FontManager_LoadFontSDF(const char* fontFilePath);
+FontHandle FontManager_LoadFamily(const char* fontFilePath, uint8_t fontSize);
+FontHandle FontManager_Resolve(FontHandle id, float fontSize);
+void FontManager_UnloadFont(FontHandle handle);
+struct Glyph FontManager_NextGlyph(FontHandle id, const char* text, int32_t length, int* size);
+Vector2 FontManager_MeasureText(FontHandle id, const char* text, int32_t length, float fontSize, float spacing);
 
 #endif
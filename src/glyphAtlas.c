@@ -0,0 +1,469 @@
+#include "glyphAtlas.h"
+#include <raylib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GLYPHATLAS_PAGE_SIZE 1024
+#define GLYPHATLAS_MAX_PAGES 8
+#define GLYPHATLAS_INITIAL_SLOTS 256
+#define GLYPHATLAS_NO_SLOT -1
+
+/*
+    Glyph bitmaps from every font and size share a few GRAY_ALPHA pages, so a
+    texture is bound per page rather than per font.
+
+    Pages are packed with a skyline: the top edge of what has been placed so
+    far, kept as a list of horizontal segments. A bitmap goes where its top
+    ends up lowest, which suits glyphs as they are all about the same height.
+
+    Every bitmap placed on the skyline gets a slot, a rectangle that belongs
+    to it for as long as its page lives. Slots holding a bitmap are kept in
+    one least recently used list across pages: drawing a glyph moves its slot
+    to the front, at most once per frame.
+
+    When there is no room left for a new bitmap, the least recently used slot
+    it fits in is handed over to it, which turns the region of the glyph that
+    was there stale. Fonts re-insert their glyphs from there the next time
+    they are drawn. Slots much larger than the bitmap are only taken when
+    nothing closer in size is cold. A slot used during the current frame is
+    never taken, as its glyph may still be queued for drawing.
+
+    A skyline cannot give space back on its own, so when no cold slot is big
+    enough, the least recently used page is emptied as a last resort.
+
+    Distance field glyphs need bilinear filtering where bitmap glyphs are
+    sampled as is, so a page only holds one kind, and takes the kind of what
+    is inserted into it after being emptied.
+*/
+
+struct SkylineNode {
+    int x;
+    int y;
+    int width;
+};
+
+struct AtlasPage {
+    Texture2D texture;
+    bool distanceField;
+    struct SkylineNode skyline[GLYPHATLAS_PAGE_SIZE];
+    int nodeCount;
+    uint32_t lastUsedFrame;
+};
+
+// A stamp of 0 means the slot's page was emptied and the slot is free, free
+// slots are chained through next.
+struct AtlasSlot {
+    uint16_t page;
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+    uint32_t stamp;
+    uint32_t lastUsedFrame;
+    int32_t previous;
+    int32_t next;
+};
+
+struct GlyphAtlas {
+    struct AtlasPage pages[GLYPHATLAS_MAX_PAGES];
+    uint16_t pageCount;
+    uint32_t frame;
+
+    struct AtlasSlot* slots;
+    int32_t slotCount;
+    int32_t slotCapacity;
+    int32_t freeSlot;
+    // most recently used first
+    int32_t lruHead;
+    int32_t lruTail;
+    // given to every bitmap inserted, so regions can tell when their slot
+    // was handed over
+    uint32_t stamp;
+};
+
+struct GlyphAtlas glyphAtlas = {.freeSlot = GLYPHATLAS_NO_SLOT, .lruHead = GLYPHATLAS_NO_SLOT, .lruTail = GLYPHATLAS_NO_SLOT};
+
+static void _Lru_Unlink(int32_t index) {
+    struct AtlasSlot* slot = &glyphAtlas.slots[index];
+
+    if (slot->previous == GLYPHATLAS_NO_SLOT) {
+        glyphAtlas.lruHead = slot->next;
+    } else {
+        glyphAtlas.slots[slot->previous].next = slot->next;
+    }
+
+    if (slot->next == GLYPHATLAS_NO_SLOT) {
+        glyphAtlas.lruTail = slot->previous;
+    } else {
+        glyphAtlas.slots[slot->next].previous = slot->previous;
+    }
+}
+
+static void _Lru_Push_Front(int32_t index) {
+    struct AtlasSlot* slot = &glyphAtlas.slots[index];
+
+    slot->previous = GLYPHATLAS_NO_SLOT;
+    slot->next = glyphAtlas.lruHead;
+
+    if (glyphAtlas.lruHead == GLYPHATLAS_NO_SLOT) {
+        glyphAtlas.lruTail = index;
+    } else {
+        glyphAtlas.slots[glyphAtlas.lruHead].previous = index;
+    }
+
+    glyphAtlas.lruHead = index;
+}
+
+static void _Touch(int32_t index) {
+    struct AtlasSlot* slot = &glyphAtlas.slots[index];
+
+    slot->lastUsedFrame = glyphAtlas.frame;
+    glyphAtlas.pages[slot->page].lastUsedFrame = glyphAtlas.frame;
+
+    if (glyphAtlas.lruHead != index) {
+        _Lru_Unlink(index);
+        _Lru_Push_Front(index);
+    }
+}
+
+static void _Reset_Page(struct AtlasPage* page, bool distanceField) {
+    page->skyline[0] = (struct SkylineNode){0, 0, GLYPHATLAS_PAGE_SIZE};
+    page->nodeCount = 1;
+
+    // every slot on the page goes, which turns their regions stale
+    uint16_t pageIndex = page - glyphAtlas.pages;
+
+    for (int32_t i = 0; i < glyphAtlas.slotCount; i++) {
+        struct AtlasSlot* slot = &glyphAtlas.slots[i];
+
+        if (slot->page != pageIndex || slot->stamp == 0) {
+            continue;
+        }
+
+        _Lru_Unlink(i);
+        slot->stamp = 0;
+        slot->next = glyphAtlas.freeSlot;
+        glyphAtlas.freeSlot = i;
+    }
+
+    page->distanceField = distanceField;
+    SetTextureFilter(page->texture, distanceField ? TEXTURE_FILTER_BILINEAR : TEXTURE_FILTER_POINT);
+}
+
+static struct AtlasPage* _New_Page(bool distanceField) {
+    Image blank = GenImageColor(GLYPHATLAS_PAGE_SIZE, GLYPHATLAS_PAGE_SIZE, BLANK);
+    ImageFormat(&blank, PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA);
+
+    Texture2D texture = LoadTextureFromImage(blank);
+    UnloadImage(blank);
+
+    if (texture.id == 0) {
+        fprintf(stderr, "ATLAS: Cannot create atlas page - texture upload failed.\n");
+        return NULL;
+    }
+
+    struct AtlasPage* page = &glyphAtlas.pages[glyphAtlas.pageCount++];
+    page->texture = texture;
+    _Reset_Page(page, distanceField);
+
+    return page;
+}
+
+// Returns the y the bitmap would sit at if its left edge was on node index, or
+// -1 if it does not fit there.
+static int _Skyline_Fit(struct AtlasPage* page, int index, int width, int height) {
+    int x = page->skyline[index].x;
+
+    if (x + width > GLYPHATLAS_PAGE_SIZE) {
+        return -1;
+    }
+
+    int y = page->skyline[index].y;
+    int widthLeft = width;
+
+    while (widthLeft > 0) {
+        if (page->skyline[index].y > y) {
+            y = page->skyline[index].y;
+        }
+
+        if (y + height > GLYPHATLAS_PAGE_SIZE) {
+            return -1;
+        }
+
+        widthLeft -= page->skyline[index].width;
+        index++;
+    }
+
+    return y;
+}
+
+static void _Skyline_Remove(struct AtlasPage* page, int index) {
+    memmove(&page->skyline[index], &page->skyline[index + 1], (page->nodeCount - index - 1) * sizeof(struct SkylineNode));
+    page->nodeCount--;
+}
+
+static void _Skyline_Add(struct AtlasPage* page, int index, int x, int y, int width, int height) {
+    memmove(&page->skyline[index + 1], &page->skyline[index], (page->nodeCount - index) * sizeof(struct SkylineNode));
+    page->skyline[index] = (struct SkylineNode){x, y + height, width};
+    page->nodeCount++;
+
+    // the nodes now under the new one shrink or go away
+    for (int i = index + 1; i < page->nodeCount; i++) {
+        struct SkylineNode* previous = &page->skyline[i - 1];
+        int overlap = previous->x + previous->width - page->skyline[i].x;
+
+        if (overlap <= 0) {
+            break;
+        }
+
+        page->skyline[i].x += overlap;
+        page->skyline[i].width -= overlap;
+
+        if (page->skyline[i].width > 0) {
+            break;
+        }
+
+        _Skyline_Remove(page, i);
+        i--;
+    }
+
+    for (int i = 0; i < page->nodeCount - 1; i++) {
+        if (page->skyline[i].y == page->skyline[i + 1].y) {
+            page->skyline[i].width += page->skyline[i + 1].width;
+            _Skyline_Remove(page, i + 1);
+            i--;
+        }
+    }
+}
+
+static bool _Page_Insert(struct AtlasPage* page, int width, int height, Rectangle* rect) {
+    int bestIndex = -1;
+    int bestY = GLYPHATLAS_PAGE_SIZE;
+    int bestWidth = GLYPHATLAS_PAGE_SIZE;
+
+    // a new node is added per insert, there must be room for it
+    if (page->nodeCount == GLYPHATLAS_PAGE_SIZE) {
+        return false;
+    }
+
+    for (int i = 0; i < page->nodeCount; i++) {
+        int y = _Skyline_Fit(page, i, width, height);
+
+        if (y < 0) {
+            continue;
+        }
+
+        if (y < bestY || (y == bestY && page->skyline[i].width < bestWidth)) {
+            bestIndex = i;
+            bestY = y;
+            bestWidth = page->skyline[i].width;
+        }
+    }
+
+    if (bestIndex < 0) {
+        return false;
+    }
+
+    int x = page->skyline[bestIndex].x;
+    _Skyline_Add(page, bestIndex, x, bestY, width, height);
+
+    *rect = (Rectangle){x, bestY, width, height};
+
+    return true;
+}
+
+static struct AtlasPage* _Evict_Page(bool distanceField) {
+    struct AtlasPage* coldest = NULL;
+
+    for (int i = 0; i < glyphAtlas.pageCount; i++) {
+        struct AtlasPage* page = &glyphAtlas.pages[i];
+
+        if (page->lastUsedFrame == glyphAtlas.frame) {
+            continue;
+        }
+
+        if (coldest == NULL || page->lastUsedFrame < coldest->lastUsedFrame) {
+            coldest = page;
+        }
+    }
+
+    if (coldest != NULL) {
+        _Reset_Page(coldest, distanceField);
+    }
+
+    return coldest;
+}
+
+// Gives a slot to rect on page, or returns GLYPHATLAS_NO_SLOT when out of
+// memory.
+static int32_t _New_Slot(struct AtlasPage* page, Rectangle rect) {
+    int32_t index = glyphAtlas.freeSlot;
+
+    if (index != GLYPHATLAS_NO_SLOT) {
+        glyphAtlas.freeSlot = glyphAtlas.slots[index].next;
+    } else {
+        if (glyphAtlas.slotCount == glyphAtlas.slotCapacity) {
+            int32_t capacity = glyphAtlas.slotCapacity == 0 ? GLYPHATLAS_INITIAL_SLOTS : glyphAtlas.slotCapacity * 2;
+            struct AtlasSlot* slots = realloc(glyphAtlas.slots, capacity * sizeof(struct AtlasSlot));
+
+            if (slots == NULL) {
+                return GLYPHATLAS_NO_SLOT;
+            }
+
+            glyphAtlas.slots = slots;
+            glyphAtlas.slotCapacity = capacity;
+        }
+
+        index = glyphAtlas.slotCount++;
+    }
+
+    // stamped by the caller, anything but 0 marks it as holding a bitmap
+    glyphAtlas.slots[index] = (struct AtlasSlot){.page = page - glyphAtlas.pages, .x = rect.x, .y = rect.y, .width = rect.width, .height = rect.height, .stamp = 1};
+    _Lru_Push_Front(index);
+
+    return index;
+}
+
+// Returns the least recently used slot not used this frame that width x
+// height fits in, preferring slots at most twice as large each way, or
+// GLYPHATLAS_NO_SLOT.
+static int32_t _Evict_Glyph(int width, int height, bool distanceField) {
+    int32_t fallback = GLYPHATLAS_NO_SLOT;
+
+    for (int32_t i = glyphAtlas.lruTail; i != GLYPHATLAS_NO_SLOT; i = glyphAtlas.slots[i].previous) {
+        struct AtlasSlot* slot = &glyphAtlas.slots[i];
+
+        // everything from here to the front was used this frame too
+        if (slot->lastUsedFrame == glyphAtlas.frame) {
+            break;
+        }
+
+        if (glyphAtlas.pages[slot->page].distanceField != distanceField || slot->width < width || slot->height < height) {
+            continue;
+        }
+
+        if (slot->width <= 2 * width && slot->height <= 2 * height) {
+            return i;
+        }
+
+        if (fallback == GLYPHATLAS_NO_SLOT) {
+            fallback = i;
+        }
+    }
+
+    return fallback;
+}
+
+void GlyphAtlas_NextFrame(void) {
+    glyphAtlas.frame++;
+}
+
+// Copies the bitmap into a slot sized buffer, so what was left of a larger
+// bitmap in the slot is cleared along with the upload.
+static void _Upload(struct AtlasSlot* slot, int width, int height, const unsigned char* grayAlphaPixels) {
+    struct AtlasPage* page = &glyphAtlas.pages[slot->page];
+
+    if (slot->width == width && slot->height == height) {
+        UpdateTextureRec(page->texture, (Rectangle){slot->x, slot->y, width, height}, grayAlphaPixels);
+        return;
+    }
+
+    unsigned char* pixels = calloc(slot->width * slot->height, 2);
+
+    if (pixels == NULL) {
+        UpdateTextureRec(page->texture, (Rectangle){slot->x, slot->y, width, height}, grayAlphaPixels);
+        return;
+    }
+
+    for (int y = 0; y < height; y++) {
+        memcpy(pixels + y * slot->width * 2, grayAlphaPixels + y * width * 2, width * 2);
+    }
+
+    UpdateTextureRec(page->texture, (Rectangle){slot->x, slot->y, slot->width, slot->height}, pixels);
+    free(pixels);
+}
+
+bool GlyphAtlas_Insert(int width, int height, const unsigned char* grayAlphaPixels, bool distanceField, struct AtlasRegion* region) {
+    if (width > GLYPHATLAS_PAGE_SIZE || height > GLYPHATLAS_PAGE_SIZE) {
+        fprintf(stderr, "ATLAS: Cannot insert %dx%d bitmap - larger than a page.\n", width, height);
+        return false;
+    }
+
+    int32_t index = GLYPHATLAS_NO_SLOT;
+    Rectangle rect;
+
+    for (int i = 0; i < glyphAtlas.pageCount && index == GLYPHATLAS_NO_SLOT; i++) {
+        if (glyphAtlas.pages[i].distanceField == distanceField && _Page_Insert(&glyphAtlas.pages[i], width, height, &rect)) {
+            index = _New_Slot(&glyphAtlas.pages[i], rect);
+        }
+    }
+
+    if (index == GLYPHATLAS_NO_SLOT && glyphAtlas.pageCount < GLYPHATLAS_MAX_PAGES) {
+        struct AtlasPage* page = _New_Page(distanceField);
+
+        if (page != NULL && _Page_Insert(page, width, height, &rect)) {
+            index = _New_Slot(page, rect);
+        }
+    }
+
+    if (index == GLYPHATLAS_NO_SLOT) {
+        index = _Evict_Glyph(width, height, distanceField);
+    }
+
+    if (index == GLYPHATLAS_NO_SLOT) {
+        struct AtlasPage* page = _Evict_Page(distanceField);
+
+        if (page != NULL && _Page_Insert(page, width, height, &rect)) {
+            index = _New_Slot(page, rect);
+        }
+    }
+
+    if (index == GLYPHATLAS_NO_SLOT) {
+        return false;
+    }
+
+    struct AtlasSlot* slot = &glyphAtlas.slots[index];
+
+    _Upload(slot, width, height, grayAlphaPixels);
+    _Touch(index);
+
+    // wraps around, skipping 0 as that is what a region never inserted has
+    glyphAtlas.stamp++;
+    if (glyphAtlas.stamp == 0) {
+        glyphAtlas.stamp = 1;
+    }
+
+    slot->stamp = glyphAtlas.stamp;
+    *region = (struct AtlasRegion){.slot = index, .stamp = slot->stamp, .rect = {slot->x, slot->y, width, height}};
+
+    return true;
+}
+
+// Also marks the region's slot as used this frame.
+bool GlyphAtlas_IsResident(struct AtlasRegion region) {
+    if (region.stamp == 0 || region.slot >= glyphAtlas.slotCount) {
+        return false;
+    }
+
+    struct AtlasSlot* slot = &glyphAtlas.slots[region.slot];
+
+    if (slot->stamp != region.stamp) {
+        return false;
+    }
+
+    if (slot->lastUsedFrame != glyphAtlas.frame) {
+        _Touch(region.slot);
+    }
+
+    return true;
+}
+
+Texture2D GlyphAtlas_GetTexture(struct AtlasRegion region) {
+    return glyphAtlas.pages[glyphAtlas.slots[region.slot].page].texture;
+}
+
+bool GlyphAtlas_IsDistanceField(struct AtlasRegion region) {
+    return glyphAtlas.pages[glyphAtlas.slots[region.slot].page].distanceField;
+}
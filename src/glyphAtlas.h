@@ -0,0 +1,23 @@
+#ifndef __GLYPH_ATLAS_H__
+#define __GLYPH_ATLAS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <raylib.h>
+
+// Where a bitmap lives in the atlas. It stays there until its slot is handed
+// to another bitmap or its page is emptied, a zeroed region was never
+// inserted.
+struct AtlasRegion {
+    int32_t slot;
+    uint32_t stamp;
+    Rectangle rect;
+};
+
+void GlyphAtlas_NextFrame(void);
+bool GlyphAtlas_Insert(int width, int height, const unsigned char* grayAlphaPixels, bool distanceField, struct AtlasRegion* region);
+bool GlyphAtlas_IsResident(struct AtlasRegion region);
+Texture2D GlyphAtlas_GetTexture(struct AtlasRegion region);
+bool GlyphAtlas_IsDistanceField(struct AtlasRegion region);
+
+#endif
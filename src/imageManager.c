@@ -1,25 +1,79 @@
 #include "imageManager.h"
 #include "clay.h"
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 
-#define IMAGEMANAGER_MAX_LOADED_IMAGE 128
+#define IMAGEMANAGER_INITIAL_CAPACITY 16
+#define IMAGEMANAGER_NO_FREE_SLOT UINT32_MAX
+
+// An ImageHandle is the slot index in the low bits and the slot generation in
+// the high bits. Generations start at 1 so that no valid handle is 0.
+#define IMAGEMANAGER_INDEX_BITS 20
+#define IMAGEMANAGER_INDEX_MASK ((1u << IMAGEMANAGER_INDEX_BITS) - 1)
+#define IMAGEMANAGER_GENERATION_MASK                                           \
+    ((1u << (32 - IMAGEMANAGER_INDEX_BITS)) - 1)
+#define IMAGEMANAGER_FRAME_RING_SIZE 4
+
+// Format used for images with no transparency. R5G6B5 halves the memory again
+// but bands on photos and gradients.
+#ifndef IMAGEMANAGER_OPAQUE_FORMAT
+#define IMAGEMANAGER_OPAQUE_FORMAT PIXELFORMAT_UNCOMPRESSED_R8G8B8
+#endif
+
+// Frames of an animated image, already resized to the cached texture size,
+// waiting to be uploaded. Playback ticks held are [firstTick, firstTick +
+// count), and tick t lives in slot t % IMAGEMANAGER_FRAME_RING_SIZE.
+struct FrameRing {
+    Image frames[IMAGEMANAGER_FRAME_RING_SIZE];
+    uint32_t firstTick;
+    uint32_t count;
+};
 
 struct ImageData {
     Image image;
     Texture2D cachedTexture;
+    // Single-colour images are stored as white GRAY_ALPHA, their colour is
+    // given back to the renderer as tint. WHITE for everything else.
+    Color tint;
     uint32_t quantizedWidth;
     uint32_t quantizedHeight;
     uint32_t hash;
+
+    // Slot bookkeeping. A slot is free when refCount is 0, and its generation
+    // is bumped on release so handles to the old image stop matching.
+    uint32_t generation;
+    uint32_t refCount;
+    uint32_t nextFree;
+
+    // Animation state. Still images have a frameCount of 1 and never touch
+    // the rest. The frame shown is tick % frameCount.
+    int frameCount;
+    float frameDelay;
+    float frameTimer;
+    uint32_t tick;
+    uint32_t uploadedTick;
+    struct FrameRing ring;
+
+    // Nine-slice images are uploaded once at their source size and stretched
+    // by the GPU, so cachedTexture never depends on the drawn size.
+    bool isNineSlice;
+    NPatchInfo nPatchInfo;
 };
 
-struct ImageArray {
-    struct ImageData images[IMAGEMANAGER_MAX_LOADED_IMAGE];
-    size_t endPtr;
+// Grows by doubling. Released slots are chained through nextFree and reused
+// before the pool grows, so slot indices never move.
+struct ImagePool {
+    struct ImageData *images;
+    uint32_t capacity;
+    uint32_t used;
+    uint32_t freeHead;
 };
 
-struct ImageArray imageArray;
+struct ImagePool imagePool;
+struct ImageStats imageStats;
 
 // djb2 string hashing algorithm, using xor instead of addition.
 // uint32_t overflow are well-defined as result of modulus of 2^32
@@ -34,17 +88,332 @@ uint32_t _Hash_String(const char *str) {
     return hash;
 }
 
+//---------------------------------------------------------
+// IMAGE POOL
+//---------------------------------------------------------
+
+static ImageHandle _Make_Handle(uint32_t index) {
+    return imagePool.images[index].generation << IMAGEMANAGER_INDEX_BITS |
+           index;
+}
+
+// Returns NULL for handles whose image has been unloaded, without touching
+// anything but the slot itself.
+static struct ImageData *_Get_Image(ImageHandle handle) {
+    uint32_t index = handle & IMAGEMANAGER_INDEX_MASK;
+    uint32_t generation = handle >> IMAGEMANAGER_INDEX_BITS;
+
+    if (index >= imagePool.used ||
+        imagePool.images[index].generation != generation ||
+        imagePool.images[index].refCount == 0) {
+        return NULL;
+    }
+
+    return &imagePool.images[index];
+}
+
+// Returns the handle of the loaded image with this name, or 0.
+static ImageHandle _Find_Image(const char *imageName) {
+    uint32_t hash = _Hash_String(imageName);
+
+    for (uint32_t i = 0; i < imagePool.used; i++) {
+        if (imagePool.images[i].refCount > 0 &&
+            imagePool.images[i].hash == hash) {
+            return _Make_Handle(i);
+        }
+    }
+
+    return 0;
+}
+
+static uint32_t _Allocate_Slot(void) {
+    if (imagePool.freeHead != IMAGEMANAGER_NO_FREE_SLOT) {
+        uint32_t index = imagePool.freeHead;
+        imagePool.freeHead = imagePool.images[index].nextFree;
+        return index;
+    }
+
+    if (imagePool.used == imagePool.capacity) {
+        uint32_t capacity = imagePool.capacity == 0
+                                ? IMAGEMANAGER_INITIAL_CAPACITY
+                                : imagePool.capacity * 2;
+
+        if (capacity > IMAGEMANAGER_INDEX_MASK + 1) {
+            return IMAGEMANAGER_NO_FREE_SLOT;
+        }
+
+        struct ImageData *images =
+            realloc(imagePool.images, capacity * sizeof(struct ImageData));
+
+        if (images == NULL) {
+            return IMAGEMANAGER_NO_FREE_SLOT;
+        }
+
+        imagePool.images = images;
+        imagePool.capacity = capacity;
+    }
+
+    imagePool.images[imagePool.used].generation = 0;
+
+    return imagePool.used++;
+}
+
+static void _Release_Slot(uint32_t index) {
+    struct ImageData *imageData = &imagePool.images[index];
+
+    // Wrapping around would let a handle kept from long ago match again, so a
+    // slot whose generation runs out is retired instead of reused. That takes
+    // thousands of loads of the same slot, and the pool simply grows past it.
+    imageData->generation++;
+
+    if (imageData->generation == IMAGEMANAGER_GENERATION_MASK) {
+        return;
+    }
+
+    imageData->nextFree = imagePool.freeHead;
+    imagePool.freeHead = index;
+}
+
+//---------------------------------------------------------
+// TEXTURE FORMAT
+//---------------------------------------------------------
+
+static size_t *_Stats_Bytes_For_Format(int format) {
+    switch (format) {
+        case PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA:
+            return &imageStats.grayAlphaBytes;
+        case PIXELFORMAT_UNCOMPRESSED_R5G6B5:
+            return &imageStats.rgb565Bytes;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8:
+            return &imageStats.rgb8Bytes;
+        case PIXELFORMAT_UNCOMPRESSED_R8G8B8A8:
+            return &imageStats.rgba8Bytes;
+        default:
+            return &imageStats.otherBytes;
+    }
+}
+
+static Texture2D _Upload_Texture(Image image) {
+    Texture2D texture = LoadTextureFromImage(image);
+
+    if (texture.id != 0) {
+        *_Stats_Bytes_For_Format(texture.format) +=
+            GetPixelDataSize(texture.width, texture.height, texture.format);
+        imageStats.textureCount++;
+    }
+
+    return texture;
+}
+
+static void _Unload_Texture(Texture2D texture) {
+    if (texture.id == 0) {
+        return;
+    }
+
+    *_Stats_Bytes_For_Format(texture.format) -=
+        GetPixelDataSize(texture.width, texture.height, texture.format);
+    imageStats.textureCount--;
+
+    UnloadTexture(texture);
+}
+
+// Replaces a single-colour image with white GRAY_ALPHA pixels, keeping only
+// its alpha. The colour is applied back as tint when drawing.
+static void _To_White_Gray_Alpha(Image *image, Color *colors, int pixelCount) {
+    unsigned char *data = MemAlloc(pixelCount * 2);
+
+    for (int i = 0; i < pixelCount; i++) {
+        data[i * 2] = 255;
+        data[i * 2 + 1] = colors[i].a;
+    }
+
+    UnloadImage(*image);
+
+    image->data = data;
+    image->mipmaps = 1;
+    image->format = PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA;
+}
+
+/*
+    Picks the smallest uncompressed format that keeps the image intact. An
+    animation is analyzed as a whole, by looking at its frame strip as one
+    tall image, so every frame shares a format and can be streamed into the
+    same texture.
+*/
+static Color _Compact_Image(Image *image, int frameCount) {
+    Image strip = *image;
+    strip.height *= frameCount;
+
+    int pixelCount = strip.width * strip.height;
+    Color *colors = LoadImageColors(strip);
+
+    bool opaque = true;
+    bool singleColour = true;
+    Color colour = {0};
+    bool colourFound = false;
+
+    for (int i = 0; i < pixelCount && (opaque || singleColour); i++) {
+        if (colors[i].a != 255) {
+            opaque = false;
+        }
+
+        // fully transparent pixels have no visible colour
+        if (colors[i].a == 0) {
+            continue;
+        }
+
+        if (!colourFound) {
+            colour = colors[i];
+            colourFound = true;
+        } else if (colors[i].r != colour.r || colors[i].g != colour.g ||
+                   colors[i].b != colour.b) {
+            singleColour = false;
+        }
+    }
+
+    Color tint = WHITE;
+
+    if (singleColour && colourFound) {
+        _To_White_Gray_Alpha(&strip, colors, pixelCount);
+        tint = (Color){colour.r, colour.g, colour.b, 255};
+    } else if (opaque) {
+        ImageFormat(&strip, IMAGEMANAGER_OPAQUE_FORMAT);
+    } else {
+        ImageFormat(&strip, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+
+    UnloadImageColors(colors);
+
+    image->data = strip.data;
+    image->mipmaps = strip.mipmaps;
+    image->format = strip.format;
+
+    return tint;
+}
+
+//---------------------------------------------------------
+// ANIMATION FRAME RING
+//---------------------------------------------------------
+
+// Raylib keeps every frame of an animation back to back in image.data, each
+// one image.width * image.height pixels big. This returns a view into it,
+// which must not be unloaded.
+static Image _Frame_View(struct ImageData *imageData, int frame) {
+    Image image = imageData->image;
+    int frameSize = GetPixelDataSize(image.width, image.height, image.format);
+
+    return (Image){.data = (unsigned char *)image.data + frame * frameSize,
+                   .width = image.width,
+                   .height = image.height,
+                   .mipmaps = 1,
+                   .format = image.format};
+}
+
+static Image _Decode_Frame(struct ImageData *imageData, uint32_t tick) {
+    Image frame =
+        ImageCopy(_Frame_View(imageData, tick % imageData->frameCount));
+    ImageResize(
+        &frame, imageData->quantizedWidth, imageData->quantizedHeight
+    );
+
+    return frame;
+}
+
+static void _Ring_Reset(struct FrameRing *ring, uint32_t firstTick) {
+    for (uint32_t i = 0; i < ring->count; i++) {
+        UnloadImage(
+            ring->frames[(ring->firstTick + i) % IMAGEMANAGER_FRAME_RING_SIZE]
+        );
+    }
+
+    ring->firstTick = firstTick;
+    ring->count = 0;
+}
+
+// Decode ahead of playback until the ring is full. After the first fill this
+// is at most one frame per uploaded frame.
+static void _Ring_Fill(struct ImageData *imageData) {
+    struct FrameRing *ring = &imageData->ring;
+
+    while (ring->count < IMAGEMANAGER_FRAME_RING_SIZE) {
+        uint32_t tick = ring->firstTick + ring->count;
+        ring->frames[tick % IMAGEMANAGER_FRAME_RING_SIZE] =
+            _Decode_Frame(imageData, tick);
+        ring->count++;
+    }
+}
+
+// Drop every frame older than tick, then hand out the frame for tick. Ticks
+// that are not in the ring (first use, or playback skipped far ahead) restart
+// it there.
+static Image *_Ring_Take(struct ImageData *imageData, uint32_t tick) {
+    struct FrameRing *ring = &imageData->ring;
+
+    if (tick - ring->firstTick >= ring->count) {
+        _Ring_Reset(ring, tick);
+    }
+
+    while (ring->count > 0 && ring->firstTick != tick) {
+        UnloadImage(ring->frames[ring->firstTick % IMAGEMANAGER_FRAME_RING_SIZE]
+        );
+        ring->firstTick++;
+        ring->count--;
+    }
+
+    _Ring_Fill(imageData);
+
+    return &ring->frames[tick % IMAGEMANAGER_FRAME_RING_SIZE];
+}
+
+//---------------------------------------------------------
+// PUBLIC API
+//---------------------------------------------------------
+
 void ImageManager_Init(void) {
-    imageArray.endPtr = 0;
+    imagePool = (struct ImagePool){.freeHead = IMAGEMANAGER_NO_FREE_SLOT};
+    imageStats = (struct ImageStats){0};
 }
 
-Clay_Dimensions
-ImageManager_LoadImage(const char *filePath, const char *imageName) {
-    if (imageArray.endPtr == IMAGEMANAGER_MAX_LOADED_IMAGE) {
+static ImageHandle _Store_Image(
+    Image image, const char *imageName, int frameCount, float frameDelay
+) {
+    uint32_t index = _Allocate_Slot();
+
+    if (index == IMAGEMANAGER_NO_FREE_SLOT) {
         fprintf(
             stderr, "IMAGE: Failed to load image - out of allocated space.\n"
         );
-        return (Clay_Dimensions){0};
+        UnloadImage(image);
+        return 0;
+    }
+
+    Color tint = _Compact_Image(&image, frameCount);
+    uint32_t generation = imagePool.images[index].generation;
+
+    imagePool.images[index] =
+        (struct ImageData){.image = image,
+                           .tint = tint,
+                           .hash = _Hash_String(imageName),
+                           .quantizedWidth = 0,
+                           .quantizedHeight = 0,
+                           .cachedTexture = (Texture2D){.id = 0},
+                           .frameCount = frameCount,
+                           .frameDelay = frameDelay,
+                           .generation = generation == 0 ? 1 : generation,
+                           .refCount = 1};
+
+    return _Make_Handle(index);
+}
+
+// Loading a name that is already loaded returns the same handle and adds a
+// reference to it, every load must be matched by an ImageManager_UnloadImage.
+ImageHandle
+ImageManager_LoadImage(const char *filePath, const char *imageName) {
+    ImageHandle handle = _Find_Image(imageName);
+
+    if (handle != 0) {
+        _Get_Image(handle)->refCount++;
+        return handle;
     }
 
     Image image = LoadImage(filePath);
@@ -53,54 +422,216 @@ ImageManager_LoadImage(const char *filePath, const char *imageName) {
         fprintf(
             stderr, "IMAGE: invalid image - is %s a valid image?.\n", filePath
         );
-        return (Clay_Dimensions){0};
+        return 0;
     }
 
-    imageArray.images[imageArray.endPtr++] =
-        (struct ImageData){.image = image,
-                           .hash = _Hash_String(imageName),
-                           .quantizedWidth = 0,
-                           .quantizedHeight = 0,
-                           .cachedTexture = (Texture2D){.id = 0}};
+    return _Store_Image(image, imageName, 1, 0);
+}
+
+// frameDelay is the time in seconds each frame stays on screen, as raylib
+// does not hand out the per-frame delays stored in the GIF.
+ImageHandle ImageManager_LoadAnimatedImage(
+    const char *filePath, const char *imageName, float frameDelay
+) {
+    ImageHandle handle = _Find_Image(imageName);
+
+    if (handle != 0) {
+        _Get_Image(handle)->refCount++;
+        return handle;
+    }
+
+    int frameCount = 0;
+    Image image = LoadImageAnim(filePath, &frameCount);
+
+    if (!IsImageReady(image) || frameCount < 1) {
+        fprintf(
+            stderr, "IMAGE: invalid image - is %s a valid image?.\n", filePath
+        );
+        UnloadImage(image);
+        return 0;
+    }
 
-    return (Clay_Dimensions){image.width, image.height};
+    return _Store_Image(image, imageName, frameCount, frameDelay);
 }
 
-Texture2D
-ImageManager_GetTexture(const char *imageName, float width, float height) {
-    uint32_t hash = _Hash_String(imageName);
+// Insets are in source pixels and stay at that size whatever the element is
+// resized to, only the edges and center stretch.
+ImageHandle ImageManager_LoadNineSlice(
+    const char *filePath, const char *imageName, int left, int top, int right,
+    int bottom
+) {
+    ImageHandle handle = ImageManager_LoadImage(filePath, imageName);
+    struct ImageData *imageData = _Get_Image(handle);
+
+    // only configure freshly loaded images, not someone else's reference
+    if (imageData == NULL || imageData->refCount > 1) {
+        return handle;
+    }
 
-    for (int i = 0; i < imageArray.endPtr; i++) {
-        if (imageArray.images[i].hash == hash) {
-            struct ImageData *imageData = &imageArray.images[i];
+    imageData->isNineSlice = true;
+    imageData->nPatchInfo =
+        (NPatchInfo){.source = {0, 0, imageData->image.width,
+                                imageData->image.height},
+                     .left = left,
+                     .top = top,
+                     .right = right,
+                     .bottom = bottom,
+                     .layout = NPATCH_NINE_PATCH};
 
-            // Raylib resizing work with integer, so truncating would match the
-            // actual texture better. Can't do anything about that.
-            uint32_t w = (uint32_t)width;
-            uint32_t h = (uint32_t)height;
+    return handle;
+}
+
+// Returns false if the image does not exist or is not a nine-slice image, in
+// which case it should go through ImageManager_GetTexture instead.
+bool ImageManager_GetNineSlice(
+    ImageHandle handle, Texture2D *texture, NPatchInfo *nPatchInfo
+) {
+    struct ImageData *imageData = _Get_Image(handle);
 
-            if (w == imageData->quantizedWidth &&
-                h == imageData->quantizedHeight) {
-                return imageData->cachedTexture;
-            }
+    if (imageData == NULL || !imageData->isNineSlice) {
+        return false;
+    }
 
-            // cache invalidation
-            imageData->quantizedHeight = h;
-            imageData->quantizedWidth = w;
-            // safe, as uninitialized texture has id = 0
-            UnloadTexture(imageData->cachedTexture);
+    // uploaded lazily as the window may not exist yet at load time
+    if (imageData->cachedTexture.id == 0) {
+        imageData->cachedTexture = _Upload_Texture(imageData->image);
+    }
 
-            Image temp = ImageCopy(imageData->image);
-            ImageResize(&temp, width, height);
+    *texture = imageData->cachedTexture;
+    *nPatchInfo = imageData->nPatchInfo;
 
-            imageData->cachedTexture = LoadTextureFromImage(temp);
+    return true;
+}
 
-            UnloadImage(temp);
+// Meant to be called from a screen's act(dt), so every animated image runs on
+// its own clock and stops when the screen that owns it is not acting.
+void ImageManager_AdvanceAnimation(ImageHandle handle, float dt) {
+    struct ImageData *imageData = _Get_Image(handle);
 
-            return imageData->cachedTexture;
+    if (imageData == NULL || imageData->frameCount <= 1 ||
+        imageData->frameDelay <= 0) {
+        return;
+    }
+
+    imageData->frameTimer += dt;
+
+    while (imageData->frameTimer >= imageData->frameDelay) {
+        imageData->frameTimer -= imageData->frameDelay;
+        imageData->tick++;
+    }
+}
+
+/*
+    Animated images own a single texture at the quantized size. Changing frame
+    only streams the new pixels into it with UpdateTexture, the texture itself
+    is recreated only when the size changes, exactly like still images.
+*/
+static Texture2D _Get_Animated_Texture(struct ImageData *imageData) {
+    if (imageData->cachedTexture.id == 0) {
+        Image *frame = _Ring_Take(imageData, imageData->tick);
+
+        imageData->cachedTexture = _Upload_Texture(*frame);
+        imageData->uploadedTick = imageData->tick;
+
+        return imageData->cachedTexture;
+    }
+
+    if (imageData->uploadedTick != imageData->tick) {
+        Image *frame = _Ring_Take(imageData, imageData->tick);
+
+        UpdateTexture(imageData->cachedTexture, frame->data);
+        imageData->uploadedTick = imageData->tick;
+    }
+
+    return imageData->cachedTexture;
+}
+
+Texture2D
+ImageManager_GetTexture(ImageHandle handle, float width, float height) {
+    struct ImageData *imageData = _Get_Image(handle);
+
+    if (imageData == NULL) {
+        fprintf(stderr, "IMAGE: image handle %u is not loaded.\n", handle);
+        return (Texture){0};
+    }
+
+    // Raylib resizing work with integer, so truncating would match the
+    // actual texture better. Can't do anything about that.
+    uint32_t w = (uint32_t)width;
+    uint32_t h = (uint32_t)height;
+
+    if (w == imageData->quantizedWidth && h == imageData->quantizedHeight) {
+        if (imageData->frameCount > 1) {
+            return _Get_Animated_Texture(imageData);
         }
+
+        return imageData->cachedTexture;
+    }
+
+    // cache invalidation
+    imageData->quantizedHeight = h;
+    imageData->quantizedWidth = w;
+    // safe, as uninitialized texture has id = 0
+    _Unload_Texture(imageData->cachedTexture);
+    imageData->cachedTexture = (Texture2D){.id = 0};
+
+    if (imageData->frameCount > 1) {
+        // decoded frames are at the old size, throw them away
+        _Ring_Reset(&imageData->ring, imageData->tick);
+        return _Get_Animated_Texture(imageData);
     }
 
-    fprintf(stderr, "IMAGE: image %s not found.\n", imageName);
-    return (Texture){0};
+    Image temp = ImageCopy(imageData->image);
+    ImageResize(&temp, width, height);
+
+    imageData->cachedTexture = _Upload_Texture(temp);
+
+    UnloadImage(temp);
+
+    return imageData->cachedTexture;
+}
+
+Color ImageManager_GetTint(ImageHandle handle) {
+    struct ImageData *imageData = _Get_Image(handle);
+
+    if (imageData == NULL) {
+        return WHITE;
+    }
+
+    return imageData->tint;
+}
+
+Clay_Dimensions ImageManager_GetDimensions(ImageHandle handle) {
+    struct ImageData *imageData = _Get_Image(handle);
+
+    if (imageData == NULL) {
+        return (Clay_Dimensions){0};
+    }
+
+    return (Clay_Dimensions){imageData->image.width, imageData->image.height};
+}
+
+// Drops one reference. The last one frees the image, its texture and any
+// decoded frames, and makes every copy of the handle stale.
+void ImageManager_UnloadImage(ImageHandle handle) {
+    struct ImageData *imageData = _Get_Image(handle);
+
+    if (imageData == NULL) {
+        fprintf(stderr, "IMAGE: image handle %u is not loaded.\n", handle);
+        return;
+    }
+
+    if (--imageData->refCount > 0) {
+        return;
+    }
+
+    _Ring_Reset(&imageData->ring, 0);
+    _Unload_Texture(imageData->cachedTexture);
+    UnloadImage(imageData->image);
+
+    _Release_Slot(handle & IMAGEMANAGER_INDEX_MASK);
+}
+
+struct ImageStats ImageManager_GetStats(void) {
+    return imageStats;
 }
@@ -2,10 +2,35 @@
 #define __IMAGE_MANAGER_H__
 
 #include <raylib.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "clay.h"
 
+// 0 is never a valid handle, so a handle cast to void* can be passed to Clay as
+// imageData.
+typedef uint32_t ImageHandle;
+
+// Bytes of texture memory currently uploaded, per pixel format.
+struct ImageStats {
+    size_t grayAlphaBytes;
+    size_t rgb565Bytes;
+    size_t rgb8Bytes;
+    size_t rgba8Bytes;
+    size_t otherBytes;
+    size_t textureCount;
+};
+
 void ImageManager_Init(void);
-Clay_Dimensions ImageManager_LoadImage(const char* filePath, const char* imageName);
-Texture2D ImageManager_GetTexture(const char* imageName, float width, float height);
+ImageHandle ImageManager_LoadImage(const char* filePath, const char* imageName);
+ImageHandle ImageManager_LoadAnimatedImage(const char* filePath, const char* imageName, float frameDelay);
+ImageHandle ImageManager_LoadNineSlice(const char* filePath, const char* imageName, int left, int top, int right, int bottom);
+void ImageManager_UnloadImage(ImageHandle handle);
+Clay_Dimensions ImageManager_GetDimensions(ImageHandle handle);
+bool ImageManager_GetNineSlice(ImageHandle handle, Texture2D* texture, NPatchInfo* nPatchInfo);
+void ImageManager_AdvanceAnimation(ImageHandle handle, float dt);
+Texture2D ImageManager_GetTexture(ImageHandle handle, float width, float height);
+Color ImageManager_GetTint(ImageHandle handle);
+struct ImageStats ImageManager_GetStats(void);
 
 #endif
@@ -24,11 +24,20 @@ int main(int argc, char **argv) {
     mainScreen.init();
 
     while (!WindowShouldClose()) {
+        if (FontManager_Update()) {
+            Clay_ResetMeasureTextCache();
+        }
         screen.act(GetFrameTime());
 
+        Vector2 mousePosition = GetMousePosition();
+        Clay_SetPointerState((Clay_Vector2){mousePosition.x, mousePosition.y}, IsMouseButtonDown(MOUSE_BUTTON_LEFT));
+
         BeginDrawing();
         ClearBackground(WHITE);
         Renderer_Render(screen.layout());
         EndDrawing();
     }
+
+    screen.deinit();
+    FontManager_Shutdown();
 }
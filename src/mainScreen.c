@@ -1,13 +1,18 @@
 #include "mainScreen.h"
 #include "clay.h"
 #include "imageManager.h"
+#include <stdint.h>
 
-Clay_Dimensions pfp;
+ImageHandle pfp;
 
 void init(void) {
     pfp = ImageManager_LoadImage("image/pfp.png", "pfp");
 }
 
+void deinit(void) {
+    ImageManager_UnloadImage(pfp);
+}
+
 void act(float dt) {
     return;
 }
@@ -64,6 +69,17 @@ Clay_RenderCommandArray layout(void) {
                              .childAlignment = {.y = CLAY_ALIGN_Y_CENTER}},
                 .backgroundColor = COLOR_RED
             }) {
+                CLAY({
+                    .id = CLAY_ID("ProfilePicture"),
+                    .layout =
+                        {.sizing =
+                             {.width = CLAY_SIZING_FIXED(60),
+                              .height = CLAY_SIZING_FIXED(60)}},
+                    .cornerRadius = CLAY_CORNER_RADIUS(30),
+                    .image =
+                        {.imageData = (void *)(uintptr_t)pfp,
+                         .sourceDimensions = ImageManager_GetDimensions(pfp)}
+                }) {}
                 CLAY_TEXT(
                     CLAY_STRING("Clay - UI Library"),
                     CLAY_TEXT_CONFIG({
@@ -74,7 +90,11 @@ Clay_RenderCommandArray layout(void) {
 
             // Standard C code like loops etc work inside components
             for (int i = 0; i < 5; i++) {
-                SidebarItemComponent();
+                // The items read nothing that changes, so their input hash
+                // stays 0 and they are only declared once
+                CLAY_MEMO(CLAY_IDI("SidebarItem", i).id, 0) {
+                    SidebarItemComponent();
+                }
             }
 
             CLAY(
@@ -91,4 +111,6 @@ Clay_RenderCommandArray layout(void) {
     return Clay_EndLayout();
 }
 
-struct Screen mainScreen = {.init = init, .act = act, .layout = layout};
+struct Screen mainScreen = {
+    .init = init, .act = act, .layout = layout, .deinit = deinit
+};
@@ -3,23 +3,19 @@
 #include "imageManager.h"
 #include <math.h>
 #include <raylib.h>
+#include <rlgl.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+#define RENDERER_MAX_TEXT_PAGES 8
+
 //---------------------------------------------------------
 // HELPER FUNCTIONS
 //---------------------------------------------------------
 
-// the returning string must be free'd by the caller
-static char *_Clay_StringSlice_To_CString(Clay_StringSlice strSlice) {
-    char *cstring = malloc(strSlice.length + 1);
-    memcpy(cstring, strSlice.chars, strSlice.length);
-    cstring[strSlice.length] = '\0';
-
-    return cstring;
-}
-
 static Clay_Dimensions _Vector2_To_Clay_Dimensions(Vector2 vector2) {
     return (Clay_Dimensions){vector2.x, vector2.y};
 }
@@ -95,15 +91,30 @@ static void _Error_Handler(Clay_ErrorData errorText) {}
 static Clay_Dimensions _Measure_Text(
     Clay_StringSlice strSlice, Clay_TextElementConfig *config, void *usrData
 ) {
-    char *cStrSlice = _Clay_StringSlice_To_CString(strSlice);
-    Vector2 measurement = MeasureTextEx(
-        FontManager_GetFontByID(config->fontId), cStrSlice, config->fontSize,
+    Vector2 measurement = FontManager_MeasureText(
+        config->fontId, strSlice.chars, strSlice.length, config->fontSize,
         config->letterSpacing
     );
-    free(cStrSlice);
     return _Vector2_To_Clay_Dimensions(measurement);
 }
 
+// Clay hands over the words of a text element together, so the font size
+// variant is only resolved once for all of them.
+static void _Measure_Text_Batch(
+    Clay_StringSlice *words, Clay_Dimensions *dimensions, int32_t wordCount,
+    Clay_TextElementConfig *config, void *usrData
+) {
+    FontHandle font = FontManager_Resolve(config->fontId, config->fontSize);
+
+    for (int32_t i = 0; i < wordCount; i++) {
+        Vector2 measurement = FontManager_MeasureText(
+            font, words[i].chars, words[i].length, config->fontSize,
+            config->letterSpacing
+        );
+        dimensions[i] = _Vector2_To_Clay_Dimensions(measurement);
+    }
+}
+
 void Renderer_Init(uint32_t width, uint32_t height) {
     uint32_t capacity = Clay_MinMemorySize();
     Clay_Arena arena =
@@ -113,6 +124,9 @@ void Renderer_Init(uint32_t width, uint32_t height) {
         (Clay_ErrorHandler){_Error_Handler, NULL}
     );
     Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+    Clay_SetMeasureTextBatchFunction(_Measure_Text_Batch, NULL);
+    Clay_SetLazyTextWrappingEnabled(true);
+    Clay_SetIncrementalLayoutEnabled(true);
 }
 
 //---------------------------------------------------------
@@ -282,16 +296,478 @@ static void _Render_Border(Clay_RenderCommand *renderCommand) {
     );
 }
 
+//---------------------------------------------------------
+// TEXT BATCHING
+//---------------------------------------------------------
+
+/*
+    Text is not drawn right away. Glyph quads are queued per atlas texture and
+   sent to rlgl as one quad list per texture, instead of one DrawTexturePro
+   call per glyph.
+
+   Queued text is drawn late, so anything drawn before the flush must not
+   overlap it: every other command that overlaps queued text, or changes the
+   scissor, flushes the queue first. Text from different fonts overlapping
+   each other may swap order, which nothing should rely on.
+
+   Buffers are grown when needed and never freed, so a steady frame does not
+   allocate.
+
+   Distance field pages are drawn through a shader turning the distance in
+   alpha back into a sharp edge at whatever scale the glyphs are drawn.
+*/
+
+// Edge is at half of the alpha range, which is where raylib puts it when
+// generating SDF glyphs. Smoothing is one screen pixel wide at any scale.
+static const char *distanceFieldShaderCode =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main() {\n"
+    "    float dist = texture(texture0, fragTexCoord).a - 0.5;\n"
+    "    float change = length(vec2(dFdx(dist), dFdy(dist)));\n"
+    "    float alpha = smoothstep(-change, change, dist);\n"
+    "    finalColor = vec4(fragColor.rgb, fragColor.a * alpha) * colDiffuse;\n"
+    "}\n";
+
+struct DistanceFieldShader {
+    Shader shader;
+    bool loaded;
+};
+
+struct DistanceFieldShader distanceFieldShader;
+
+// Loaded on first use, as shaders need the window to exist.
+static bool _Load_Distance_Field_Shader(void) {
+    if (distanceFieldShader.loaded) {
+        return IsShaderReady(distanceFieldShader.shader);
+    }
+
+    distanceFieldShader.loaded = true;
+    distanceFieldShader.shader =
+        LoadShaderFromMemory(NULL, distanceFieldShaderCode);
+
+    if (!IsShaderReady(distanceFieldShader.shader)) {
+        fprintf(
+            stderr, "RENDERER: Failed to compile distance field shader - SDF "
+                    "text will look blurry.\n"
+        );
+        return false;
+    }
+
+    return true;
+}
+
+struct GlyphQuad {
+    float x, y, width, height;
+    float u0, v0, u1, v1;
+    Color color;
+};
+
+struct TextPage {
+    Texture2D texture;
+    bool distanceField;
+    struct GlyphQuad *quads;
+    int32_t quadCount;
+    int32_t quadCapacity;
+};
+
+struct TextBatch {
+    struct TextPage pages[RENDERER_MAX_TEXT_PAGES];
+    int32_t pageCount;
+    // bounding boxes of every queued text command, for overlap checks
+    Clay_BoundingBox *boxes;
+    int32_t boxCount;
+    int32_t boxCapacity;
+};
+
+struct TextBatch textBatch;
+
+static bool _Grow(void **array, int32_t *capacity, size_t itemSize) {
+    int32_t newCapacity = *capacity == 0 ? 256 : *capacity * 2;
+    void *newArray = realloc(*array, newCapacity * itemSize);
+
+    if (newArray == NULL) {
+        return false;
+    }
+
+    *array = newArray;
+    *capacity = newCapacity;
+
+    return true;
+}
+
+static void _Flush_Text(void) {
+    for (int32_t p = 0; p < textBatch.pageCount; p++) {
+        struct TextPage *page = &textBatch.pages[p];
+
+        if (page->quadCount == 0) {
+            continue;
+        }
+
+        bool useShader = page->distanceField && _Load_Distance_Field_Shader();
+
+        if (useShader) {
+            BeginShaderMode(distanceFieldShader.shader);
+        }
+
+        rlSetTexture(page->texture.id);
+        rlBegin(RL_QUADS);
+        rlNormal3f(0, 0, 1);
+
+        for (int32_t i = 0; i < page->quadCount; i++) {
+            struct GlyphQuad *quad = &page->quads[i];
+
+            rlColor4ub(
+                quad->color.r, quad->color.g, quad->color.b, quad->color.a
+            );
+            rlTexCoord2f(quad->u0, quad->v0);
+            rlVertex2f(quad->x, quad->y);
+            rlTexCoord2f(quad->u0, quad->v1);
+            rlVertex2f(quad->x, quad->y + quad->height);
+            rlTexCoord2f(quad->u1, quad->v1);
+            rlVertex2f(quad->x + quad->width, quad->y + quad->height);
+            rlTexCoord2f(quad->u1, quad->v0);
+            rlVertex2f(quad->x + quad->width, quad->y);
+        }
+
+        rlEnd();
+        rlSetTexture(0);
+
+        if (useShader) {
+            EndShaderMode();
+        }
+
+        page->quadCount = 0;
+    }
+
+    textBatch.pageCount = 0;
+    textBatch.boxCount = 0;
+}
+
+static bool _Overlaps(Clay_BoundingBox a, Clay_BoundingBox b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static void _Flush_Text_If_Overlapping(Clay_BoundingBox boundingBox) {
+    for (int32_t i = 0; i < textBatch.boxCount; i++) {
+        if (_Overlaps(textBatch.boxes[i], boundingBox)) {
+            _Flush_Text();
+            return;
+        }
+    }
+}
+
+static struct TextPage *_Get_Text_Page(Texture2D texture, bool distanceField) {
+    for (int32_t p = 0; p < textBatch.pageCount; p++) {
+        if (textBatch.pages[p].texture.id == texture.id) {
+            return &textBatch.pages[p];
+        }
+    }
+
+    if (textBatch.pageCount == RENDERER_MAX_TEXT_PAGES) {
+        _Flush_Text();
+    }
+
+    struct TextPage *page = &textBatch.pages[textBatch.pageCount++];
+    page->texture = texture;
+    page->distanceField = distanceField;
+
+    return page;
+}
+
+static void _Queue_Glyph(
+    struct TextPage *page, Rectangle source, Rectangle destination, Color color
+) {
+    if (page->quadCount == page->quadCapacity &&
+        !_Grow(
+            (void **)&page->quads, &page->quadCapacity,
+            sizeof(struct GlyphQuad)
+        )) {
+        // out of memory, fall back to raylib's own path for this glyph
+        DrawTexturePro(
+            page->texture, source, destination, (Vector2){0, 0}, 0, color
+        );
+        return;
+    }
+
+    float textureWidth = page->texture.width;
+    float textureHeight = page->texture.height;
+
+    page->quads[page->quadCount++] = (struct GlyphQuad){
+        .x = destination.x,
+        .y = destination.y,
+        .width = destination.width,
+        .height = destination.height,
+        .u0 = source.x / textureWidth,
+        .v0 = source.y / textureHeight,
+        .u1 = (source.x + source.width) / textureWidth,
+        .v1 = (source.y + source.height) / textureHeight,
+        .color = color
+    };
+}
+
+// Same output as DrawTextEx, but glyphs come out of FontManager's glyph cache,
+// the text is read in place and quads are queued instead of drawn.
 static void _Render_Text(Clay_RenderCommand *renderCommand) {
     Clay_TextRenderData renderData = renderCommand->renderData.text;
-    char *cStr = _Clay_StringSlice_To_CString(renderData.stringContents);
+    Clay_StringSlice text = renderData.stringContents;
     Color textColor = _Clay_To_Raylib_Color(renderData.textColor);
 
-    DrawTextEx(
-        FontManager_GetFontByID(renderData.fontId), cStr,
-        (Vector2){renderCommand->boundingBox.x, renderCommand->boundingBox.y},
-        renderData.fontSize, renderData.letterSpacing, textColor
+    // without its box the text cannot be ordered against later commands, so
+    // it is drawn right away
+    bool drawNow = textBatch.boxCount == textBatch.boxCapacity &&
+                   !_Grow(
+                       (void **)&textBatch.boxes, &textBatch.boxCapacity,
+                       sizeof(Clay_BoundingBox)
+                   );
+
+    if (!drawNow) {
+        textBatch.boxes[textBatch.boxCount++] = renderCommand->boundingBox;
+    }
+
+    FontHandle font =
+        FontManager_Resolve(renderData.fontId, renderData.fontSize);
+    float scale = (float)renderData.fontSize / FontManager_GetBaseSize(font);
+    float x = renderCommand->boundingBox.x;
+    float y = renderCommand->boundingBox.y;
+    struct TextPage *page = NULL;
+
+    for (int32_t i = 0; i < text.length;) {
+        int size;
+        struct Glyph glyph =
+            FontManager_NextGlyph(font, text.chars + i, text.length - i, &size);
+        bool blank = text.chars[i] == ' ' || text.chars[i] == '\t';
+        i += size;
+
+        if (!blank && glyph.texture.id != 0) {
+            // a flush empties the batch and hands its slots to other
+            // textures, so the page is only kept while it is still queued
+            if (page == NULL || page - textBatch.pages >= textBatch.pageCount ||
+                page->texture.id != glyph.texture.id) {
+                page = _Get_Text_Page(glyph.texture, glyph.distanceField);
+            }
+
+            Rectangle destination = {
+                x + glyph.offsetX * scale, y + glyph.offsetY * scale,
+                glyph.rect.width * scale, glyph.rect.height * scale
+            };
+
+            _Queue_Glyph(page, glyph.rect, destination, textColor);
+        }
+
+        x += glyph.advance * scale + renderData.letterSpacing;
+    }
+
+    if (drawNow) {
+        _Flush_Text();
+    }
+}
+
+/*
+    Rounded images are queued like text and drawn together at the end, or
+   when something overlapping them has to be drawn first, all under a single
+   shader pass. Nothing about an image is a uniform: the tint goes in the
+   vertex color, the size is read from the texture in the fragment shader, as
+   the quad always covers the whole texture, and the four radii are packed
+   into the vertex normal.
+
+   rlgl normalizes normals, so the radii are stored as the ratio of the
+   components to z: (topLeft * 256 + topRight, bottomRight * 256 + bottomLeft,
+   1). The vertex shader divides by z and unpacks them. Radii are rounded to
+   whole pixels and capped at 255, which is well past anything a UI uses.
+
+   Each image still has its own texture, so rlgl issues one draw call per
+   image, but the shader stays bound and no uniform is touched in between.
+*/
+static const char *roundedImageVertexShaderCode =
+    "#version 330\n"
+    "in vec3 vertexPosition;\n"
+    "in vec2 vertexTexCoord;\n"
+    "in vec3 vertexNormal;\n"
+    "in vec4 vertexColor;\n"
+    "uniform mat4 mvp;\n"
+    "out vec2 fragTexCoord;\n"
+    "out vec4 fragColor;\n"
+    "flat out vec4 fragRadius;\n"
+    "void main() {\n"
+    "    vec2 packed = floor(vertexNormal.xy / vertexNormal.z + 0.5);\n"
+    "    fragRadius = vec4(floor(packed.x / 256.0), mod(packed.x, 256.0),\n"
+    "                      floor(packed.y / 256.0), mod(packed.y, 256.0));\n"
+    "    fragTexCoord = vertexTexCoord;\n"
+    "    fragColor = vertexColor;\n"
+    "    gl_Position = mvp * vec4(vertexPosition, 1.0);\n"
+    "}\n";
+
+// Masks the image with a rounded box signed distance field. Texture
+// coordinates span the whole quad, so they double as the position inside the
+// image. Radii are in topLeft, topRight, bottomRight, bottomLeft order.
+static const char *roundedImageShaderCode =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec4 fragColor;\n"
+    "flat in vec4 fragRadius;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "out vec4 finalColor;\n"
+    "void main() {\n"
+    "    vec2 size = vec2(textureSize(texture0, 0));\n"
+    "    vec2 extent = size * 0.5;\n"
+    "    vec2 p = fragTexCoord * size - extent;\n"
+    "    float r = p.x > 0.0 ? (p.y > 0.0 ? fragRadius.z : fragRadius.y)\n"
+    "                        : (p.y > 0.0 ? fragRadius.w : fragRadius.x);\n"
+    "    vec2 q = abs(p) - extent + r;\n"
+    "    float dist = min(max(q.x, q.y), 0.0) + length(max(q, 0.0)) - r;\n"
+    "    finalColor = texture(texture0, fragTexCoord) * colDiffuse * "
+    "fragColor;\n"
+    "    finalColor.a *= clamp(0.5 - dist, 0.0, 1.0);\n"
+    "}\n";
+
+struct RoundedImageShader {
+    Shader shader;
+    bool loaded;
+};
+
+struct RoundedImageShader roundedImageShader;
+
+// Loaded on first use, as shaders need the window to exist.
+static bool _Load_Rounded_Image_Shader(void) {
+    if (roundedImageShader.loaded) {
+        return IsShaderReady(roundedImageShader.shader);
+    }
+
+    roundedImageShader.loaded = true;
+    roundedImageShader.shader = LoadShaderFromMemory(
+        roundedImageVertexShaderCode, roundedImageShaderCode
     );
+
+    if (!IsShaderReady(roundedImageShader.shader)) {
+        fprintf(
+            stderr, "RENDERER: Failed to compile rounded image shader - image "
+                    "corners will not be rounded.\n"
+        );
+        return false;
+    }
+
+    return true;
+}
+
+struct RoundedImage {
+    ImageHandle handle;
+    Texture2D texture;
+    // kept for overlap checks
+    Clay_BoundingBox boundingBox;
+    Color tint;
+    // topLeft, topRight, bottomRight, bottomLeft, in whole pixels
+    uint8_t radius[4];
+};
+
+struct RoundedImageBatch {
+    struct RoundedImage *images;
+    int32_t count;
+    int32_t capacity;
+};
+
+struct RoundedImageBatch roundedImageBatch;
+
+static void _Flush_Rounded_Images(void) {
+    if (roundedImageBatch.count == 0) {
+        return;
+    }
+
+    BeginShaderMode(roundedImageShader.shader);
+
+    for (int32_t i = 0; i < roundedImageBatch.count; i++) {
+        struct RoundedImage *image = &roundedImageBatch.images[i];
+        // DrawTexture truncates the position, so does this
+        float x = (int)image->boundingBox.x;
+        float y = (int)image->boundingBox.y;
+        float width = image->texture.width;
+        float height = image->texture.height;
+
+        rlSetTexture(image->texture.id);
+        rlBegin(RL_QUADS);
+        rlNormal3f(
+            image->radius[0] * 256.0f + image->radius[1],
+            image->radius[2] * 256.0f + image->radius[3], 1
+        );
+        rlColor4ub(image->tint.r, image->tint.g, image->tint.b, image->tint.a);
+        rlTexCoord2f(0, 0);
+        rlVertex2f(x, y);
+        rlTexCoord2f(0, 1);
+        rlVertex2f(x, y + height);
+        rlTexCoord2f(1, 1);
+        rlVertex2f(x + width, y + height);
+        rlTexCoord2f(1, 0);
+        rlVertex2f(x + width, y);
+        rlEnd();
+    }
+
+    rlSetTexture(0);
+    EndShaderMode();
+
+    roundedImageBatch.count = 0;
+}
+
+static void _Flush_Rounded_Images_If_Overlapping(Clay_BoundingBox boundingBox
+) {
+    for (int32_t i = 0; i < roundedImageBatch.count; i++) {
+        if (_Overlaps(roundedImageBatch.images[i].boundingBox, boundingBox)) {
+            _Flush_Rounded_Images();
+            return;
+        }
+    }
+}
+
+// ImageManager replaces an image's texture when it is asked for another size,
+// so the same image drawn twice at different sizes must not stay queued.
+static void _Flush_Rounded_Images_Using(ImageHandle handle) {
+    for (int32_t i = 0; i < roundedImageBatch.count; i++) {
+        if (roundedImageBatch.images[i].handle == handle) {
+            _Flush_Rounded_Images();
+            return;
+        }
+    }
+}
+
+static uint8_t _Pack_Radius(float radius, float maxRadius) {
+    return (uint8_t)fminf(roundf(fminf(radius, maxRadius)), 255);
+}
+
+static bool _Queue_Rounded_Image(
+    ImageHandle handle, Texture2D image, Clay_BoundingBox boundingBox,
+    Clay_CornerRadius radius, Color tint
+) {
+    if (roundedImageBatch.count == roundedImageBatch.capacity &&
+        !_Grow(
+            (void **)&roundedImageBatch.images, &roundedImageBatch.capacity,
+            sizeof(struct RoundedImage)
+        )) {
+        return false;
+    }
+
+    // the shader rounds the quad the texture is drawn on, which is the
+    // truncated size, not the bounding box
+    float maxRadius = fminf(image.width, image.height) / 2;
+
+    roundedImageBatch.images[roundedImageBatch.count++] = (struct RoundedImage){
+        .handle = handle,
+        .texture = image,
+        .boundingBox = boundingBox,
+        .tint = tint,
+        .radius = {
+            _Pack_Radius(radius.topLeft, maxRadius),
+            _Pack_Radius(radius.topRight, maxRadius),
+            _Pack_Radius(radius.bottomRight, maxRadius),
+            _Pack_Radius(radius.bottomLeft, maxRadius)
+        }
+    };
+
+    return true;
 }
 
 /*
@@ -316,9 +792,18 @@ static void _Render_Text(Clay_RenderCommand *renderCommand) {
    out, Raylib renders on integer, not float, so this perfectly match render
    result!
 
-   In this implementation, imageData voidPtr is pointing to a string lateral
-   having the name of the image. Corner radius is ignored as Raylib do not
-   support that kind of cropping.
+   In this implementation, imageData voidPtr carries the ImageHandle of the
+   image, as given by ImageManager.
+
+   Raylib does not support cropping to rounded corners, so images with a
+   corner radius are masked by a signed distance field in a fragment shader
+   instead. No extra texture or per-size masking on the CPU is needed, and
+   rounded images are batched under one shader pass, see above. Nine-slice
+   images ignore the radius, their texture coordinates do not span the quad.
+
+   Nine-slice images skip all of that: the texture is uploaded once at its
+   source size and DrawTextureNPatch stretches the edges and center on the
+   GPU, so resizing a skinned panel never touches the CPU copy.
 
    TODO: supporting atlas. Not going to be anytime soon as need to batch draw by
    Atlas, which I have no control of.
@@ -326,12 +811,49 @@ static void _Render_Text(Clay_RenderCommand *renderCommand) {
 static void _Render_Image(Clay_RenderCommand *renderCommand) {
     Clay_ImageRenderData renderData = renderCommand->renderData.image;
     Clay_BoundingBox boundingBox = renderCommand->boundingBox;
+    ImageHandle handle = (ImageHandle)(uintptr_t)renderData.imageData;
+    Color tint = ImageManager_GetTint(handle);
+    NPatchInfo nPatchInfo;
+    Texture2D image;
+
+    if (ImageManager_GetNineSlice(handle, &image, &nPatchInfo)) {
+        _Flush_Rounded_Images_If_Overlapping(boundingBox);
+        DrawTextureNPatch(
+            image, nPatchInfo,
+            (Rectangle){boundingBox.x, boundingBox.y, boundingBox.width,
+                        boundingBox.height},
+            (Vector2){0, 0}, 0, tint
+        );
+        return;
+    }
 
-    Texture2D image = ImageManager_GetTexture(
-        renderData.imageData, boundingBox.width, boundingBox.height
-    );
+    _Flush_Rounded_Images_Using(handle);
+    image = ImageManager_GetTexture(handle, boundingBox.width, boundingBox.height);
+
+    if (_Normalize_Corners(renderData.cornerRadius) == 0 ||
+        !_Load_Rounded_Image_Shader() ||
+        !_Queue_Rounded_Image(
+            handle, image, boundingBox, renderData.cornerRadius, tint
+        )) {
+        _Flush_Rounded_Images_If_Overlapping(boundingBox);
+        DrawTexture(image, boundingBox.x, boundingBox.y, tint);
+    }
+}
+
+/*
+    Queued text and queued rounded images never overlap each other: each
+   flushes the other when queued on top of it. So the two queues can be
+   flushed in any order, and anything drawn right away only has to flush the
+   queues it overlaps.
+*/
+static void _Flush(void) {
+    _Flush_Text();
+    _Flush_Rounded_Images();
+}
 
-    DrawTexture(image, boundingBox.x, boundingBox.y, WHITE);
+static void _Flush_If_Overlapping(Clay_BoundingBox boundingBox) {
+    _Flush_Text_If_Overlapping(boundingBox);
+    _Flush_Rounded_Images_If_Overlapping(boundingBox);
 }
 
 void Renderer_Render(Clay_RenderCommandArray renderCommands) {
@@ -345,22 +867,28 @@ void Renderer_Render(Clay_RenderCommandArray renderCommands) {
                 break;
 
             case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+                _Flush_If_Overlapping(renderCommand->boundingBox);
                 _Render_Rect(renderCommand);
                 break;
 
             case CLAY_RENDER_COMMAND_TYPE_BORDER:
+                _Flush_If_Overlapping(renderCommand->boundingBox);
                 _Render_Border(renderCommand);
                 break;
 
             case CLAY_RENDER_COMMAND_TYPE_TEXT:
+                _Flush_Rounded_Images_If_Overlapping(renderCommand->boundingBox
+                );
                 _Render_Text(renderCommand);
                 break;
 
             case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+                _Flush_Text_If_Overlapping(renderCommand->boundingBox);
                 _Render_Image(renderCommand);
                 break;
 
             case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+                _Flush();
                 BeginScissorMode(
                     renderCommand->boundingBox.x, renderCommand->boundingBox.y,
                     renderCommand->boundingBox.width,
@@ -369,8 +897,11 @@ void Renderer_Render(Clay_RenderCommandArray renderCommands) {
                 break;
 
             case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END:
+                _Flush();
                 EndScissorMode();
                 break;
         }
     }
+
+    _Flush();
 }
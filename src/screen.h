@@ -7,6 +7,8 @@ struct Screen {
     void (*init)(void);
     void (*act)(float dt);
     Clay_RenderCommandArray (*layout)(void);
+    // releases everything init loaded
+    void (*deinit)(void);
 };
 
 #endif
@@ -0,0 +1,324 @@
+// Clay__CompressChildrenAlongAxis and Clay__GrowChildrenAlongAxis replay the
+// steps of the loops that rescanned every child per step, which are embedded
+// here. Random children, many of them within 0.1 of each other, are resized
+// both ways and have to come out with exactly the same sizes. Also times a
+// long chain of near ties, where every step takes a single child.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#include <string.h>
+
+#define TEST_CASE_COUNT 20000
+#define TEST_MAX_CHILDREN 4000
+#define TEST_CHAIN_LENGTH 4000
+
+static struct LayoutFixture fixture = {.seed = 12345};
+
+static void _Remove_Swapback(int32_t *buffer, int32_t *length, int32_t child) {
+    for (int32_t i = 0; i < *length; i++) {
+        if (buffer[i] == child) {
+            buffer[i] = buffer[--*length];
+            return;
+        }
+    }
+}
+
+// The compress loop as it was, on plain arrays
+static void _Compress(
+    float *sizes, const float *minSizes, int32_t *buffer, int32_t length,
+    float totalSizeToDistribute, int32_t *largest
+) {
+    while (totalSizeToDistribute > 0.1) {
+        int32_t largestCount = 0;
+        float largestSize = 0;
+        float targetSize = 0;
+
+        for (int32_t i = 0; i < length; ++i) {
+            float childSize = sizes[buffer[i]];
+            if ((childSize - largestSize) < 0.1 &&
+                (childSize - largestSize) > -0.1) {
+                largest[largestCount++] = buffer[i];
+            } else if (childSize > largestSize) {
+                targetSize = largestSize;
+                largestSize = childSize;
+                largestCount = 0;
+                largest[largestCount++] = buffer[i];
+            } else if (childSize > targetSize) {
+                targetSize = childSize;
+            }
+        }
+
+        if (largestCount == 0) {
+            return;
+        }
+
+        targetSize = CLAY__MAX(
+                         targetSize,
+                         (largestSize * largestCount) - totalSizeToDistribute
+                     ) /
+                     largestCount;
+
+        for (int32_t i = 0; i < largestCount; i++) {
+            int32_t child = largest[i];
+            float oldSize = sizes[child];
+            sizes[child] = CLAY__MAX(minSizes[child], targetSize);
+            totalSizeToDistribute -= (oldSize - sizes[child]);
+            if (sizes[child] == minSizes[child]) {
+                _Remove_Swapback(buffer, &length, child);
+            }
+        }
+    }
+}
+
+// The grow loop as it was, on plain arrays
+static void _Grow(
+    float *sizes, const float *minSizes, const bool *grows, int32_t *buffer,
+    int32_t length, float sizeToDistribute, float growContainerContentSize,
+    int32_t growContainerCount
+) {
+    float targetSize = (sizeToDistribute + growContainerContentSize) /
+                       (float)growContainerCount;
+
+    for (int32_t i = 0; i < length; i++) {
+        int32_t child = buffer[i];
+        if (!grows[child]) {
+            continue;
+        }
+        if (targetSize < minSizes[child]) {
+            growContainerContentSize -= minSizes[child];
+            buffer[i] = buffer[--length];
+            growContainerCount--;
+            targetSize = (sizeToDistribute + growContainerContentSize) /
+                         (float)growContainerCount;
+            i = -1;
+            continue;
+        }
+        sizes[child] = targetSize;
+    }
+}
+
+// Sizes are drawn from a few levels with small offsets, so that many of them
+// chain into near ties, or spread out, or all equal
+static float _Random_Size(uint32_t kind) {
+    switch (kind) {
+        case 0:
+            return (float)(_Random(&fixture) % 5 * 10);
+        case 1:
+            return (float)(_Random(&fixture) % 1000) / 7.f;
+        case 2:
+            return 100 + (float)(_Random(&fixture) % 400) * 0.005f;
+        case 3:
+            return 50;
+        default:
+            return (float)(_Random(&fixture) % 4 * 5) +
+                   (float)(_Random(&fixture) % 8) * 0.03f;
+    }
+}
+
+static float _Random_Min_Size(float size) {
+    switch (_Random(&fixture) % 4) {
+        case 0:
+            return size;
+        case 1:
+            return 0;
+        default:
+            return size * (float)(_Random(&fixture) % 100) / 100.f;
+    }
+}
+
+// Gives the layout elements from 0 to count the sizes in sizes and minSizes,
+// and the buffer positions in order
+static Clay__int32_tArray _Set_Children(
+    Clay_Context *context, const float *sizes, const float *minSizes,
+    const int32_t *order, int32_t count
+) {
+    Clay__int32_tArray buffer = context->openLayoutElementStack;
+    buffer.length = count;
+
+    for (int32_t i = 0; i < count; i++) {
+        Clay_LayoutElement *element = &context->layoutElements.internalArray[i];
+        element->dimensions.width = sizes[i];
+        element->minDimensions.width = minSizes[i];
+        buffer.internalArray[i] = order[i];
+    }
+    context->layoutElements.length = count;
+
+    return buffer;
+}
+
+static bool _Same_Sizes(
+    Clay_Context *context, const float *sizes, int32_t count
+) {
+    for (int32_t i = 0; i < count; i++) {
+        float width = context->layoutElements.internalArray[i].dimensions.width;
+        if (memcmp(&width, &sizes[i], sizeof(float)) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(void) {
+    Clay_SetMaxElementCount(2 * TEST_MAX_CHILDREN);
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Context *context = Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){_Handle_Error, "compressChildren"}
+    );
+    Clay_SizingAxis *sizings = context->layoutElementSizing[0].internalArray;
+
+    float *sizes = malloc(TEST_MAX_CHILDREN * sizeof(float));
+    float *minSizes = malloc(TEST_MAX_CHILDREN * sizeof(float));
+    float *expected = malloc(TEST_MAX_CHILDREN * sizeof(float));
+    bool *grows = malloc(TEST_MAX_CHILDREN * sizeof(bool));
+    int32_t *order = malloc(TEST_MAX_CHILDREN * sizeof(int32_t));
+    int32_t *oldBuffer = malloc(TEST_MAX_CHILDREN * sizeof(int32_t));
+    int32_t *largest = malloc(TEST_MAX_CHILDREN * sizeof(int32_t));
+    int failures = 0;
+
+    for (int32_t testCase = 0; testCase < TEST_CASE_COUNT; testCase++) {
+        int32_t count =
+            1 + _Random(&fixture) % (testCase % 100 == 0 ? 2000 : 12);
+        uint32_t kind = _Random(&fixture) % 5;
+        float contentSize = 0;
+        float growContentSize = 0;
+        int32_t growCount = 0;
+
+        for (int32_t i = 0; i < count; i++) {
+            sizes[i] = _Random_Size(kind);
+            minSizes[i] = _Random_Min_Size(sizes[i]);
+            grows[i] = _Random(&fixture) % 4 != 0;
+            order[i] = i;
+            contentSize += sizes[i];
+            if (grows[i]) {
+                growContentSize += sizes[i];
+                growCount++;
+            }
+        }
+
+        for (int32_t i = count - 1; i > 0; i--) {
+            int32_t j = _Random(&fixture) % (i + 1);
+            int32_t swap = order[i];
+            order[i] = order[j];
+            order[j] = swap;
+        }
+
+        // Take away anything up to all of the content
+        float totalSizeToDistribute =
+            contentSize * (float)(_Random(&fixture) % 1001) / 1000.f + 0.05f;
+        memcpy(expected, sizes, count * sizeof(float));
+        memcpy(oldBuffer, order, count * sizeof(int32_t));
+        _Compress(
+            expected, minSizes, oldBuffer, count, totalSizeToDistribute, largest
+        );
+        Clay__CompressChildrenAlongAxis(
+            context, true, totalSizeToDistribute,
+            _Set_Children(context, sizes, minSizes, order, count),
+            context->resizeScratch
+        );
+
+        if (!_Same_Sizes(context, expected, count)) {
+            fprintf(
+                stderr,
+                "compressChildren: case %d, %d children compressed by %g "
+                "differ\n",
+                testCase, count, totalSizeToDistribute
+            );
+            failures++;
+        }
+
+        if (growCount == 0) {
+            continue;
+        }
+
+        for (int32_t i = 0; i < count; i++) {
+            sizings[i].type =
+                grows[i] ? CLAY__SIZING_TYPE_GROW : CLAY__SIZING_TYPE_FIT;
+            // Some minimums above the share, so that children drop out
+            minSizes[i] =
+                _Random(&fixture) % 3 == 0 ? sizes[i] * 2 : minSizes[i];
+        }
+
+        float sizeToDistribute =
+            contentSize * (float)(_Random(&fixture) % 200) / 100.f;
+        memcpy(expected, sizes, count * sizeof(float));
+        memcpy(oldBuffer, order, count * sizeof(int32_t));
+        _Grow(
+            expected, minSizes, grows, oldBuffer, count, sizeToDistribute,
+            growContentSize, growCount
+        );
+        Clay__GrowChildrenAlongAxis(
+            context, true, sizeToDistribute, growContentSize, growCount,
+            _Set_Children(context, sizes, minSizes, order, count),
+            context->resizeScratch
+        );
+
+        if (!_Same_Sizes(context, expected, count)) {
+            fprintf(
+                stderr,
+                "compressChildren: case %d, %d children grown by %g differ\n",
+                testCase, count, sizeToDistribute
+            );
+            failures++;
+        }
+    }
+
+    // Children 0.005 apart with no minimum, in buffer order
+    for (int32_t i = 0; i < TEST_CHAIN_LENGTH; i++) {
+        sizes[i] = 100 + i * 0.005f;
+        minSizes[i] = 0;
+        order[i] = i;
+    }
+
+    float totalSizeToDistribute = 200000;
+    memcpy(expected, sizes, TEST_CHAIN_LENGTH * sizeof(float));
+    memcpy(oldBuffer, order, TEST_CHAIN_LENGTH * sizeof(int32_t));
+    double start = _Now();
+    _Compress(
+        expected, minSizes, oldBuffer, TEST_CHAIN_LENGTH, totalSizeToDistribute,
+        largest
+    );
+    double middle = _Now();
+    Clay__int32_tArray buffer =
+        _Set_Children(context, sizes, minSizes, order, TEST_CHAIN_LENGTH);
+    double compressStart = _Now();
+    Clay__CompressChildrenAlongAxis(
+        context, true, totalSizeToDistribute, buffer, context->resizeScratch
+    );
+    double end = _Now();
+
+    if (!_Same_Sizes(context, expected, TEST_CHAIN_LENGTH)) {
+        fprintf(stderr, "compressChildren: near tie chain differs\n");
+        failures++;
+    }
+
+    printf(
+        "compressChildren: %d cases, %s\n", TEST_CASE_COUNT,
+        failures == 0 ? "ok" : "FAILED"
+    );
+    printf(
+        "  %d near ties, rescanning %8.3f ms, Clay__CompressChildrenAlongAxis "
+        "%8.3f ms\n",
+        TEST_CHAIN_LENGTH, (middle - start) * 1e3, (end - compressStart) * 1e3
+    );
+
+    free(largest);
+    free(oldBuffer);
+    free(order);
+    free(grows);
+    free(expected);
+    free(minSizes);
+    free(sizes);
+    free(arena.memory);
+
+    return failures == 0 ? 0 : 1;
+}
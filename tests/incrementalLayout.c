@@ -0,0 +1,325 @@
+// With incremental layout, a parent whose subtree and inputs are the same as
+// when it was last sized hands its children last layout's sizes. Two contexts
+// lay out the same frames, one with incremental layout, and both have to draw
+// the same. Trees repeat for a few frames at a time, while the layout is
+// resized, and a panel's gap, padding, texts and children change now and
+// then, so that some parents are sized again and others are not. On odd
+// frames, every element's fingerprint is made to match its last one, as if
+// they all collided, which leaves it to the checks of what sizing read. Rows
+// that flip one of those things at a time on odd frames make each check count.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#define TEST_FRAME_COUNT 200
+#define TEST_ELEMENT_COUNT 600
+#define TEST_PANEL_ITEM_COUNT 12
+
+static Clay_Context *_Create_Context(uint32_t memorySize) {
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Context *context = Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){_Handle_Error, "incrementalLayout"}
+    );
+    Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+
+    return context;
+}
+
+// Items of every sizing type, where one item at a time changes its text or
+// sizing, and every 35 frames the last item is left out
+static void _Declare_Panel(int32_t frame) {
+    CLAY({
+        .id = CLAY_ID("Panel"),
+        .layout =
+            {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0)},
+             .padding = CLAY_PADDING_ALL((uint16_t)(frame / 40 % 2 * 6)),
+             .childGap = (uint16_t)(frame / 15 % 3 * 4)},
+        .scroll = {.horizontal = frame / 50 % 2 == 1},
+    }) {
+        int32_t itemCount = TEST_PANEL_ITEM_COUNT - (frame + 3) / 35 % 2;
+        for (int32_t i = 0; i < itemCount; i++) {
+            int32_t change = i == frame / 6 % TEST_PANEL_ITEM_COUNT
+                                 ? frame / 6 % 4
+                                 : 0;
+            Clay_SizingAxis sizings[] = {
+                CLAY_SIZING_GROW(0), CLAY_SIZING_FIT(0),
+                CLAY_SIZING_PERCENT(0.05f), CLAY_SIZING_FIXED(40),
+                CLAY_SIZING_GROW(20, 60)
+            };
+            CLAY({
+                .id = CLAY_IDI("PanelItem", i),
+                .layout =
+                    {.sizing = {sizings[(i + change) % 5]},
+                     .layoutDirection = CLAY_TOP_TO_BOTTOM},
+            }) {
+                Clay_String text = {
+                    .length = 10 + (i * 7 + change * 5) % 30,
+                    .chars = layoutFixtureWords + i * 3
+                };
+                CLAY_TEXT(text, CLAY_TEXT_CONFIG({.fontSize = 10}));
+            }
+        }
+    }
+}
+
+// A row whose first child is swapped for another and back, while its other
+// child changes width, so that the first child was last sized along with a
+// different sibling
+static void _Declare_Swap_Row(int32_t frame) {
+    int32_t phase = frame % 8;
+
+    CLAY({
+        .id = CLAY_ID("SwapRow"),
+        .layout = {.sizing = {CLAY_SIZING_FIXED(400), CLAY_SIZING_FIXED(20)}},
+    }) {
+        bool swapped = phase == 3 || phase == 4;
+        CLAY({
+            .id = swapped ? CLAY_ID("SwapB") : CLAY_ID("SwapA"),
+            .layout = {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}},
+            .backgroundColor = {200, 0, 0, 255},
+        }) {}
+        CLAY({
+            .id = CLAY_ID("SwapSibling"),
+            .layout =
+                {.sizing = {CLAY_SIZING_FIXED(phase < 3 ? 100 : 150)}},
+            .backgroundColor = {0, 200, 0, 255},
+        }) {}
+    }
+}
+
+static void _Declare_Box(Clay_ElementId id, Clay_Sizing sizing) {
+    CLAY({
+        .id = id,
+        .layout = {.sizing = sizing},
+        .backgroundColor = {0, 0, 200, 255},
+    }) {}
+}
+
+// Rows that each flip one thing sizing reads on odd frames, where
+// fingerprints match, keeping everything else the same
+static void _Declare_Flipping_Rows(int32_t frame) {
+    bool flip = (frame + 1) % 4 < 2;
+    Clay_Sizing grow = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)};
+    Clay_Sizing fixed = {CLAY_SIZING_FIXED(50), CLAY_SIZING_FIXED(10)};
+    Clay_Sizing small = {CLAY_SIZING_FIXED(0.1f), CLAY_SIZING_FIXED(10)};
+
+    CLAY({
+        .id = CLAY_ID("FlippingRows"),
+        .layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM},
+    }) {
+        // A child's sizing, with the same content
+        CLAY({.layout = {.sizing = {CLAY_SIZING_FIXED(200)}}}) {
+            _Declare_Box(CLAY_ID("FlipSizing"), (Clay_Sizing){
+                flip ? CLAY_SIZING_GROW(0) : CLAY_SIZING_FIT(0),
+                CLAY_SIZING_FIXED(10)
+            });
+            _Declare_Box(CLAY_ID("FlipSizingFixed"), fixed);
+        }
+        // Padding
+        CLAY({
+            .layout =
+                {.sizing = {CLAY_SIZING_FIXED(200)},
+                 .padding = {flip ? 10 : 0}},
+        }) {
+            _Declare_Box(CLAY_ID("FlipPaddingGrow"), grow);
+        }
+        // The direction children are laid out in
+        CLAY({
+            .layout =
+                {.sizing = {CLAY_SIZING_FIXED(200), CLAY_SIZING_FIXED(20)},
+                 .layoutDirection =
+                     flip ? CLAY_LEFT_TO_RIGHT : CLAY_TOP_TO_BOTTOM},
+        }) {
+            _Declare_Box(CLAY_ID("FlipDirectionGrow"), grow);
+            _Declare_Box(CLAY_ID("FlipDirectionFixed"), fixed);
+        }
+        // A child's minimum width, with the same width, as text is measured
+        // as wide at any font size while its minimum width is its font size
+        CLAY({.layout = {.sizing = {CLAY_SIZING_FIXED(60)}}}) {
+            CLAY({
+                .id = CLAY_ID("FlipMinimum"),
+                .backgroundColor = {0, 0, 200, 255},
+            }) {
+                CLAY_TEXT(
+                    CLAY_STRING("ab cd"),
+                    CLAY_TEXT_CONFIG({.fontSize = flip ? 10 : 14})
+                );
+            }
+            _Declare_Box(CLAY_ID("FlipMinimumFixed"), fixed);
+        }
+        // The order of children whose widths add up differently in floats
+        // depending on it, in a row narrow enough for that to show
+        CLAY({.layout = {.sizing = {CLAY_SIZING_FIXED(1)}}}) {
+            Clay_ElementId ids[] = {
+                CLAY_ID("FlipOrderA"), CLAY_ID("FlipOrderB"),
+                CLAY_ID("FlipOrderC")
+            };
+            for (int32_t i = 0; i < 3; i++) {
+                int32_t index = flip ? i : 2 - i;
+                _Declare_Box(ids[index], index == 2 ? (Clay_Sizing){
+                    CLAY_SIZING_FIXED(0.7f), CLAY_SIZING_FIXED(10)
+                } : small);
+            }
+            _Declare_Box(CLAY_ID("FlipOrderGrow"), grow);
+        }
+        // A last child left out
+        CLAY({
+            .layout =
+                {.sizing = {CLAY_SIZING_FIXED(200), CLAY_SIZING_FIXED(10)}},
+        }) {
+            _Declare_Box(CLAY_ID("FlipCountGrow"), grow);
+            if (flip) {
+                _Declare_Box(CLAY_ID("FlipCountFixed"), fixed);
+            }
+        }
+        // Scrolling, with children too wide to fit
+        CLAY({
+            .layout = {.sizing = {CLAY_SIZING_FIXED(80)}},
+            .scroll = {.horizontal = flip},
+        }) {
+            _Declare_Box(CLAY_ID("FlipScrollFit"), (Clay_Sizing){
+                CLAY_SIZING_FIT(0), CLAY_SIZING_FIXED(10)
+            });
+            _Declare_Box(CLAY_ID("FlipScrollFixed"), fixed);
+            CLAY({
+                .id = CLAY_ID("FlipScrollText"),
+                .backgroundColor = {0, 0, 200, 255},
+            }) {
+                CLAY_TEXT(
+                    CLAY_STRING("lorem ipsum dolor"),
+                    CLAY_TEXT_CONFIG({.fontSize = 10})
+                );
+            }
+        }
+        // Children swapping rows of different widths
+        for (int32_t row = 0; row < 2; row++) {
+            CLAY({
+                .id = CLAY_IDI("FlipParent", row),
+                .layout =
+                    {.sizing = {CLAY_SIZING_FIXED(row == 0 ? 100 : 150)}},
+            }) {
+                _Declare_Box(
+                    (row == 0) == flip ? CLAY_ID("FlipParentA")
+                                       : CLAY_ID("FlipParentB"),
+                    grow
+                );
+            }
+        }
+        // A child that turns into an image, which is not grown along y, with
+        // no height to scale to so that it starts out as high either way
+        CLAY({
+            .layout =
+                {.sizing = {CLAY_SIZING_FIXED(100), CLAY_SIZING_FIXED(40)}},
+        }) {
+            CLAY({
+                .id = CLAY_ID("FlipImage"),
+                .layout = {.sizing = grow},
+                .backgroundColor = {0, 0, 200, 255},
+                .image =
+                    {.imageData = flip ? (void *)layoutFixtureWords : NULL,
+                     .sourceDimensions = {10, 0}},
+            }) {}
+        }
+    }
+}
+
+// Gives every element's hash map item the element's fingerprint
+static void _Match_Fingerprints(Clay_Context *context) {
+    for (int32_t i = 0; i < context->layoutElements.length; i++) {
+        Clay_LayoutElement *element = &context->layoutElements.internalArray[i];
+        Clay_LayoutElementHashMapItem *item = Clay__GetHashMapItem(element->id);
+        if (item->layoutElement == element) {
+            item->layoutFingerprint = element->fingerprint;
+        }
+    }
+}
+
+static Clay_RenderCommandArray
+_Lay_Out(Clay_Context *context, int32_t frame) {
+    Clay_SetCurrentContext(context);
+    Clay_SetLayoutDimensions(
+        (Clay_Dimensions){1000 - frame / 7 % 4 * 50, 800 - frame / 9 % 3 * 40}
+    );
+    Clay_BeginLayout();
+
+    CLAY({
+        .id = CLAY_ID("Top"),
+        .layout =
+            {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)},
+             .layoutDirection = CLAY_TOP_TO_BOTTOM},
+    }) {
+        _Declare_Panel(frame);
+        _Declare_Swap_Row(frame);
+        _Declare_Flipping_Rows(frame);
+        struct LayoutFixture fixture = {
+            .seed = frame / 10 % 3 + 1,
+            .budget = TEST_ELEMENT_COUNT,
+            .scrollBudget = 4,
+            .maxDepth = 5,
+            .maxChildren = 6,
+            .images = true,
+            .borders = true,
+            .floating = true,
+        };
+        _Declare_Layout(&fixture);
+        _Declare_Text_Samples(&fixture);
+    }
+
+    if (frame % 2 == 1) {
+        _Match_Fingerprints(context);
+    }
+    return Clay_EndLayout();
+}
+
+int main(void) {
+    Clay_SetMaxElementCount(4 * TEST_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 15);
+    // Once there is a current context, Clay_MinMemorySize() sizes the word
+    // cache from the element count instead
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Context *full = _Create_Context(memorySize);
+    Clay_Context *incremental = _Create_Context(memorySize);
+    Clay_SetIncrementalLayoutEnabled(true);
+
+    int32_t reusedCount = 0;
+    int32_t failures = 0;
+
+    for (int32_t frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        Clay_RenderCommandArray expected = _Lay_Out(full, frame);
+        Clay_RenderCommandArray commands = _Lay_Out(incremental, frame);
+        reusedCount += Clay_GetLayoutStats().elementsReused;
+
+        int32_t difference = _Compare_Render_Commands(expected, commands);
+        if (difference != -1) {
+            fprintf(
+                stderr,
+                "incrementalLayout: frame %d, render command %d of %d "
+                "differs\n",
+                frame, difference, commands.length
+            );
+            failures++;
+        }
+    }
+
+    if (reusedCount == 0) {
+        fprintf(stderr, "incrementalLayout: no sizes were reused\n");
+        failures++;
+    }
+
+    printf(
+        "incrementalLayout: %d frames, %d sizes reused, %s\n", TEST_FRAME_COUNT,
+        reusedCount, failures == 0 ? "ok" : "FAILED"
+    );
+
+    free(incremental->internalArena.memory);
+    free(full->internalArena.memory);
+
+    return failures == 0 ? 0 : 1;
+}
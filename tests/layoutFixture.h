@@ -0,0 +1,321 @@
+// Shared by the tests and benchmarks: a random number generator, a clock, an
+// error handler, a stand-in for text measurement, and random trees of
+// elements to lay out. Each file includes it after clay.h.
+// A fixture carries its own seed and counters, so threads can each generate
+// trees from their own.
+
+#ifndef LAYOUT_FIXTURE_H
+#define LAYOUT_FIXTURE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct LayoutFixture {
+    uint32_t seed;
+    // Elements left to declare, and scroll containers, as Clay keeps state
+    // for at most 10 of them
+    int32_t budget;
+    int32_t scrollBudget;
+    int32_t floatingCount;
+    int32_t maxDepth;
+    int32_t maxChildren;
+    // What trees hold besides containers and text. Floating elements attach
+    // to their parent or the root, and with floatingIds also to other
+    // floating elements declared before or after them, which Clay reports
+    // while declaring when they come later. With captures, some of them
+    // capture the pointer.
+    bool images;
+    bool borders;
+    bool floating;
+    bool floatingIds;
+    bool captures;
+};
+
+static const char layoutFixtureWords[] =
+    "lorem ipsum dolor sit amet consectetur adipiscing elit sed do eiusmod "
+    "tempor incididunt ut labore et dolore magna aliqua";
+
+static inline uint32_t _Random(struct LayoutFixture *fixture) {
+    fixture->seed = fixture->seed * 1664525 + 1013904223;
+    return fixture->seed >> 8;
+}
+
+static inline double _Now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+// Prints the error after the name passed as userData and exits, for files
+// where any error is a failure
+static inline void _Handle_Error(Clay_ErrorData error) {
+    fprintf(
+        stderr, "%s: %.*s\n", (const char *)error.userData,
+        error.errorText.length, error.errorText.chars
+    );
+    exit(1);
+}
+
+// Stands in for a font, with widths that vary by letter
+static inline Clay_Dimensions _Measure_Text(
+    Clay_StringSlice text, Clay_TextElementConfig *config, void *userData
+) {
+    float width = 0;
+
+    for (int32_t i = 0; i < text.length; i++) {
+        width += text.chars[i] % 5 + 3;
+    }
+
+    return (Clay_Dimensions){width, config->fontSize};
+}
+
+// Hashes the boxes, types and ids of commands into hash
+static inline uint64_t
+_Checksum(Clay_RenderCommandArray commands, uint64_t hash) {
+    for (int32_t i = 0; i < commands.length; i++) {
+        Clay_RenderCommand *command = &commands.internalArray[i];
+        const uint8_t *bytes = (const uint8_t *)&command->boundingBox;
+
+        for (size_t b = 0; b < sizeof(command->boundingBox); b++) {
+            hash = (hash ^ bytes[b]) * 1099511628211ULL;
+        }
+        hash = (hash ^ command->commandType) * 1099511628211ULL;
+        hash = (hash ^ command->id) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// Compares a field of the render data of commands a and b bit for bit
+#define LAYOUT_FIXTURE_SAME(field)                                             \
+    (memcmp(                                                                   \
+         &a->renderData.field, &b->renderData.field,                           \
+         sizeof(a->renderData.field)                                           \
+     ) == 0)
+
+// True when a and b draw exactly the same, down to the bits of their boxes and
+// the slice of text they point into
+static inline bool
+_Same_Render_Command(const Clay_RenderCommand *a, const Clay_RenderCommand *b) {
+    if (memcmp(&a->boundingBox, &b->boundingBox, sizeof(a->boundingBox)) != 0 ||
+        a->commandType != b->commandType || a->id != b->id ||
+        a->zIndex != b->zIndex || a->userData != b->userData) {
+        return false;
+    }
+
+    switch (a->commandType) {
+        case CLAY_RENDER_COMMAND_TYPE_RECTANGLE:
+            return LAYOUT_FIXTURE_SAME(rectangle);
+        case CLAY_RENDER_COMMAND_TYPE_BORDER:
+            return LAYOUT_FIXTURE_SAME(border.color) &&
+                   LAYOUT_FIXTURE_SAME(border.cornerRadius) &&
+                   LAYOUT_FIXTURE_SAME(border.width);
+        case CLAY_RENDER_COMMAND_TYPE_TEXT:
+            return LAYOUT_FIXTURE_SAME(text.stringContents.length) &&
+                   LAYOUT_FIXTURE_SAME(text.stringContents.chars) &&
+                   LAYOUT_FIXTURE_SAME(text.textColor) &&
+                   LAYOUT_FIXTURE_SAME(text.fontId) &&
+                   LAYOUT_FIXTURE_SAME(text.fontSize) &&
+                   LAYOUT_FIXTURE_SAME(text.letterSpacing) &&
+                   LAYOUT_FIXTURE_SAME(text.lineHeight);
+        case CLAY_RENDER_COMMAND_TYPE_IMAGE:
+            return LAYOUT_FIXTURE_SAME(image.backgroundColor) &&
+                   LAYOUT_FIXTURE_SAME(image.cornerRadius) &&
+                   LAYOUT_FIXTURE_SAME(image.sourceDimensions) &&
+                   LAYOUT_FIXTURE_SAME(image.imageData);
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_START:
+        case CLAY_RENDER_COMMAND_TYPE_SCISSOR_END:
+            return LAYOUT_FIXTURE_SAME(scroll);
+        default:
+            return true;
+    }
+}
+
+#undef LAYOUT_FIXTURE_SAME
+
+// Returns the index of the first command where a and b differ, or -1 when
+// they are the same
+static inline int32_t
+_Compare_Render_Commands(Clay_RenderCommandArray a, Clay_RenderCommandArray b) {
+    for (int32_t i = 0; i < a.length && i < b.length; i++) {
+        if (!_Same_Render_Command(&a.internalArray[i], &b.internalArray[i])) {
+            return i;
+        }
+    }
+
+    return a.length == b.length ? -1 : CLAY__MIN(a.length, b.length);
+}
+
+static inline Clay_SizingAxis _Random_Sizing(struct LayoutFixture *fixture) {
+    switch (_Random(fixture) % 5) {
+        case 0:
+            return CLAY_SIZING_FIXED(_Random(fixture) % 200);
+        case 1:
+            return CLAY_SIZING_GROW(0, _Random(fixture) % 2 ? 0 : 300);
+        case 2:
+            return CLAY_SIZING_PERCENT((_Random(fixture) % 50) / 100.f);
+        default:
+            return CLAY_SIZING_FIT(_Random(fixture) % 30);
+    }
+}
+
+static inline void _Declare_Floating(
+    struct LayoutFixture *fixture, Clay_ElementDeclaration *declaration
+) {
+    int32_t floatingIndex = fixture->floatingCount++;
+    uint32_t attachTo = _Random(fixture) % (fixture->floatingIds ? 4 : 2);
+
+    declaration->id = CLAY_IDI("Floating", floatingIndex);
+    declaration->floating = (Clay_FloatingElementConfig){
+        .offset = {_Random(fixture) % 50, _Random(fixture) % 50},
+        .zIndex = _Random(fixture) % 5,
+        .attachTo = attachTo == 0   ? CLAY_ATTACH_TO_PARENT
+                    : attachTo == 1 ? CLAY_ATTACH_TO_ROOT
+                                    : CLAY_ATTACH_TO_ELEMENT_WITH_ID
+    };
+
+    if (attachTo >= 2) {
+        declaration->floating.parentId =
+            CLAY_IDI("Floating", _Random(fixture) % (floatingIndex + 20)).id;
+    }
+
+    // Some grow to the size of what they attach to
+    if (_Random(fixture) % 2) {
+        declaration->layout.sizing.width = CLAY_SIZING_GROW(0);
+    }
+
+    if (_Random(fixture) % 2) {
+        declaration->layout.sizing.height = CLAY_SIZING_GROW(0);
+    }
+
+    if (fixture->captures) {
+        declaration->floating.pointerCaptureMode =
+            (Clay_PointerCaptureMode)(_Random(fixture) % 2);
+    }
+}
+
+// Containers with every sizing type, padding, gaps and both directions, and
+// text in every wrap mode
+static inline void
+_Declare_Tree(struct LayoutFixture *fixture, int32_t depth) {
+    int32_t childCount = depth >= fixture->maxDepth
+                             ? 0
+                             : 1 + _Random(fixture) % fixture->maxChildren;
+
+    for (int32_t i = 0; i < childCount && fixture->budget > 0; i++) {
+        fixture->budget--;
+        uint32_t kind = _Random(fixture) % 12;
+
+        if (kind < 3) {
+            // Stays within the 120 characters of layoutFixtureWords
+            int32_t offset = _Random(fixture) % 40;
+            Clay_String text = {
+                .length = 20 + _Random(fixture) % 60,
+                .chars = layoutFixtureWords + offset
+            };
+            CLAY_TEXT(
+                text, CLAY_TEXT_CONFIG(
+                          {.fontSize = 10,
+                           .wrapMode = (Clay_TextElementConfigWrapMode)(
+                               _Random(fixture) % 3
+                           )}
+                      )
+            );
+            continue;
+        }
+
+        Clay_ElementDeclaration declaration = {
+            .layout =
+                {.sizing = {_Random_Sizing(fixture), _Random_Sizing(fixture)},
+                 .padding = CLAY_PADDING_ALL(_Random(fixture) % 5),
+                 .childGap = _Random(fixture) % 6,
+                 .layoutDirection = _Random(fixture) % 2},
+            .backgroundColor = {200, 200, 200, 255},
+        };
+
+        if (kind == 3 && fixture->images) {
+            declaration.image = (Clay_ImageElementConfig){
+                .imageData = (void *)layoutFixtureWords,
+                .sourceDimensions =
+                    {10 + _Random(fixture) % 50, 10 + _Random(fixture) % 50}
+            };
+        } else if (kind == 4 && fixture->scrollBudget > 0) {
+            fixture->scrollBudget--;
+            declaration.scroll =
+                (Clay_ScrollElementConfig){.vertical = _Random(fixture) % 2};
+        } else if (kind == 5 && fixture->borders) {
+            declaration.border = (Clay_BorderElementConfig){
+                .color = {0, 0, 0, 255}, .width = CLAY_BORDER_ALL(1)
+            };
+        } else if (kind >= 9 && fixture->floating) {
+            _Declare_Floating(fixture, &declaration);
+        }
+
+        CLAY(declaration) { _Declare_Tree(fixture, depth + 1); }
+    }
+}
+
+// Text that is hard to break into lines: newlines, blank lines, runs of
+// spaces, and words wider than their container
+static const char *const layoutFixtureTexts[] = {
+    "first line\nsecond line that runs on for a while\n\nafter a blank line",
+    "  leading spaces and  double  spaces and a trailing one ",
+    "averyveryverylongwordwithoutanyspaces that then wraps normally",
+    "short",
+    "ends on a newline\n",
+    "a b c d e f g h i j k l m n o p q r s t u v w x y z",
+};
+
+// Each of layoutFixtureTexts in a container of random width, with random
+// wrapping, alignment and line height
+static inline void _Declare_Text_Samples(struct LayoutFixture *fixture) {
+    int32_t count =
+        sizeof(layoutFixtureTexts) / sizeof(layoutFixtureTexts[0]);
+
+    for (int32_t i = 0; i < count; i++) {
+        Clay_String text = {
+            .length = (int32_t)strlen(layoutFixtureTexts[i]),
+            .chars = layoutFixtureTexts[i]
+        };
+        CLAY({
+            .layout =
+                {.sizing = {CLAY_SIZING_FIXED(10 + _Random(fixture) % 300)}},
+        }) {
+            CLAY_TEXT(
+                text,
+                CLAY_TEXT_CONFIG(
+                    {.fontSize = 10,
+                     .lineHeight = _Random(fixture) % 2 ? 14 : 0,
+                     .wrapMode =
+                         (Clay_TextElementConfigWrapMode)(_Random(fixture) % 3),
+                     .textAlignment =
+                         (Clay_TextAlignment)(_Random(fixture) % 3)}
+                )
+            );
+        }
+    }
+}
+
+// A root filling the layout, with rows of random trees until the budget runs
+// out
+static inline void _Declare_Layout(struct LayoutFixture *fixture) {
+    fixture->floatingCount = 0;
+
+    CLAY({
+        .id = CLAY_ID("Root"),
+        .layout =
+            {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)},
+             .layoutDirection = CLAY_TOP_TO_BOTTOM},
+    }) {
+        while (fixture->budget > 0) {
+            CLAY({.layout = {.sizing = {CLAY_SIZING_GROW(0)}}}) {
+                _Declare_Tree(fixture, 0);
+            }
+        }
+    }
+}
+
+#endif
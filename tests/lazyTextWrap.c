@@ -0,0 +1,198 @@
+// Lazy text wrapping leaves text hidden last frame unwrapped, and wraps it
+// only once it shows. Two contexts lay out the same frames, one with lazy
+// wrapping, while a panel of text scrolls through view, text changes and the
+// layout is resized. Both have to draw the same, which leaves out of the
+// layout without lazy wrapping only the text lying wholly outside the scroll
+// container clipping it, which lazy wrapping never draws.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#define TEST_FRAME_COUNT 120
+#define TEST_ELEMENT_COUNT 600
+#define TEST_PANEL_ITEM_COUNT 40
+
+static Clay_Context *_Create_Context(uint32_t memorySize) {
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Context *context = Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){_Handle_Error, "lazyTextWrap"}
+    );
+    Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+
+    return context;
+}
+
+// The fixture's trees, beside a panel of text that scrolls a little further
+// every frame, where the text of an item and the panel's width change now and
+// then. The panel is shorter than the layout, so text it clips away is still
+// on screen.
+static Clay_RenderCommandArray
+_Lay_Out(Clay_Context *context, int32_t frame) {
+    Clay_SetCurrentContext(context);
+    Clay_SetLayoutDimensions(
+        (Clay_Dimensions){1000 - frame / 30 * 40, 800 - frame / 45 * 60}
+    );
+    Clay_BeginLayout();
+
+    struct LayoutFixture fixture = {
+        .seed = 1,
+        .budget = TEST_ELEMENT_COUNT,
+        .scrollBudget = 4,
+        .maxDepth = 5,
+        .maxChildren = 6,
+        .images = true,
+        .borders = true,
+        .floating = true,
+    };
+    _Declare_Layout(&fixture);
+
+    CLAY({
+        .id = CLAY_ID("Panel"),
+        .layout =
+            {.sizing =
+                 {CLAY_SIZING_FIXED(300 - (frame + 5) / 20 % 3 * 40),
+                  CLAY_SIZING_FIXED(300)},
+             .layoutDirection = CLAY_TOP_TO_BOTTOM,
+             .childGap = 4},
+        .scroll = {.vertical = true},
+    }) {
+        for (int32_t i = 0; i < TEST_PANEL_ITEM_COUNT; i++) {
+            Clay_String text = {
+                .length = 30 + i % 50, .chars = layoutFixtureWords + i * 7 % 40
+            };
+            // Every fifth item swaps between texts wider than the panel, which
+            // wrap to a different number of lines at the same width
+            if (i % 5 == 0) {
+                int32_t change = frame / 10;
+                text.length = change % 2 ? 110 : 60;
+                text.chars = layoutFixtureWords + change % 10;
+            }
+            CLAY_TEXT(text, CLAY_TEXT_CONFIG({.fontSize = 10}));
+        }
+        _Declare_Text_Samples(&fixture);
+    }
+
+    Clay_RenderCommandArray commands = Clay_EndLayout();
+    Clay_GetScrollContainerData(CLAY_ID("Panel")).scrollPosition->y =
+        -(float)(frame * 23 % 900);
+
+    return commands;
+}
+
+static int _Compare_Ids(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+// Keeps the commands of a layout without lazy wrapping that lazy wrapping
+// also draws, counting the text commands dropped. The lines of a text element
+// whose box lies wholly outside the scroll container clipping it are dropped,
+// found by the ids Clay gives them.
+static Clay_RenderCommandArray _Drop_Clipped_Text(
+    Clay_Context *context, Clay_RenderCommandArray commands,
+    Clay_RenderCommand *kept, uint32_t *droppedIds, int32_t *droppedCount
+) {
+    Clay_SetCurrentContext(context);
+    int32_t droppedIdCount = 0;
+
+    for (int32_t i = 0; i < context->textElementData.length; i++) {
+        Clay__TextElementData *data =
+            &context->textElementData.internalArray[i];
+        uint32_t id =
+            context->layoutElements.internalArray[data->elementIndex].id;
+        uint32_t clipId = (uint32_t)context->layoutElementClipElementIds
+                              .internalArray[data->elementIndex];
+        if (clipId == 0) {
+            continue;
+        }
+
+        Clay_BoundingBox box = Clay__GetHashMapItem(id)->boundingBox;
+        Clay_BoundingBox clip = Clay__GetHashMapItem(clipId)->boundingBox;
+        if (box.x > clip.x + clip.width || box.y > clip.y + clip.height ||
+            box.x + box.width < clip.x || box.y + box.height < clip.y) {
+            for (int32_t line = 0; line < data->wrappedLines.length; line++) {
+                droppedIds[droppedIdCount++] = Clay__HashNumber(line, id).id;
+            }
+        }
+    }
+    qsort(droppedIds, droppedIdCount, sizeof(uint32_t), _Compare_Ids);
+
+    Clay_RenderCommandArray result = {.internalArray = kept};
+    for (int32_t i = 0; i < commands.length; i++) {
+        Clay_RenderCommand *command = &commands.internalArray[i];
+        if (command->commandType == CLAY_RENDER_COMMAND_TYPE_TEXT &&
+            bsearch(
+                &command->id, droppedIds, droppedIdCount, sizeof(uint32_t),
+                _Compare_Ids
+            )) {
+            (*droppedCount)++;
+            continue;
+        }
+        result.internalArray[result.length++] = *command;
+    }
+
+    return result;
+}
+
+int main(void) {
+    Clay_SetMaxElementCount(4 * TEST_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 15);
+    // Once there is a current context, Clay_MinMemorySize() sizes the word
+    // cache from the element count instead
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Context *eager = _Create_Context(memorySize);
+    Clay_Context *lazy = _Create_Context(memorySize);
+    Clay_SetLazyTextWrappingEnabled(true);
+
+    Clay_RenderCommand *kept =
+        malloc(eager->renderCommands.capacity * sizeof(Clay_RenderCommand));
+    uint32_t *droppedIds =
+        malloc(eager->wrappedTextLines.capacity * sizeof(uint32_t));
+    int32_t droppedCount = 0;
+    int32_t deferredCount = 0;
+    int32_t failures = 0;
+
+    for (int32_t frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        Clay_RenderCommandArray expected = _Drop_Clipped_Text(
+            eager, _Lay_Out(eager, frame), kept, droppedIds, &droppedCount
+        );
+        Clay_RenderCommandArray commands = _Lay_Out(lazy, frame);
+        deferredCount += Clay_GetLayoutStats().textElementsWrapDeferred;
+
+        int32_t difference = _Compare_Render_Commands(expected, commands);
+        if (difference != -1) {
+            fprintf(
+                stderr,
+                "lazyTextWrap: frame %d, render command %d of %d differs\n",
+                frame, difference, commands.length
+            );
+            failures++;
+        }
+    }
+
+    if (droppedCount == 0 || deferredCount == 0) {
+        fprintf(stderr, "lazyTextWrap: no text was scrolled out of view\n");
+        failures++;
+    }
+
+    printf(
+        "lazyTextWrap: %d frames, %d wraps deferred, %s\n", TEST_FRAME_COUNT,
+        deferredCount, failures == 0 ? "ok" : "FAILED"
+    );
+
+    free(droppedIds);
+    free(kept);
+    free(lazy->internalArena.memory);
+    free(eager->internalArena.memory);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,169 @@
+// Clay_SetMeasureTextBatchFunction() measures the words of a text in batches,
+// where the measure function otherwise gets one call per word. Two contexts
+// lay out the same frames, one through a batch function that measures each
+// word as the measure function would, and both have to draw the same. Besides
+// the fixture's trees and text samples, long texts of runs of spaces and
+// newlines fill several batches each, and take turns, so that each of them is
+// measured once by both contexts.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#define TEST_FRAME_COUNT 60
+#define TEST_ELEMENT_COUNT 600
+#define TEST_LONG_TEXT_COUNT 4
+#define TEST_LONG_TEXT_LENGTH 4000
+#define TEST_LONG_TEXT_VARIANTS 6
+
+static char longText[TEST_LONG_TEXT_LENGTH];
+
+// Counts the words measured through it in the int32_t passed as userData
+static void _Measure_Text_Batch(
+    Clay_StringSlice *words, Clay_Dimensions *dimensions, int32_t wordCount,
+    Clay_TextElementConfig *config, void *userData
+) {
+    for (int32_t i = 0; i < wordCount; i++) {
+        dimensions[i] = _Measure_Text(words[i], config, NULL);
+    }
+    *(int32_t *)userData += wordCount;
+}
+
+static Clay_Context *_Create_Context(uint32_t memorySize) {
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Context *context = Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){_Handle_Error, "measureTextBatch"}
+    );
+    Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+
+    return context;
+}
+
+// Words of the fixture, now and then separated by a run of spaces or a
+// newline
+static void _Fill_Long_Text(void) {
+    struct LayoutFixture fixture = {.seed = 5};
+    int32_t length = 0;
+
+    while (length < TEST_LONG_TEXT_LENGTH) {
+        uint32_t start = _Random(&fixture) % 100;
+        uint32_t wordLength = 1 + _Random(&fixture) % 12;
+        for (uint32_t i = 0;
+             i < wordLength && length < TEST_LONG_TEXT_LENGTH; i++) {
+            char current = layoutFixtureWords[start + i];
+            longText[length++] = current == ' ' ? 'x' : current;
+        }
+
+        uint32_t separator = _Random(&fixture) % 10;
+        uint32_t spaceCount = separator == 0 ? 2 + _Random(&fixture) % 3 : 1;
+        for (uint32_t i = 0; i < spaceCount && length < TEST_LONG_TEXT_LENGTH;
+             i++) {
+            longText[length++] = separator == 1 ? '\n' : ' ';
+        }
+    }
+}
+
+// The fixture's trees, and long texts cut from one of a few parts of
+// longText
+static Clay_RenderCommandArray
+_Lay_Out(Clay_Context *context, int32_t frame) {
+    Clay_SetCurrentContext(context);
+    Clay_SetLayoutDimensions(
+        (Clay_Dimensions){1000 - frame % 4 * 60, 800 - frame % 3 * 50}
+    );
+    Clay_BeginLayout();
+
+    struct LayoutFixture fixture = {
+        .seed = frame % 3 + 1,
+        .budget = TEST_ELEMENT_COUNT,
+        .scrollBudget = 4,
+        .maxDepth = 5,
+        .maxChildren = 6,
+        .images = true,
+        .borders = true,
+        .floating = true,
+    };
+    _Declare_Layout(&fixture);
+
+    CLAY({
+        .id = CLAY_ID("LongTexts"),
+        .layout =
+            {.sizing = {CLAY_SIZING_FIXED(400)},
+             .layoutDirection = CLAY_TOP_TO_BOTTOM},
+    }) {
+        for (int32_t i = 0; i < TEST_LONG_TEXT_COUNT; i++) {
+            int32_t variant = frame % TEST_LONG_TEXT_VARIANTS;
+            Clay_String text = {
+                .length = 100 + (variant * 710 + i * 900) % 2800,
+                .chars = longText + (variant * 37 + i * 500) % 1000
+            };
+            CLAY_TEXT(
+                text, CLAY_TEXT_CONFIG(
+                          {.fontSize = 10 + i * 2,
+                           .wrapMode = (Clay_TextElementConfigWrapMode)(i % 2)}
+                      )
+            );
+        }
+        _Declare_Text_Samples(&fixture);
+    }
+
+    return Clay_EndLayout();
+}
+
+int main(void) {
+    _Fill_Long_Text();
+    Clay_SetMaxElementCount(4 * TEST_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 15);
+    // Once there is a current context, Clay_MinMemorySize() sizes the word
+    // cache from the element count instead
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Context *perWord = _Create_Context(memorySize);
+    Clay_Context *batched = _Create_Context(memorySize);
+
+    int32_t batchedWordCount = 0;
+    int32_t failures = 0;
+
+    for (int32_t frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        // The measure functions are shared by every context, so the batch
+        // function is only set while the batched context lays out
+        Clay_SetCurrentContext(perWord);
+        Clay_SetMeasureTextBatchFunction(NULL, NULL);
+        Clay_RenderCommandArray expected = _Lay_Out(perWord, frame);
+        Clay_SetCurrentContext(batched);
+        Clay_SetMeasureTextBatchFunction(
+            _Measure_Text_Batch, &batchedWordCount
+        );
+        Clay_RenderCommandArray commands = _Lay_Out(batched, frame);
+
+        int32_t difference = _Compare_Render_Commands(expected, commands);
+        if (difference != -1) {
+            fprintf(
+                stderr,
+                "measureTextBatch: frame %d, render command %d of %d differs\n",
+                frame, difference, commands.length
+            );
+            failures++;
+        }
+    }
+
+    if (batchedWordCount == 0) {
+        fprintf(stderr, "measureTextBatch: no word was measured in a batch\n");
+        failures++;
+    }
+
+    printf(
+        "measureTextBatch: %d frames, %d words measured in batches, %s\n",
+        TEST_FRAME_COUNT, batchedWordCount, failures == 0 ? "ok" : "FAILED"
+    );
+
+    free(batched->internalArena.memory);
+    free(perWord->internalArena.memory);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+// CLAY_MEMO() declares the elements its body declared last layout again when
+// its input is unchanged. Two contexts lay out the same frames, one with every
+// CLAY_MEMO() left out, and both have to draw the same. Cards memoize rows
+// inside them, and take their rows' inputs into their own. Rows change text
+// one at a time, cards move between columns, which are resized, and now and
+// then a block of memoized items takes more than there is room to record,
+// before or after the cards.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#define TEST_FRAME_COUNT 160
+#define TEST_MAX_ELEMENT_COUNT 1200
+#define TEST_CARD_COUNT 12
+#define TEST_ROW_COUNT 6
+// Three recorded declarations each, so that with the cards there are more
+// than TEST_MAX_ELEMENT_COUNT
+#define TEST_OVERFLOW_ITEM_COUNT 300
+
+static int32_t capacityErrorCount = 0;
+
+// Counts running out of room to record memos, which only makes memos run
+// their body again
+static void _Handle_Memo_Error(Clay_ErrorData error) {
+    if (error.errorType == CLAY_ERROR_TYPE_MEMO_CAPACITY_EXCEEDED) {
+        capacityErrorCount++;
+        return;
+    }
+    _Handle_Error(error);
+}
+
+static Clay_Context *
+_Create_Context(uint32_t memorySize, void (*handleError)(Clay_ErrorData)) {
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Context *context = Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){handleError, "memo"}
+    );
+    Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+
+    return context;
+}
+
+struct Row {
+    Clay_String text;
+    uint32_t hash;
+};
+
+// Each row changes its text every 40 frames, at a frame of its own
+static struct Row _Row(int32_t card, int32_t row, int32_t frame) {
+    int32_t version = (frame + card * 11 + row * 7) / 40;
+    int32_t offset = (card * 13 + row * 5 + version * 17) % 60;
+    int32_t length = 20 + (card + row * 3 + version * 7) % 40;
+
+    return (struct Row){
+        {.length = length, .chars = layoutFixtureWords + offset},
+        (uint32_t)(offset * 64 + length)
+    };
+}
+
+static void _Declare_Row(struct Row row) {
+    CLAY({
+        .layout = {.sizing = {CLAY_SIZING_GROW(0)}, .childGap = 4},
+        .backgroundColor = {40, 40, 40, 255},
+    }) {
+        CLAY_TEXT(row.text, CLAY_TEXT_CONFIG({.fontSize = 10}));
+        CLAY_TEXT(CLAY_STRING("more"), CLAY_TEXT_CONFIG({.fontSize = 8}));
+    }
+}
+
+// The card's id is local to its column, so a recording from the other column
+// declares it with the wrong id
+static void _Declare_Card(int32_t card, int32_t frame, bool memoize) {
+    CLAY({
+        .id = CLAY_IDI_LOCAL("Card", card),
+        .layout =
+            {.sizing = {CLAY_SIZING_GROW(0)},
+             .padding = CLAY_PADDING_ALL(4),
+             .layoutDirection = CLAY_TOP_TO_BOTTOM},
+        .backgroundColor = {20, 20, 20, 255},
+    }) {
+        CLAY_TEXT(CLAY_STRING("Card"), CLAY_TEXT_CONFIG({.fontSize = 12}));
+        for (int32_t i = 0; i < TEST_ROW_COUNT; i++) {
+            struct Row row = _Row(card, i, frame);
+            uint32_t key = CLAY_IDI("Row", card * TEST_ROW_COUNT + i).id;
+            if (memoize) {
+                CLAY_MEMO(key, row.hash) { _Declare_Row(row); }
+            } else {
+                _Declare_Row(row);
+            }
+        }
+    }
+}
+
+static void _Declare_Overflow_Item(void) {
+    CLAY({.layout = {.sizing = {CLAY_SIZING_FIXED(20)}}}) {
+        CLAY_TEXT(CLAY_STRING("x"), CLAY_TEXT_CONFIG({.fontSize = 10}));
+    }
+}
+
+static void _Declare_Overflow(bool memoize) {
+    CLAY({
+        .id = CLAY_ID("Overflow"),
+        .layout = {.layoutDirection = CLAY_TOP_TO_BOTTOM},
+    }) {
+        for (int32_t i = 0; i < TEST_OVERFLOW_ITEM_COUNT; i++) {
+            if (memoize) {
+                CLAY_MEMO(CLAY_IDI("OverflowItem", i).id, 0) {
+                    _Declare_Overflow_Item();
+                }
+            } else {
+                _Declare_Overflow_Item();
+            }
+        }
+    }
+}
+
+// Cards in two columns that are resized every few frames, and move to the
+// other column every 25 frames. For the last 5 of every 20 frames, the
+// overflowing block comes before or after the columns.
+static Clay_RenderCommandArray
+_Lay_Out(Clay_Context *context, int32_t frame, bool memoize) {
+    Clay_SetCurrentContext(context);
+    Clay_BeginLayout();
+    bool overflow = frame % 20 >= 15;
+
+    CLAY({
+        .id = CLAY_ID("Root"),
+        .layout =
+            {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)},
+             .childGap = 8},
+    }) {
+        if (overflow && frame / 20 % 2 == 0) {
+            _Declare_Overflow(memoize);
+        }
+
+        for (int32_t column = 0; column < 2; column++) {
+            CLAY({
+                .id = CLAY_IDI("Column", column),
+                .layout =
+                    {.sizing = {CLAY_SIZING_FIXED(
+                         (float)(200 + frame / 4 % 5 * 30 + column * 40)
+                     )},
+                     .childGap = (uint16_t)(frame / 10 % 3 * 4),
+                     .layoutDirection = CLAY_TOP_TO_BOTTOM},
+            }) {
+                for (int32_t card = 0; card < TEST_CARD_COUNT; card++) {
+                    if ((card + frame / 25) % 2 != column) {
+                        continue;
+                    }
+
+                    // What the card's body reads is its rows' inputs
+                    uint32_t hash = 0;
+                    for (int32_t row = 0; row < TEST_ROW_COUNT; row++) {
+                        hash = hash * 31 + _Row(card, row, frame).hash;
+                    }
+                    if (memoize) {
+                        CLAY_MEMO(CLAY_IDI("CardMemo", card).id, hash) {
+                            _Declare_Card(card, frame, true);
+                        }
+                    } else {
+                        _Declare_Card(card, frame, false);
+                    }
+                }
+            }
+        }
+
+        if (overflow && frame / 20 % 2 == 1) {
+            _Declare_Overflow(memoize);
+        }
+    }
+
+    return Clay_EndLayout();
+}
+
+int main(void) {
+    Clay_SetMaxElementCount(TEST_MAX_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 15);
+    // Once there is a current context, Clay_MinMemorySize() sizes the word
+    // cache from the element count instead
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Context *plain = _Create_Context(memorySize, _Handle_Error);
+    Clay_Context *memoized = _Create_Context(memorySize, _Handle_Memo_Error);
+
+    int32_t replayedCount = 0;
+    int32_t failures = 0;
+
+    for (int32_t frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        Clay_RenderCommandArray expected = _Lay_Out(plain, frame, false);
+        Clay_RenderCommandArray commands = _Lay_Out(memoized, frame, true);
+        replayedCount += Clay_GetLayoutStats().memosReplayed;
+
+        int32_t difference = _Compare_Render_Commands(expected, commands);
+        if (difference != -1) {
+            fprintf(
+                stderr, "memo: frame %d, render command %d of %d differs\n",
+                frame, difference, commands.length
+            );
+            failures++;
+        }
+    }
+
+    if (replayedCount == 0 || capacityErrorCount == 0) {
+        fprintf(
+            stderr, "memo: %d memos replayed, capacity ran out %d times\n",
+            replayedCount, capacityErrorCount
+        );
+        failures++;
+    }
+
+    printf(
+        "memo: %d frames, %d memos replayed, %s\n", TEST_FRAME_COUNT,
+        replayedCount, failures == 0 ? "ok" : "FAILED"
+    );
+
+    free(memoized->internalArena.memory);
+    free(plain->internalArena.memory);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+// Tree roots sized through Clay_SetParallelForFunction() have to come out the
+// same as when sized in order. Lays out random trees with many floating
+// elements, some growing to the size of other floating elements, in two
+// contexts, only one of them with a parallel for function bound. Their render
+// commands are compared every frame, with and without incremental layout.
+// CLAY_THREAD_LOCAL_CONTEXT leaves the worker threads without a current
+// context, so a task that needs one crashes the test, and errors reported from
+// a worker thread fail it.
+
+// pthreads
+#define _POSIX_C_SOURCE 200112L
+
+#define CLAY_THREAD_LOCAL_CONTEXT
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#include <pthread.h>
+
+#define TEST_WORKER_COUNT 4
+#define TEST_FRAME_COUNT 20
+#define TEST_ELEMENT_COUNT 5000
+#define TEST_MAX_DEPTH 5
+#define TEST_MAX_CHILDREN 6
+
+struct ParallelFor {
+    void (*task)(int32_t index, void *taskData);
+    void *taskData;
+    int32_t count;
+    int32_t next;
+    pthread_mutex_t mutex;
+};
+
+static int32_t parallelTaskCount;
+static pthread_t mainThread;
+static int32_t workerErrorCount;
+
+// Attaching to a floating element declared later in the layout is reported
+// while declaring, the same way in both contexts
+static void _Count_Error(Clay_ErrorData error) {
+    (*(int32_t *)error.userData)++;
+
+    if (!pthread_equal(pthread_self(), mainThread)) {
+        workerErrorCount++;
+    }
+}
+
+static void *_Run_Tasks(void *argument) {
+    struct ParallelFor *parallelFor = argument;
+
+    while (true) {
+        pthread_mutex_lock(&parallelFor->mutex);
+        int32_t index = parallelFor->next++;
+        pthread_mutex_unlock(&parallelFor->mutex);
+
+        if (index >= parallelFor->count) {
+            return NULL;
+        }
+
+        parallelFor->task(index, parallelFor->taskData);
+    }
+}
+
+static void _Parallel_For(
+    void (*task)(int32_t index, void *taskData), int32_t count,
+    void *taskData, void *userData
+) {
+    struct ParallelFor parallelFor = {
+        .task = task, .taskData = taskData, .count = count
+    };
+    pthread_t threads[TEST_WORKER_COUNT];
+
+    parallelTaskCount += count;
+    pthread_mutex_init(&parallelFor.mutex, NULL);
+
+    for (int32_t i = 0; i < TEST_WORKER_COUNT; i++) {
+        pthread_create(&threads[i], NULL, _Run_Tasks, &parallelFor);
+    }
+
+    for (int32_t i = 0; i < TEST_WORKER_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&parallelFor.mutex);
+}
+
+static uint64_t _Lay_Out(Clay_Context *context, uint32_t treeSeed) {
+    struct LayoutFixture fixture = {
+        .seed = treeSeed,
+        .budget = TEST_ELEMENT_COUNT,
+        .maxDepth = TEST_MAX_DEPTH,
+        .maxChildren = TEST_MAX_CHILDREN,
+        .floating = true,
+        .floatingIds = true,
+    };
+
+    Clay_SetCurrentContext(context);
+    Clay_BeginLayout();
+    _Declare_Layout(&fixture);
+
+    return _Checksum(Clay_EndLayout(), 14695981039346656037ULL);
+}
+
+static Clay_Context *
+_Create_Context(uint32_t memorySize, int32_t *errorCount) {
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+
+    return Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){_Count_Error, errorCount}
+    );
+}
+
+int main(void) {
+    int failures = 0;
+    int32_t inOrderErrorCount = 0;
+    int32_t parallelErrorCount = 0;
+
+    mainThread = pthread_self();
+    Clay_SetMaxElementCount(2 * TEST_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 17);
+    // Once there is a current context, Clay_MinMemorySize() sizes the word
+    // cache from its element count instead
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Context *inOrder = _Create_Context(memorySize, &inOrderErrorCount);
+    Clay_Context *parallel = _Create_Context(memorySize, &parallelErrorCount);
+    Clay_SetParallelForFunction(_Parallel_For, NULL);
+    Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+
+    for (int incremental = 0; incremental < 2; incremental++) {
+        Clay_SetCurrentContext(inOrder);
+        Clay_SetIncrementalLayoutEnabled(incremental);
+        Clay_SetCurrentContext(parallel);
+        Clay_SetIncrementalLayoutEnabled(incremental);
+
+        for (int32_t frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+            // Repeat trees now and then, so incremental layout reuses sizes
+            uint32_t treeSeed = frame % 7 + 1;
+
+            if (_Lay_Out(inOrder, treeSeed) != _Lay_Out(parallel, treeSeed)) {
+                fprintf(
+                    stderr,
+                    "parallelFor: frame %d differs%s when sized in "
+                    "parallel\n",
+                    frame, incremental ? " with incremental layout" : ""
+                );
+                failures++;
+            }
+        }
+    }
+
+    if (parallelTaskCount == 0) {
+        fprintf(stderr, "parallelFor: no tree roots were sized in parallel\n");
+        failures++;
+    }
+
+    if (inOrderErrorCount != parallelErrorCount) {
+        fprintf(
+            stderr, "parallelFor: %d errors in order, %d in parallel\n",
+            inOrderErrorCount, parallelErrorCount
+        );
+        failures++;
+    }
+
+    if (workerErrorCount > 0) {
+        fprintf(
+            stderr, "parallelFor: %d errors reported from worker threads\n",
+            workerErrorCount
+        );
+        failures++;
+    }
+
+    printf(
+        "parallelFor: %d frames, %d roots sized in parallel, %s\n",
+        2 * TEST_FRAME_COUNT, parallelTaskCount, failures == 0 ? "ok" : "FAILED"
+    );
+
+    free(inOrder->internalArena.memory);
+    free(parallel->internalArena.memory);
+
+    return failures == 0 ? 0 : 1;
+}
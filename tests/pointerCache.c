@@ -0,0 +1,196 @@
+// Clay_SetPointerState() keeps its last result while the pointer and what the
+// layout offers it stay the same. Every answer, cached or not, is checked
+// against a fresh query on the same layout, over random trees and over
+// layouts where only element ids, a floating root's pointer capture mode or
+// one box change from one frame to the next.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#define TEST_FRAME_COUNT 200
+#define TEST_ELEMENT_COUNT 500
+#define TEST_MAX_DEPTH 5
+#define TEST_MAX_CHILDREN 6
+#define TEST_POSITION_COUNT 4
+#define TEST_BUTTON_ROWS 8
+#define TEST_BUTTON_COUNT 12
+
+struct PointerResult {
+    uint64_t ids;
+    uint64_t items;
+    int32_t count;
+};
+
+// Hashes pointerOverIds, and the elements behind pointerOverItems, which are
+// the ones a cached result runs hover callbacks on
+static struct PointerResult _Pointer_Result(Clay_Context *context) {
+    struct PointerResult result = {
+        14695981039346656037ULL, 14695981039346656037ULL,
+        context->pointerOverIds.length
+    };
+
+    for (int32_t i = 0; i < context->pointerOverIds.length; i++) {
+        uint32_t id = context->pointerOverIds.internalArray[i].id;
+        result.ids = (result.ids ^ id) * 1099511628211ULL;
+    }
+
+    for (int32_t i = 0; i < context->pointerOverItems.length; i++) {
+        Clay_LayoutElementHashMapItem *item =
+            &context->layoutElementsHashMapInternal
+                 .internalArray[context->pointerOverItems.internalArray[i]];
+        result.items = (result.items ^ item->elementId.id) * 1099511628211ULL;
+    }
+
+    return result;
+}
+
+// Buttons tiling the layout, named from base, under a floating overlay half
+// as wide, moved right by offset, that captures the pointer or lets it through
+static void _Declare_Buttons(int32_t base, bool capture, float offset) {
+    CLAY({
+        .id = CLAY_ID("Root"),
+        .layout =
+            {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)},
+             .layoutDirection = CLAY_TOP_TO_BOTTOM},
+    }) {
+        for (int32_t row = 0; row < TEST_BUTTON_ROWS; row++) {
+            CLAY({
+                .layout =
+                    {.sizing = {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}},
+            }) {
+                for (int32_t i = 0; i < TEST_BUTTON_COUNT; i++) {
+                    CLAY({
+                        .id = CLAY_IDI(
+                            "Button", base + row * TEST_BUTTON_COUNT + i
+                        ),
+                        .layout =
+                            {.sizing =
+                                 {CLAY_SIZING_GROW(0), CLAY_SIZING_GROW(0)}},
+                    }) {}
+                }
+            }
+        }
+
+        CLAY({
+            .id = CLAY_ID("Overlay"),
+            .layout =
+                {.sizing = {CLAY_SIZING_FIXED(500), CLAY_SIZING_FIXED(800)}},
+            .floating =
+                {.offset = {offset, 0},
+                 .attachTo = CLAY_ATTACH_TO_PARENT,
+                 .pointerCaptureMode =
+                     capture ? CLAY_POINTER_CAPTURE_MODE_CAPTURE
+                             : CLAY_POINTER_CAPTURE_MODE_PASSTHROUGH},
+        }) {}
+    }
+}
+
+int main(void) {
+    // Element ids stay in the hash map, so it holds every tree
+    Clay_SetMaxElementCount(8 * TEST_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 15);
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Context *context = Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){_Handle_Error, "pointerCache"}
+    );
+    Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+
+    struct LayoutFixture positions = {.seed = 7};
+    Clay_Vector2 pointers[TEST_POSITION_COUNT];
+    for (int32_t i = 0; i < TEST_POSITION_COUNT; i++) {
+        pointers[i] = (Clay_Vector2){
+            _Random(&positions) % 1000, _Random(&positions) % 800
+        };
+    }
+    // Under the overlay and past it
+    pointers[0] = (Clay_Vector2){25, 20};
+    pointers[1] = (Clay_Vector2){750, 20};
+
+    int32_t position = 0;
+    int32_t cachedCount = 0;
+    int32_t failures = 0;
+
+    for (int32_t frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        // Trees repeat, so that the pointer result can be kept, and the
+        // layout is now and then resized under them
+        uint32_t variant = frame / 3 % 7;
+        Clay_SetLayoutDimensions(
+            (Clay_Dimensions){1000 - (frame / 40) * 10, 800}
+        );
+        Clay_BeginLayout();
+
+        if (variant < 3) {
+            struct LayoutFixture fixture = {
+                .seed = variant + 1,
+                .budget = TEST_ELEMENT_COUNT,
+                .scrollBudget = 4,
+                .maxDepth = TEST_MAX_DEPTH,
+                .maxChildren = TEST_MAX_CHILDREN,
+                .images = true,
+                .borders = true,
+                .floating = true,
+            };
+            _Declare_Layout(&fixture);
+        } else {
+            // The same boxes, with the overlay first letting the pointer
+            // through, then moved along, then the buttons renamed
+            _Declare_Buttons(
+                variant == 6 ? 1000 : 0, variant == 3, variant >= 5 ? 300 : 0
+            );
+        }
+        Clay_EndLayout();
+
+        // Starts where the last frame ended, which keeps the result when the
+        // layout stays the same
+        for (int32_t i = 0; i < TEST_POSITION_COUNT; i++, position++) {
+            Clay_Vector2 pointer = pointers[position % TEST_POSITION_COUNT];
+            bool cached =
+                context->pointerOverValid &&
+                context->pointerOverLayoutGeneration ==
+                    context->layoutGeneration &&
+                context->pointerOverPosition.x == pointer.x &&
+                context->pointerOverPosition.y == pointer.y;
+            cachedCount += cached;
+
+            Clay_SetPointerState(pointer, false);
+            struct PointerResult result = _Pointer_Result(context);
+            context->pointerOverValid = false;
+            Clay_SetPointerState(pointer, false);
+            struct PointerResult fresh = _Pointer_Result(context);
+
+            if (result.ids != fresh.ids || result.items != fresh.items ||
+                result.count != fresh.count) {
+                fprintf(
+                    stderr,
+                    "pointerCache: frame %d, %s result at (%g, %g) differs "
+                    "from a fresh query\n",
+                    frame, cached ? "cached" : "new", pointer.x, pointer.y
+                );
+                failures++;
+            }
+        }
+        position--;
+    }
+
+    if (cachedCount == 0) {
+        fprintf(stderr, "pointerCache: no pointer result was kept\n");
+        failures++;
+    }
+
+    printf(
+        "pointerCache: %d frames, %d results kept, %s\n", TEST_FRAME_COUNT,
+        cachedCount, failures == 0 ? "ok" : "FAILED"
+    );
+
+    free(arena.memory);
+
+    return failures == 0 ? 0 : 1;
+}
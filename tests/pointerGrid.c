@@ -0,0 +1,236 @@
+// Clay_SetPointerState() finds the elements under the pointer from a grid of
+// cells built after layout. The depth first scan over every root it replaced
+// is embedded here, and both have to report the same ids in the same order.
+// Trees hold overlapping floating roots over several zIndexes, some of them
+// capturing the pointer, and scroll containers scrolled so that children lie
+// outside their clip. The pointer is put at random, on cell boundaries and on
+// the corners of elements, which often span several cells.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#define TEST_FRAME_COUNT 60
+#define TEST_ELEMENT_COUNT 1000
+#define TEST_TREE_COUNT 4
+#define TEST_MAX_DEPTH 6
+#define TEST_MAX_CHILDREN 6
+#define TEST_QUERY_COUNT 400
+
+// The scan as it was, reading the boxes the hash map keeps, into ids
+static int32_t _Scan_Depth_First(
+    Clay_Context *context, Clay_Vector2 position, Clay_ElementId *ids,
+    int32_t *stack, bool *visited
+) {
+    int32_t idCount = 0;
+
+    for (int32_t rootIndex = context->layoutElementTreeRoots.length - 1;
+         rootIndex >= 0; --rootIndex) {
+        Clay__LayoutElementTreeRoot *root =
+            &context->layoutElementTreeRoots.internalArray[rootIndex];
+        int32_t stackLength = 1;
+        stack[0] = (int32_t)root->layoutElementIndex;
+        visited[0] = false;
+        bool found = false;
+
+        while (stackLength > 0) {
+            if (visited[stackLength - 1]) {
+                stackLength--;
+                continue;
+            }
+            visited[stackLength - 1] = true;
+            Clay_LayoutElement *element =
+                &context->layoutElements.internalArray[stack[stackLength - 1]];
+            Clay_LayoutElementHashMapItem *mapItem =
+                Clay__GetHashMapItem(element->id);
+            Clay_BoundingBox box = mapItem->boundingBox;
+            box.x -= root->pointerOffset.x;
+            box.y -= root->pointerOffset.y;
+
+            if (Clay__PointIsInsideRect(position, box)) {
+                ids[idCount++] = mapItem->elementId;
+                found = true;
+                if (mapItem->idAlias != 0) {
+                    ids[idCount++] = (Clay_ElementId){.id = mapItem->idAlias};
+                }
+            }
+
+            if (Clay__ElementHasConfig(
+                    element, CLAY__ELEMENT_CONFIG_TYPE_TEXT
+                )) {
+                stackLength--;
+                continue;
+            }
+
+            for (int32_t i = element->childrenOrTextContent.children.length - 1;
+                 i >= 0; --i) {
+                stack[stackLength] =
+                    element->childrenOrTextContent.children.elements[i];
+                visited[stackLength++] = false;
+            }
+        }
+
+        Clay_LayoutElement *rootElement =
+            &context->layoutElements.internalArray[root->layoutElementIndex];
+        if (found &&
+            Clay__ElementHasConfig(
+                rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING
+            ) &&
+            Clay__FindElementConfigWithType(
+                rootElement, CLAY__ELEMENT_CONFIG_TYPE_FLOATING
+            )
+                    .floatingElementConfig->pointerCaptureMode ==
+                CLAY_POINTER_CAPTURE_MODE_CAPTURE) {
+            break;
+        }
+    }
+
+    return idCount;
+}
+
+// Where scrolling handled outside Clay puts each scroll container
+static Clay_Vector2 _Query_Scroll_Offset(uint32_t elementId, void *userData) {
+    return (Clay_Vector2){-(float)(elementId % 200), -(float)(elementId % 170)};
+}
+
+static bool _Same_Ids(
+    Clay_Context *context, const Clay_ElementId *ids, int32_t idCount
+) {
+    if (context->pointerOverIds.length != idCount) {
+        return false;
+    }
+
+    for (int32_t i = 0; i < idCount; i++) {
+        if (context->pointerOverIds.internalArray[i].id != ids[i].id) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(void) {
+    // Element ids stay in the hash map, so it holds every tree
+    Clay_SetMaxElementCount(2 * TEST_TREE_COUNT * TEST_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 15);
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Context *context = Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){_Handle_Error, "pointerGrid"}
+    );
+    Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+    Clay_SetQueryScrollOffsetFunction(_Query_Scroll_Offset, NULL);
+
+    // Each element can be found with its alias
+    Clay_ElementId *ids =
+        malloc(4 * TEST_ELEMENT_COUNT * sizeof(Clay_ElementId));
+    int32_t *stack = malloc(2 * TEST_ELEMENT_COUNT * sizeof(int32_t));
+    bool *visited = malloc(2 * TEST_ELEMENT_COUNT * sizeof(bool));
+    struct LayoutFixture queries = {.seed = 99};
+    int32_t queryCount = 0;
+    int32_t hitCount = 0;
+    int32_t failures = 0;
+
+    for (int32_t frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        // A tree is laid out twice, the second time with its scroll
+        // containers scrolled, and now and then with scrolling handled
+        // outside Clay, which offsets the pointer per root instead
+        struct LayoutFixture fixture = {
+            .seed = frame / 2 % TEST_TREE_COUNT + 1,
+            .budget = TEST_ELEMENT_COUNT,
+            // Clay keeps the last tree's scroll containers until this one is
+            // laid out
+            .scrollBudget = 5,
+            .maxDepth = TEST_MAX_DEPTH,
+            .maxChildren = TEST_MAX_CHILDREN,
+            .images = true,
+            .borders = true,
+            .floating = true,
+            .captures = true,
+        };
+        Clay_SetExternalScrollHandlingEnabled(frame % 8 == 7);
+        Clay_SetLayoutDimensions(
+            (Clay_Dimensions){1000 - frame % 5 * 37, 800 - frame % 3 * 51}
+        );
+        Clay_BeginLayout();
+        _Declare_Layout(&fixture);
+        Clay_EndLayout();
+
+        for (int32_t i = 0; i < context->scrollContainerDatas.length; i++) {
+            context->scrollContainerDatas.internalArray[i].scrollPosition =
+                frame % 2 ? (Clay_Vector2){0, 0}
+                          : (Clay_Vector2){
+                                -(float)(_Random(&queries) % 300),
+                                -(float)(_Random(&queries) % 300)
+                            };
+        }
+
+        for (int32_t query = 0; query < TEST_QUERY_COUNT; query++) {
+            Clay_Vector2 position;
+            Clay__PointerGrid *grid = &context->pointerGrid;
+
+            if (query % 3 == 0 || !grid->built) {
+                // Anywhere, including off the layout
+                position = (Clay_Vector2){
+                    (float)(_Random(&queries) % 1200) - 100,
+                    (float)(_Random(&queries) % 1000) - 100
+                };
+            } else if (query % 3 == 1) {
+                // On the edges of cells
+                position = (Clay_Vector2){
+                    (float)(_Random(&queries) % grid->columns) /
+                        grid->inverseCellWidth,
+                    (float)(_Random(&queries) % grid->rows) /
+                        grid->inverseCellHeight
+                };
+            } else {
+                // On a corner of an element
+                int32_t index =
+                    _Random(&queries) % context->pointerGridEntries.length;
+                Clay_BoundingBox box =
+                    context->pointerGridEntries.internalArray[index]
+                        .boundingBox;
+                position = (Clay_Vector2){
+                    box.x + (_Random(&queries) % 2 ? box.width : 0),
+                    box.y + (_Random(&queries) % 2 ? box.height : 0)
+                };
+            }
+
+            context->pointerOverValid = false;
+            Clay_SetPointerState(position, false);
+            int32_t idCount =
+                _Scan_Depth_First(context, position, ids, stack, visited);
+            queryCount++;
+            hitCount += idCount;
+
+            if (!_Same_Ids(context, ids, idCount)) {
+                fprintf(
+                    stderr,
+                    "pointerGrid: frame %d, %d elements found at (%g, %g) "
+                    "where the scan found %d\n",
+                    frame, context->pointerOverIds.length, position.x,
+                    position.y, idCount
+                );
+                failures++;
+            }
+        }
+    }
+
+    printf(
+        "pointerGrid: %d queries, %d elements found, %s\n", queryCount,
+        hitCount, failures == 0 ? "ok" : "FAILED"
+    );
+
+    free(visited);
+    free(stack);
+    free(ids);
+    free(arena.memory);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,136 @@
+// With CLAY_THREAD_LOCAL_CONTEXT, separate contexts can be laid out on
+// separate threads at the same time. Lays out 8 contexts with different trees
+// and pointer positions, first one thread after another and then all at once,
+// and checks that the render commands and hovered elements come out the same.
+
+// pthreads
+#define _POSIX_C_SOURCE 200112L
+
+#define CLAY_THREAD_LOCAL_CONTEXT
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#include <pthread.h>
+
+#define TEST_CONTEXT_COUNT 8
+#define TEST_FRAME_COUNT 30
+#define TEST_ELEMENT_COUNT 3000
+#define TEST_MAX_DEPTH 6
+#define TEST_MAX_CHILDREN 6
+
+struct Worker {
+    int32_t id;
+    uint64_t hash;
+    int32_t errorCount;
+};
+
+static void _Hash(struct Worker *worker, const void *data, size_t size) {
+    const uint8_t *bytes = data;
+
+    for (size_t i = 0; i < size; i++) {
+        worker->hash = (worker->hash ^ bytes[i]) * 1099511628211ULL;
+    }
+}
+
+static void _Count_Error(Clay_ErrorData error) {
+    ((struct Worker *)error.userData)->errorCount++;
+}
+
+// Each worker sets up its own context, on whichever thread runs it
+static void *_Run_Worker(void *argument) {
+    struct Worker *worker = argument;
+
+    Clay_SetMaxElementCount(2 * TEST_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 17);
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Initialize(
+        arena, (Clay_Dimensions){800 + worker->id * 10, 600},
+        (Clay_ErrorHandler){_Count_Error, worker}
+    );
+    Clay_SetMeasureTextFunction(_Measure_Text, NULL);
+
+    worker->hash = 14695981039346656037ULL;
+
+    for (int32_t frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        struct LayoutFixture fixture = {
+            .seed = worker->id * 1000 + frame % 5,
+            .budget = TEST_ELEMENT_COUNT,
+            .maxDepth = TEST_MAX_DEPTH,
+            .maxChildren = TEST_MAX_CHILDREN,
+            .floating = true,
+        };
+
+        Clay_SetPointerState(
+            (Clay_Vector2){frame * 37 % 800, frame * 53 % 600}, false
+        );
+        Clay_BeginLayout();
+        _Declare_Layout(&fixture);
+        worker->hash = _Checksum(Clay_EndLayout(), worker->hash);
+
+        Clay_Context *context = Clay_GetCurrentContext();
+        Clay__ElementIdArray hovered = context->pointerOverIds;
+        for (int32_t i = 0; i < hovered.length; i++) {
+            _Hash(
+                worker, &hovered.internalArray[i].id,
+                sizeof(hovered.internalArray[i].id)
+            );
+        }
+    }
+
+    free(arena.memory);
+
+    return NULL;
+}
+
+int main(void) {
+    struct Worker alone[TEST_CONTEXT_COUNT];
+    struct Worker together[TEST_CONTEXT_COUNT];
+    pthread_t threads[TEST_CONTEXT_COUNT];
+    int failures = 0;
+
+    for (int32_t i = 0; i < TEST_CONTEXT_COUNT; i++) {
+        alone[i] = (struct Worker){.id = i};
+        pthread_create(&threads[i], NULL, _Run_Worker, &alone[i]);
+        pthread_join(threads[i], NULL);
+    }
+
+    for (int32_t i = 0; i < TEST_CONTEXT_COUNT; i++) {
+        together[i] = (struct Worker){.id = i};
+        pthread_create(&threads[i], NULL, _Run_Worker, &together[i]);
+    }
+
+    for (int32_t i = 0; i < TEST_CONTEXT_COUNT; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (int32_t i = 0; i < TEST_CONTEXT_COUNT; i++) {
+        if (alone[i].errorCount > 0 || together[i].errorCount > 0) {
+            fprintf(
+                stderr, "threadLocalContext: context %d reported %d errors\n",
+                i, alone[i].errorCount + together[i].errorCount
+            );
+            failures++;
+        }
+
+        if (alone[i].hash != together[i].hash) {
+            fprintf(
+                stderr,
+                "threadLocalContext: context %d differs when laid out "
+                "alongside the others\n",
+                i
+            );
+            failures++;
+        }
+    }
+
+    printf(
+        "threadLocalContext: %d contexts, %s\n", TEST_CONTEXT_COUNT,
+        failures == 0 ? "ok" : "FAILED"
+    );
+
+    return failures == 0 ? 0 : 1;
+}
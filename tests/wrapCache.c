@@ -0,0 +1,166 @@
+// Text keeps last frame's line breaks while its container's width stays in the
+// range of widths that break it the same way. Two contexts lay out the same
+// frames, one with the wrap cache emptied before every layout, and both have
+// to draw the same. Letters are measured in quarters of a pixel, as last
+// frame's breaks are looked up by whole width, and containers creep wider and
+// narrower a quarter of a pixel at a time, landing on the widths of whole
+// words, where ranges begin and end. The same text shows at several widths at
+// once, with texts and line heights changing now and then.
+
+// clock_gettime
+#define _POSIX_C_SOURCE 199309L
+
+#define CLAY_IMPLEMENTATION
+#include "clay.h"
+
+#include "layoutFixture.h"
+
+#define TEST_FRAME_COUNT 200
+#define TEST_ELEMENT_COUNT 300
+#define TEST_PARAGRAPH_COUNT 24
+
+// Widths that vary by letter, in quarters of a pixel
+static Clay_Dimensions _Measure_Text_Quarters(
+    Clay_StringSlice text, Clay_TextElementConfig *config, void *userData
+) {
+    float width = 0;
+
+    for (int32_t i = 0; i < text.length; i++) {
+        width += (float)(text.chars[i] % 7) * 0.25f + 3;
+    }
+
+    return (Clay_Dimensions){width, config->fontSize};
+}
+
+static Clay_Context *_Create_Context(uint32_t memorySize) {
+    Clay_Arena arena =
+        Clay_CreateArenaWithCapacityAndMemory(memorySize, malloc(memorySize));
+    Clay_Context *context = Clay_Initialize(
+        arena, (Clay_Dimensions){1000, 800},
+        (Clay_ErrorHandler){_Handle_Error, "wrapCache"}
+    );
+    Clay_SetMeasureTextFunction(_Measure_Text_Quarters, NULL);
+
+    return context;
+}
+
+// The fixture's trees, and paragraphs in containers whose widths move a few
+// frames at a time
+static Clay_RenderCommandArray
+_Lay_Out(Clay_Context *context, int32_t frame) {
+    Clay_SetCurrentContext(context);
+    Clay_SetLayoutDimensions((Clay_Dimensions){1000 - frame / 25 * 30, 800});
+    Clay_BeginLayout();
+
+    struct LayoutFixture fixture = {
+        .seed = frame / 20 % 3 + 1,
+        .budget = TEST_ELEMENT_COUNT,
+        .scrollBudget = 4,
+        .maxDepth = 5,
+        .maxChildren = 6,
+        .images = true,
+        .borders = true,
+        .floating = true,
+    };
+    _Declare_Layout(&fixture);
+
+    CLAY({
+        .id = CLAY_ID("Paragraphs"),
+        .layout =
+            {.sizing = {CLAY_SIZING_GROW(0)},
+             .layoutDirection = CLAY_TOP_TO_BOTTOM},
+    }) {
+        for (int32_t i = 0; i < TEST_PARAGRAPH_COUNT; i++) {
+            // Pairs of paragraphs share a text at different widths
+            int32_t change = (frame + i * 7) / 30;
+            Clay_String text = {
+                .length = 40 + (i / 2 * 13 + change * 29) % 80,
+                .chars = layoutFixtureWords + (i / 2 * 3 + change) % 10
+            };
+            // Widens for 12 steps, then narrows for 12
+            float step = (float)abs((frame / 3 + i) % 24 - 12);
+            float width =
+                30 + (float)(i * 37 % 160) + step * (i % 3 ? 0.25f : 1);
+            if (i % 2) {
+                width += 25;
+            }
+
+            CLAY({.layout = {.sizing = {CLAY_SIZING_FIXED(width)}}}) {
+                CLAY_TEXT(
+                    text,
+                    CLAY_TEXT_CONFIG(
+                        {.fontSize = 10,
+                         .lineHeight = (frame / 15 + i) % 3 == 0 ? 14 : 0}
+                    )
+                );
+            }
+        }
+        // Grows with the layout, with a newline
+        CLAY({.layout = {.sizing = {CLAY_SIZING_GROW(0)}}}) {
+            CLAY_TEXT(
+                CLAY_STRING("lorem ipsum dolor sit amet consectetur "
+                            "adipiscing elit sed do eiusmod tempor incididunt "
+                            "ut labore et dolore magna aliqua\nlorem ipsum "
+                            "dolor sit amet consectetur adipiscing elit sed do "
+                            "eiusmod tempor incididunt ut labore et dolore "
+                            "magna aliqua lorem ipsum dolor sit amet"),
+                CLAY_TEXT_CONFIG({.fontSize = 10})
+            );
+        }
+        _Declare_Text_Samples(&fixture);
+    }
+
+    return Clay_EndLayout();
+}
+
+int main(void) {
+    Clay_SetMaxElementCount(4 * TEST_ELEMENT_COUNT);
+    Clay_SetMaxMeasureTextCacheWordCount(1 << 15);
+    // Once there is a current context, Clay_MinMemorySize() sizes the word
+    // cache from the element count instead
+    uint32_t memorySize = Clay_MinMemorySize();
+    Clay_Context *uncached = _Create_Context(memorySize);
+    Clay_Context *cached = _Create_Context(memorySize);
+
+    int32_t reusedCount = 0;
+    int32_t failures = 0;
+
+    for (int32_t frame = 0; frame < TEST_FRAME_COUNT; frame++) {
+        Clay__ResetWrapCache(uncached);
+        Clay_RenderCommandArray expected = _Lay_Out(uncached, frame);
+        if (Clay_GetLayoutStats().textElementsWrapReused != 0) {
+            fprintf(
+                stderr, "wrapCache: frame %d, an emptied cache was reused\n",
+                frame
+            );
+            failures++;
+        }
+        Clay_RenderCommandArray commands = _Lay_Out(cached, frame);
+        reusedCount += Clay_GetLayoutStats().textElementsWrapReused;
+
+        int32_t difference = _Compare_Render_Commands(expected, commands);
+        if (difference != -1) {
+            fprintf(
+                stderr,
+                "wrapCache: frame %d, render command %d of %d differs\n",
+                frame, difference, commands.length
+            );
+            failures++;
+        }
+    }
+
+    if (reusedCount == 0) {
+        fprintf(stderr, "wrapCache: no line breaks were reused\n");
+        failures++;
+    }
+
+    printf(
+        "wrapCache: %d frames, %d wraps reused, %s\n", TEST_FRAME_COUNT,
+        reusedCount, failures == 0 ? "ok" : "FAILED"
+    );
+
+    free(cached->internalArena.memory);
+    free(uncached->internalArena.memory);
+
+    return failures == 0 ? 0 : 1;
+}